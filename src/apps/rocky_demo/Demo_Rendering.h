@@ -16,6 +16,9 @@ auto Demo_Rendering = [](Application& app)
     {
         ImGuiLTable::SliderFloat("Screen space error", &app.mapNode->terrainSettings().screenSpaceError.mutable_value(), 0.0f, 512.0f, "%.0f");
 
+        // applies to tiles as they load
+        ImGuiLTable::SliderFloat("Adaptive mesh error (m)", &app.mapNode->terrainSettings().adaptiveMeshError.mutable_value(), 0.0f, 50.0f, "%.1f");
+
         //ImGuiLTable::SliderFloat("Tile pixels", &app.mapNode->terrainSettings().tilePixelSize.mutable_value(), 1.0f, 512.0f, "%.0f");
 
         ImGuiLTable::Checkbox("Render on demand", &app.instance.renderOnDemand());
@@ -12,6 +12,7 @@
 #include <rocky/vsg/Application.h>
 #include <rocky/vsg/engine/TerrainEngine.h>
 #include <rocky/Memory.h>
+#include <rocky/Tracing.h>
 #include <vsg/core/Allocator.h>
 #include "helpers.h"
 
@@ -113,6 +114,40 @@ auto Demo_Stats = [](Application& app)
         ImGuiLTable::End();
     }
 
+    ImGui::SeparatorText("Job Latency");
+    if (!util::JobStats::enabled())
+    {
+        util::JobStats::setEnabled(true);
+    }
+    if (ImGuiLTable::Begin("Job Latency"))
+    {
+        // queue wait and run time, 50th / 95th percentile, and the cancel rate
+        for (auto& [name, entry] : util::JobStats::byName())
+        {
+            auto ms = [](std::chrono::microseconds value) { return 0.001f * (float)value.count(); };
+            auto buf = util::format("wait %.1f/%.1f  run %.1f/%.1f ms  %.0f%% canceled",
+                ms(entry.wait.percentile(0.5f)), ms(entry.wait.percentile(0.95f)),
+                ms(entry.run.percentile(0.5f)), ms(entry.run.percentile(0.95f)),
+                100.0f * entry.cancelRate());
+            ImGuiLTable::Text(name.c_str(), buf.c_str());
+        }
+        ImGuiLTable::End();
+    }
+    if (ImGui::Button("Reset"))
+    {
+        util::JobStats::reset();
+    }
+    ImGui::SameLine();
+    if (!util::Trace::active())
+    {
+        if (ImGui::Button("Record trace"))
+            util::Trace::start();
+    }
+    else if (ImGui::Button("Save trace (rocky_trace.json)"))
+    {
+        util::Trace::stop("rocky_trace.json");
+    }
+
     auto& engine = app.mapNode->terrainNode->engine;
     if (engine)
     {
@@ -121,6 +156,10 @@ auto Demo_Stats = [](Application& app)
         {
             ImGuiLTable::Text("Concurrency", std::to_string(engine->settings.concurrency).c_str());
             ImGuiLTable::Text("Resident tiles", std::to_string(engine->tiles.size()).c_str());
+            ImGuiLTable::Text("Tile memory (GPU)", "%.1lf / %u MB",
+                (double)engine->tiles.gpuBytes() / 1048576.0, engine->settings.gpuMemoryBudget.value());
+            ImGuiLTable::Text("Tile memory (CPU)", "%.1lf / %u MB",
+                (double)engine->tiles.cpuBytes() / 1048576.0, engine->settings.cpuMemoryBudget.value());
             ImGuiLTable::Text("Geometry pool cache", std::to_string(engine->geometryPool.size()).c_str());
             ImGuiLTable::End();
         }
@@ -0,0 +1,105 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+
+/**
+* RREPLAY flies a recorded camera path over a map without opening a window
+* and reports how quickly the terrain engine pages tiles in and out.
+*
+* Usage: rocky_replay --map <map.json> --path <path.json> [--out <report.json>]
+*                     [--fps <frames per second>] [--settle <seconds>]
+*
+* The map file holds a serialized MapNode ({ "map": ..., "terrain": ... }).
+* See CameraPath::from_json for the path format.
+*/
+
+#include <rocky/Version.h>
+#include <rocky/Utils.h>
+#include <rocky/vsg/InstanceVSG.h>
+#include <rocky/vsg/MapNode.h>
+#include <rocky/vsg/engine/Runtime.h>
+#include <rocky/vsg/engine/TerrainReplay.h>
+
+#include <vsg/all.h>
+#include <iostream>
+
+int usage(const char* name)
+{
+    std::cout << "Usage: " << name
+        << " --map <map.json> --path <path.json> [--out <report.json>] [--fps <frames per second>] [--settle <seconds>]"
+        << std::endl;
+    return -1;
+}
+
+int error(const std::string& msg)
+{
+    rocky::Log()->warn(msg);
+    return -1;
+}
+
+int main(int argc, char** argv)
+{
+    rocky::InstanceVSG ri(argc, argv);
+
+    vsg::CommandLine arguments(&argc, argv);
+    if (arguments.read({ "--help" }))
+        return usage(argv[0]);
+
+    std::string mapFile, pathFile, outFile;
+    double fps = 60.0, settle = 60.0;
+    arguments.read("--map", mapFile);
+    arguments.read("--path", pathFile);
+    arguments.read("--out", outFile);
+    arguments.read("--fps", fps);
+    arguments.read("--settle", settle);
+
+    if (mapFile.empty() || pathFile.empty())
+        return usage(argv[0]);
+
+    rocky::Log()->info("Welcome to " ROCKY_PROJECT_NAME " version " ROCKY_VERSION_STRING);
+
+    // a viewer without any windows; the terrain pages tiles but compiles nothing
+    auto viewer = vsg::Viewer::create();
+    ri.runtime().viewer = viewer;
+
+    auto mapNode = rocky::MapNode::create(ri);
+
+    auto mapJSON = rocky::util::readFromFile(mapFile);
+    if (mapJSON.status.failed())
+        return error("Cannot read map file \"" + mapFile + "\"");
+
+    auto status = mapNode->from_json(mapJSON.value, ri.io());
+    if (status.failed())
+        return error("Problem with map file \"" + mapFile + "\" : " + status.message);
+
+    // open the layers up front so the replay only measures paging
+    mapNode->map->openAllLayers(ri.io());
+
+    auto pathJSON = rocky::util::readFromFile(pathFile);
+    if (pathJSON.status.failed())
+        return error("Cannot read camera path file \"" + pathFile + "\"");
+
+    rocky::CameraPath path;
+    status = path.from_json(pathJSON.value);
+    if (status.failed())
+        return error("Problem with camera path file \"" + pathFile + "\" : " + status.message);
+
+    rocky::TerrainReplay replay(mapNode);
+    replay.settings.frameRate = fps;
+    replay.settings.settleTimeout = settle;
+
+    auto report = replay.run(path);
+    if (report.status.failed())
+        return error("Replay failed: " + report.status.message);
+
+    auto json = report.value.to_json();
+
+    if (outFile.empty())
+        std::cout << json << std::endl;
+    else if (!rocky::util::writeToFile(json, outFile))
+        return error("Cannot write report to \"" + outFile + "\"");
+
+    return 0;
+}
@@ -0,0 +1,856 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+
+/**
+ * rocky_bench: headless micro-benchmarks for the SDK's hot paths.
+ * Needs no GPU and no network.
+ *
+ * Usage: rocky_bench [--filter <text>] [--min-time <seconds>] [--data <folder>] [--out <file.json>]
+ *
+ * The results are written as JSON in the layout of Google Benchmark's
+ * --benchmark_format=json output, so the usual comparison tools can read them.
+ * Times are nanoseconds per iteration.
+ */
+#include <rocky/Instance.h>
+#include <rocky/Color.h>
+#include <rocky/ElevationLayer.h>
+#include <rocky/GeoImage.h>
+#include <rocky/GeoHeightfield.h>
+#include <rocky/Heightfield.h>
+#include <rocky/Image.h>
+#include <rocky/LRUCache.h>
+#include <rocky/Log.h>
+#include <rocky/Map.h>
+#include <rocky/SRS.h>
+#include <rocky/Threading.h>
+#include <rocky/TileKey.h>
+#include <rocky/weemesh.h>
+
+#ifdef ROCKY_HAS_GDAL
+#include <rocky/GDALElevationLayer.h>
+#endif
+
+#ifdef ROCKY_HAS_MBTILES
+#include <rocky/MBTiles.h>
+#endif
+
+#ifdef ROCKY_HAS_TMS
+#include <rocky/QuantizedMeshElevationLayer.h>
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+#define ROCKY_EXPOSE_JSON_FUNCTIONS
+#include <rocky/json.h>
+
+using namespace ROCKY_NAMESPACE;
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct Options
+    {
+        std::string filter;
+        std::string dataPath = ROCKY_BENCH_DATA_DIR;
+        std::string outFile;
+        double minTime = 0.5; // seconds per benchmark
+    };
+
+    struct Measurement
+    {
+        std::string name;
+        std::uint64_t iterations = 0;
+        double realTime = 0.0; // ns per iteration
+        double cpuTime = 0.0; // ns per iteration (process CPU time, all threads)
+        std::string label;
+    };
+
+    std::vector<Measurement> results;
+
+    // Runs "iteration" repeatedly, doubling the count until the batch takes
+    // at least the minimum time, and records the per-iteration cost of the
+    // last batch. "iteration" returns false to skip the benchmark.
+    void run(const Options& options, const std::string& name, std::function<bool()> iteration, const std::string& label = {})
+    {
+        if (!options.filter.empty() && name.find(options.filter) == std::string::npos)
+            return;
+
+        // warm up, and let the benchmark opt out:
+        if (!iteration())
+        {
+            std::cerr << name << ": skipped" << std::endl;
+            return;
+        }
+
+        Measurement m;
+        m.name = name;
+        m.label = label;
+
+        for (std::uint64_t count = 1; ; count *= 2)
+        {
+            auto cpu0 = std::clock();
+            auto t0 = Clock::now();
+
+            for (std::uint64_t i = 0; i < count; ++i)
+                iteration();
+
+            auto seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+            auto cpuSeconds = (double)(std::clock() - cpu0) / (double)CLOCKS_PER_SEC;
+
+            if (seconds >= options.minTime || count >= (1ull << 30))
+            {
+                m.iterations = count;
+                m.realTime = 1e9 * seconds / (double)count;
+                m.cpuTime = 1e9 * cpuSeconds / (double)count;
+                break;
+            }
+        }
+
+        std::cerr << std::left << std::setw(48) << name
+            << std::right << std::setw(14) << std::fixed << std::setprecision(0) << m.realTime << " ns"
+            << std::setw(14) << m.cpuTime << " ns cpu"
+            << std::setw(12) << m.iterations
+            << (label.empty() ? "" : "  " + label) << std::endl;
+
+        results.emplace_back(std::move(m));
+    }
+
+    Status writeResults(const Options& options)
+    {
+        auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+        char date[64];
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+        json doc = {
+            { "context", {
+                { "date", date },
+                { "executable", "rocky_bench" },
+                { "num_cpus", std::thread::hardware_concurrency() },
+                { "rocky_version", ROCKY_VERSION_STRING },
+                { "library_build_type",
+#ifdef NDEBUG
+                    "release"
+#else
+                    "debug"
+#endif
+                }
+            }},
+            { "benchmarks", json::array() }
+        };
+
+        for (auto& m : results)
+        {
+            json entry = {
+                { "name", m.name },
+                { "run_name", m.name },
+                { "run_type", "iteration" },
+                { "iterations", m.iterations },
+                { "real_time", m.realTime },
+                { "cpu_time", m.cpuTime },
+                { "time_unit", "ns" }
+            };
+            if (!m.label.empty())
+                entry["label"] = m.label;
+            doc["benchmarks"].push_back(entry);
+        }
+
+        if (options.outFile.empty())
+        {
+            std::cout << doc.dump(2) << std::endl;
+        }
+        else
+        {
+            std::ofstream out(options.outFile);
+            if (!out.is_open())
+                return Status(Status::ResourceUnavailable, "Cannot write " + options.outFile);
+            out << doc.dump(2) << std::endl;
+        }
+        return StatusOK;
+    }
+
+    //! Layer that stands in for a slow connection (e.g. a TMS layer
+    //! fetching its tilemap.xml) by sleeping in open.
+    class SlowLayer : public Inherit<Layer, SlowLayer>
+    {
+    public:
+        Status openImplementation(const IOOptions& io) override {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            return StatusOK;
+        }
+    };
+
+    shared_ptr<Image> makeTestImage(unsigned size, float seed)
+    {
+        auto image = Image::create(Image::R8G8B8A8_UNORM, size, size);
+        for (unsigned t = 0; t < size; ++t)
+            for (unsigned s = 0; s < size; ++s)
+                image->write(Image::Pixel((float)s / size, (float)t / size, seed, 1.0f), s, t);
+        return image;
+    }
+
+    void benchImages(const Options& options)
+    {
+        const unsigned size = 256;
+        auto image = makeTestImage(size, 0.5f);
+
+        run(options, "Image/write/256x256", [&]()
+            {
+                Image::Pixel pixel(0.25f, 0.5f, 0.75f, 1.0f);
+                for (unsigned t = 0; t < size; ++t)
+                    for (unsigned s = 0; s < size; ++s)
+                        image->write(pixel, s, t);
+                return true;
+            });
+
+        run(options, "Image/read/256x256", [&]()
+            {
+                Image::Pixel pixel, sum(0.0f);
+                for (unsigned t = 0; t < size; ++t)
+                    for (unsigned s = 0; s < size; ++s)
+                        image->read(pixel, s, t), sum += pixel;
+                return sum.a > 0.0f;
+            });
+
+        run(options, "Image/read-view/256x256", [&]()
+            {
+                Image::Pixel pixel, sum(0.0f);
+                ImageView<Image::R8G8B8A8_UNORM> view(*image);
+                for (unsigned t = 0; t < size; ++t)
+                    for (unsigned s = 0; s < size; ++s)
+                        view.read(pixel, s, t), sum += pixel;
+                return sum.a > 0.0f;
+            });
+
+        auto canvas = Image::create(Image::R8G8B8A8_UNORM, size * 2, size * 2);
+
+        run(options, "Image/fill/512x512", [&]()
+            {
+                canvas->fill(Image::Pixel(0.25f, 0.5f, 0.75f, 1.0f));
+                return true;
+            });
+
+        run(options, "Image/copyAsSubImage/256x256", [&]()
+            {
+                return image->copyAsSubImage(canvas.get(), size / 2, size / 2);
+            });
+
+        run(options, "Image/sharpen/RGBA8/256x256", [&]()
+            {
+                return image->sharpen(2.5f) != nullptr;
+            });
+
+        auto floats = Image::create(Image::R32_SFLOAT, size, size);
+        for (unsigned t = 0; t < size; ++t)
+            for (unsigned s = 0; s < size; ++s)
+                floats->write(Image::Pixel((float)((s * 7 + t * 13) % 256) / 255.0f), s, t);
+
+        run(options, "Image/sharpen/R32F/256x256", [&]()
+            {
+                return floats->sharpen(2.5f) != nullptr;
+            });
+
+        // a format without a fast path, for comparison with the per-pixel convolution
+        auto rgb = Image::create(Image::R8G8B8_UNORM, size, size);
+        for (unsigned t = 0; t < size; ++t)
+            for (unsigned s = 0; s < size; ++s)
+                rgb->write(Image::Pixel((float)s / size, (float)t / size, 0.5f, 1.0f), s, t);
+
+        run(options, "Image/sharpen/RGB8-generic/256x256", [&]()
+            {
+                return rgb->sharpen(2.5f) != nullptr;
+            });
+
+        const float cross[9] = { 0.0f, -0.5f, 0.0f, -0.5f, 3.0f, -0.5f, 0.0f, -0.5f, 0.0f };
+
+        run(options, "Image/convolve/RGBA8-nonseparable/256x256", [&]()
+            {
+                return image->convolve(cross) != nullptr;
+            });
+
+        GeoExtent extent(SRS::WGS84, -180, -90, 0, 90);
+
+        std::vector<GeoImage> sources;
+        for (int i = 0; i < 4; ++i)
+            sources.emplace_back(makeTestImage(size, 0.25f * i), extent);
+        std::vector<float> opacities = { 1.0f, 0.75f, 0.5f, 0.25f };
+
+        GeoImage target(Image::create(Image::R8G8B8A8_UNORM, size, size), extent);
+
+        run(options, "GeoImage/composite/4x256x256", [&]()
+            {
+                target.composite(sources, opacities);
+                return true;
+            });
+
+        GeoImage source(makeTestImage(size, 0.5f), GeoExtent(SRS::WGS84, -180, -85, 180, 85));
+
+        run(options, "GeoImage/reproject/wgs84-to-mercator/256x256", [&]()
+            {
+                auto result = source.reproject(SRS::SPHERICAL_MERCATOR, nullptr, size, size);
+                return result.status.ok();
+            });
+    }
+
+#ifdef ROCKY_HAS_TMS
+    //! A quantized-mesh tile of a regular grid of n x n vertices over a wavy surface
+    std::string makeQuantizedMesh(unsigned n)
+    {
+        std::string tile(24, '\0');
+        auto put = [&](auto value) { tile.append(reinterpret_cast<const char*>(&value), sizeof(value)); };
+        put(0.0f), put(1000.0f);
+        tile.append(56, '\0');
+
+        // the encoding numbers vertices in the order the triangles first use them
+        std::vector<unsigned> triangles, order(n * n, ~0u);
+        for (unsigned r = 0; r + 1 < n; ++r)
+        {
+            for (unsigned c = 0; c + 1 < n; ++c)
+            {
+                unsigned a = r * n + c;
+                triangles.insert(triangles.end(), { a, a + 1, a + n + 1, a, a + n + 1, a + n });
+            }
+        }
+        std::vector<unsigned> vertices;
+        for (auto& index : triangles)
+        {
+            if (order[index] == ~0u)
+                order[index] = (unsigned)vertices.size(), vertices.push_back(index);
+            index = order[index];
+        }
+
+        put((std::uint32_t)vertices.size());
+        for (int a = 0; a < 3; ++a)
+        {
+            int prev = 0;
+            for (auto v : vertices)
+            {
+                unsigned c = v % n, r = v / n;
+                int value =
+                    a == 0 ? (int)(c * 32767 / (n - 1)) :
+                    a == 1 ? (int)(r * 32767 / (n - 1)) :
+                    (int)(16383.0f * (1.0f + std::sin(0.3f * c) * std::cos(0.3f * r)));
+                put((std::uint16_t)(((value - prev) << 1) ^ ((value - prev) >> 31)));
+                prev = value;
+            }
+        }
+
+        put((std::uint32_t)(triangles.size() / 3));
+        unsigned highest = 0;
+        for (auto index : triangles)
+        {
+            put((std::uint16_t)(highest - index));
+            if (index == highest)
+                ++highest;
+        }
+        return tile;
+    }
+#endif
+
+    void benchHeightfields(const Options& options)
+    {
+        const unsigned size = 257;
+        auto hf = Heightfield::create(size, size);
+        for (unsigned t = 0; t < size; ++t)
+            for (unsigned s = 0; s < size; ++s)
+                hf->heightAt(s, t) = 1000.0f * std::sin(0.1f * s) * std::cos(0.1f * t);
+
+        GeoHeightfield geohf(hf, GeoExtent(SRS::WGS84, -10, -10, 10, 10));
+
+        std::mt19937 engine(0);
+        std::uniform_real_distribution<double> coord(-10.0, 10.0);
+        std::vector<glm::dvec2> points(1024);
+        for (auto& p : points)
+            p = { coord(engine), coord(engine) };
+
+        run(options, "Heightfield/heightAtLocation/bilinear/1024", [&]()
+            {
+                float sum = 0.0f;
+                for (auto& p : points)
+                    sum += geohf.heightAtLocation(p.x, p.y, Image::BILINEAR);
+                return sum != NO_DATA_VALUE;
+            });
+
+        run(options, "Heightfield/heightAtLocation/nearest/1024", [&]()
+            {
+                float sum = 0.0f;
+                for (auto& p : points)
+                    sum += geohf.heightAtLocation(p.x, p.y, Image::NEAREST);
+                return sum != NO_DATA_VALUE;
+            });
+
+        // 16-bit quantized storage
+        auto quantized = Heightfield::create(*hf);
+        quantized->quantize();
+        GeoHeightfield geoquantized(quantized, geohf.extent());
+
+        run(options, "Heightfield/heightAtLocation/bilinear-quantized/1024", [&]()
+            {
+                float sum = 0.0f;
+                for (auto& p : points)
+                    sum += geoquantized.heightAtLocation(p.x, p.y, Image::BILINEAR);
+                return sum != NO_DATA_VALUE;
+            });
+
+        run(options, "Heightfield/quantize/257x257", [&]()
+            {
+                auto copy = Heightfield::create(*hf);
+                copy->quantize();
+                return copy->quantized();
+            });
+
+        // RGB-encoded elevation tiles
+        auto encoded = Image::create(Image::R8G8B8A8_UNORM, 256, 256);
+        ImageView<Image::R8G8B8A8_UNORM> pixels(*encoded);
+        for (unsigned t = 0; t < 256; ++t)
+            for (unsigned s = 0; s < 256; ++s)
+                pixels.write(Image::Pixel(0.5f, (float)s / 256.0f, (float)t / 256.0f, 1.0f), s, t);
+
+        run(options, "Heightfield/decodeRGB/MapboxRGB/256x256", [&]()
+            {
+                return ElevationLayer::decodeRGB(*encoded, ElevationLayer::Encoding::MapboxRGB) != nullptr;
+            });
+
+        run(options, "Heightfield/decodeRGB/TerrariumRGB/256x256", [&]()
+            {
+                return ElevationLayer::decodeRGB(*encoded, ElevationLayer::Encoding::TerrariumRGB) != nullptr;
+            });
+
+#ifdef ROCKY_HAS_TMS
+        auto tile = makeQuantizedMesh(65);
+
+        run(options, "Heightfield/decodeQuantizedMesh/65x65-vertices/257x257", [&]()
+            {
+                return QuantizedMeshElevationLayer::decode(tile, size, size).status.ok();
+            });
+#endif
+    }
+
+#ifdef ROCKY_HAS_GDAL
+    void benchElevationLayer(const Options& options, const IOOptions& io)
+    {
+        auto path = options.dataPath + "/imagery/world.tif";
+
+        auto layer = GDALElevationLayer::create();
+        layer->setURI(URI(path));
+        auto status = layer->open(io);
+
+        // Mercator keys over a geodetic GeoTIFF go through assembleHeightfield,
+        // which mosaics the intersecting source tiles.
+        std::vector<TileKey> keys;
+        if (status.ok())
+            Profile::getAllKeysAtLOD(4, Profile::SPHERICAL_MERCATOR, keys);
+
+        std::size_t next = 0;
+        run(options, "ElevationLayer/assembleHeightfield/mercator-over-geotiff", [&]()
+            {
+                if (keys.empty())
+                    return false;
+                auto result = layer->createHeightfield(keys[next++ % keys.size()], io);
+                return result.status.ok() || result.status.code == Status::ResourceUnavailable;
+            },
+            status.ok() ? path : status.message);
+    }
+#endif
+
+    void benchSRS(const Options& options)
+    {
+        std::mt19937 engine(0);
+        std::uniform_real_distribution<double> lon(-180.0, 180.0), lat(-80.0, 80.0);
+        std::vector<glm::dvec3> points(1024);
+        for (auto& p : points)
+            p = { lon(engine), lat(engine), 0.0 };
+
+        for (auto& [name, target] : std::vector<std::pair<std::string, SRS>>{
+            { "wgs84-to-mercator", SRS::SPHERICAL_MERCATOR },
+            { "wgs84-to-ecef", SRS::ECEF } })
+        {
+            auto xform = SRS::WGS84.to(target);
+
+            run(options, "SRSOperation/transform/" + name + "/1024", [&]()
+                {
+                    glm::dvec3 out;
+                    bool ok = true;
+                    for (auto& p : points)
+                        ok = xform.transform(p, out) && ok;
+                    return ok;
+                });
+        }
+    }
+
+    void benchTileKeys(const Options& options)
+    {
+        std::vector<TileKey> keys;
+        Profile::getAllKeysAtLOD(5, Profile::GLOBAL_GEODETIC, keys);
+
+        run(options, "TileKey/hash/" + std::to_string(keys.size()), [&]()
+            {
+                std::size_t h = 0;
+                for (auto& key : keys)
+                    h ^= std::hash<TileKey>()(key);
+                return h != 1;
+            });
+
+        std::unordered_map<TileKey, int> table;
+        for (auto& key : keys)
+            table[key] = 1;
+
+        run(options, "TileKey/unordered_map-lookup/" + std::to_string(keys.size()), [&]()
+            {
+                int found = 0;
+                for (auto& key : keys)
+                    found += table.count(key);
+                return found == (int)keys.size();
+            });
+
+        // keys from a separately constructed (but equivalent) profile, so that
+        // comparisons can't take the shared-instance shortcut
+        Profile geodetic(SRS::WGS84, Box(-180.0, -90.0, 180.0, 90.0), 2, 1);
+        std::vector<TileKey> equivalentKeys;
+        Profile::getAllKeysAtLOD(5, geodetic, equivalentKeys);
+
+        run(options, "TileKey/unordered_map-lookup/equivalent-profile/" + std::to_string(equivalentKeys.size()), [&]()
+            {
+                int found = 0;
+                for (auto& key : equivalentKeys)
+                    found += table.count(key);
+                return found == (int)equivalentKeys.size();
+            });
+
+        run(options, "Profile/equivalentTo/1024", [&]()
+            {
+                int equivalent = 0;
+                for (int i = 0; i < 1024; ++i)
+                    equivalent += geodetic.equivalentTo(Profile::GLOBAL_GEODETIC) ? 1 : 0;
+                return equivalent == 1024;
+            });
+
+        run(options, "TileKey/create/" + std::to_string(keys.size()), [&]()
+            {
+                std::size_t h = 0;
+                for (auto& key : keys)
+                    h ^= TileKey(key.levelOfDetail(), key.tileX(), key.tileY(), Profile::GLOBAL_GEODETIC).hash();
+                return h != 1;
+            });
+
+        std::vector<TileKey> geodeticKeys;
+        Profile::getAllKeysAtLOD(3, Profile::GLOBAL_GEODETIC, geodeticKeys);
+
+        run(options, "TileKey/getIntersectingKeys/geodetic-to-mercator/" + std::to_string(geodeticKeys.size()), [&]()
+            {
+                std::vector<TileKey> output;
+                for (auto& key : geodeticKeys)
+                    key.getIntersectingKeys(Profile::SPHERICAL_MERCATOR, output);
+                return !output.empty();
+            });
+    }
+
+    void benchLRUCache(const Options& options)
+    {
+        const unsigned numThreads = std::max(2u, std::thread::hardware_concurrency());
+        const int opsPerThread = 10000;
+
+        util::LRUCache<int, std::shared_ptr<int>> cache(256);
+        auto value = std::make_shared<int>(1);
+
+        run(options, "LRUCache/contention/" + std::to_string(numThreads) + "-threads", [&]()
+            {
+                std::vector<std::thread> threads;
+                for (unsigned i = 0; i < numThreads; ++i)
+                {
+                    threads.emplace_back([&, i]()
+                        {
+                            std::mt19937 engine(i);
+                            std::uniform_int_distribution<int> keys(0, 511);
+                            for (int op = 0; op < opsPerThread; ++op)
+                            {
+                                int key = keys(engine);
+                                if (!cache.get(key))
+                                    cache.put(key, value);
+                            }
+                        });
+                }
+                for (auto& thread : threads)
+                    thread.join();
+                return true;
+            },
+            std::to_string(opsPerThread) + " ops per thread");
+    }
+
+    void benchSingleFlight(const Options& options)
+    {
+        // Loader threads asking for the same few slow reads at once, like
+        // sibling tiles all needing their parent's data.
+        const unsigned numThreads = std::max(2u, std::thread::hardware_concurrency());
+        const int requestsPerThread = 32;
+        const int numKeys = 8;
+        const auto readTime = std::chrono::microseconds(500);
+
+        for (bool coalesce : { false, true })
+        {
+            util::SingleFlight<int, int> flights;
+            std::atomic_uint64_t reads = { 0 };
+            std::atomic_uint64_t requests = { 0 };
+            std::atomic_uint64_t latency = { 0 }; // ns
+
+            auto read = [&](int key)
+                {
+                    ++reads;
+                    std::this_thread::sleep_for(readTime);
+                    return key;
+                };
+
+            std::string name = std::string("SingleFlight/contention/") +
+                (coalesce ? "coalesced/" : "direct/") + std::to_string(numThreads) + "-threads";
+
+            run(options, name, [&]()
+                {
+                    std::atomic_uint ready = { 0 };
+                    std::vector<std::thread> threads;
+                    for (unsigned i = 0; i < numThreads; ++i)
+                    {
+                        threads.emplace_back([&, i]()
+                            {
+                                std::mt19937 engine(i);
+                                std::uniform_int_distribution<int> keys(0, numKeys - 1);
+
+                                ++ready;
+                                while (ready < numThreads)
+                                    std::this_thread::yield();
+
+                                for (int r = 0; r < requestsPerThread; ++r)
+                                {
+                                    int key = keys(engine);
+                                    auto t0 = Clock::now();
+                                    int value = coalesce ? flights.run(key, [&]() { return read(key); }) : read(key);
+                                    latency += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count();
+                                    requests += (value == key) ? 1 : 0;
+                                }
+                            });
+                    }
+                    for (auto& thread : threads)
+                        thread.join();
+                    return true;
+                });
+
+            // the label needs the totals, so fill it in once the run is done:
+            if (!results.empty() && results.back().name == name && requests > 0)
+            {
+                std::ostringstream label;
+                label << std::fixed << std::setprecision(1)
+                    << (100.0 * (double)reads / (double)requests) << " reads per 100 requests, "
+                    << (1e-3 * (double)latency / (double)requests) << " us mean latency";
+                results.back().label = label.str();
+                std::cerr << "    " << results.back().label << std::endl;
+            }
+        }
+    }
+
+#ifdef ROCKY_HAS_MBTILES
+    void benchMBTiles(const Options& options, const IOOptions& io_in)
+    {
+        // A raw pixel "codec" keeps the benchmark on sqlite and the driver
+        // instead of on an image format plugin.
+        IOOptions io(io_in);
+        io.services.writeImageToStream = [](shared_ptr<Image> image, std::ostream& out, std::string, const IOOptions&)
+            {
+                unsigned header[3] = { (unsigned)image->pixelFormat(), image->width(), image->height() };
+                out.write((const char*)header, sizeof(header));
+                out.write((const char*)image->data<unsigned char>(), image->sizeInBytes());
+                return StatusOK;
+            };
+        io.services.readImageFromStream = [](std::istream& in, std::string, const IOOptions&) -> Result<shared_ptr<Image>>
+            {
+                unsigned header[3];
+                in.read((char*)header, sizeof(header));
+                auto image = Image::create((Image::PixelFormat)header[0], header[1], header[2]);
+                in.read((char*)image->data<unsigned char>(), image->sizeInBytes());
+                return image;
+            };
+
+        auto path = (std::filesystem::temp_directory_path() / "rocky_bench.mbtiles").string();
+        std::filesystem::remove(path);
+
+        MBTiles::Options mbo;
+        mbo.uri = URI(path);
+        mbo.format = "raw";
+
+        Profile profile = Profile::GLOBAL_GEODETIC;
+        DataExtentList extents;
+        MBTiles::Driver driver;
+        auto status = driver.open("rocky_bench", mbo, true, profile, extents, io);
+
+        std::vector<TileKey> keys;
+        Profile::getAllKeysAtLOD(6, Profile::GLOBAL_GEODETIC, keys);
+        auto image = makeTestImage(256, 0.5f);
+
+        std::size_t next = 0;
+        run(options, "MBTiles/write/256x256", [&]()
+            {
+                return status.ok() && driver.write(keys[next++ % keys.size()], image, io).ok();
+            },
+            status.ok() ? std::string() : status.message);
+
+        next = 0;
+        run(options, "MBTiles/read/256x256", [&]()
+            {
+                return status.ok() && driver.read(keys[next++ % keys.size()], io).status.ok();
+            },
+            status.ok() ? std::string() : status.message);
+
+        driver.close();
+        std::filesystem::remove(path);
+    }
+#endif
+
+    void benchWeemesh(const Options& options)
+    {
+        // a jagged ring cut into a regular grid (see the weemesh unit test):
+        std::vector<weemesh::segment_t> segments;
+        const int num_points = 500;
+        for (int i = 0; i < num_points; ++i)
+        {
+            auto point = [&](int k) {
+                double a = 2.0 * 3.14159265358979 * (double)k / (double)num_points;
+                double r = (k & 1) ? 8.0 : 9.0;
+                return weemesh::vert_t(r * cos(a), r * sin(a), 0.0);
+                };
+            segments.emplace_back(point(i), point((i + 1) % num_points));
+        }
+
+        run(options, "weemesh/insert/41x41-grid-500-segments", [&]()
+            {
+                weemesh::mesh_t m;
+                const int cols = 41;
+                m.reserve(cols * cols, (cols - 1) * (cols - 1) * 2);
+                for (int row = 0; row < cols; ++row)
+                    for (int col = 0; col < cols; ++col)
+                        m.get_or_create_vertex(weemesh::vert_t(-10.0 + 0.5 * col, -10.0 + 0.5 * row, 0.0), 0);
+
+                for (int row = 0; row < cols - 1; ++row)
+                {
+                    for (int col = 0; col < cols - 1; ++col)
+                    {
+                        int k = row * cols + col;
+                        m.add_triangle(k, k + 1, k + cols);
+                        m.add_triangle(k + 1, k + cols + 1, k + cols);
+                    }
+                }
+
+                m.insert(segments.begin(), segments.end(), 0);
+                return !m.triangles.empty();
+            });
+    }
+
+    void benchJobs(const Options& options)
+    {
+        auto pool = jobs::get_pool("rocky.bench");
+        pool->set_concurrency(std::max(2u, std::thread::hardware_concurrency()));
+
+        jobs::context context;
+        context.pool = pool;
+
+        run(options, "jobs/dispatch-join/1", [&]()
+            {
+                auto result = jobs::dispatch([](Cancelable&) { return 1; }, context);
+                return result.join() == 1;
+            });
+
+        const int count = 1000;
+        run(options, "jobs/dispatch-join/" + std::to_string(count), [&]()
+            {
+                std::vector<jobs::future<int>> futures;
+                futures.reserve(count);
+                for (int i = 0; i < count; ++i)
+                    futures.emplace_back(jobs::dispatch([i](Cancelable&) { return i; }, context));
+
+                int sum = 0;
+                for (auto& f : futures)
+                    sum += f.join();
+                return sum == count * (count - 1) / 2;
+            });
+    }
+
+    void benchStartup(const Options& options, Instance& instance)
+    {
+        // Headless stand-in for time-to-first-frame: how long before every
+        // layer of a map is open and its tiles can start loading.
+        const int numLayers = 15;
+
+        run(options, "Map/openAllLayers/15-layers-20ms-each", [&]()
+            {
+                auto map = Map::create(instance);
+                for (int i = 0; i < numLayers; ++i)
+                    map->layers().add(SlowLayer::create());
+                return map->openAllLayers(instance.io()).ok();
+            });
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--filter" && hasValue)
+            options.filter = argv[++i];
+        else if (arg == "--min-time" && hasValue)
+            options.minTime = std::atof(argv[++i]);
+        else if (arg == "--data" && hasValue)
+            options.dataPath = argv[++i];
+        else if (arg == "--out" && hasValue)
+            options.outFile = argv[++i];
+        else
+        {
+            std::cerr << "Usage: " << argv[0]
+                << " [--filter <text>] [--min-time <seconds>] [--data <folder>] [--out <file.json>]" << std::endl;
+            return arg == "--help" ? 0 : -1;
+        }
+    }
+
+    Instance instance;
+    Log()->set_level(spdlog::level::warn);
+
+    benchImages(options);
+    benchHeightfields(options);
+#ifdef ROCKY_HAS_GDAL
+    benchElevationLayer(options, instance.io());
+#endif
+    benchSRS(options);
+    benchTileKeys(options);
+    benchLRUCache(options);
+    benchSingleFlight(options);
+#ifdef ROCKY_HAS_MBTILES
+    benchMBTiles(options, instance.io());
+#endif
+    benchWeemesh(options);
+    benchJobs(options);
+    benchStartup(options, instance);
+
+    auto status = writeResults(options);
+    if (status.failed())
+    {
+        std::cerr << status.message << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
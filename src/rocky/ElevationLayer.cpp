@@ -10,6 +10,11 @@
 
 #include <cinttypes>
 
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define ROCKY_ELEVATION_SSE2
+#endif
+
 using namespace ROCKY_NAMESPACE;
 using namespace ROCKY_NAMESPACE::util;
 
@@ -94,6 +99,7 @@ ElevationLayer::construct(const std::string& JSON, const IOOptions& io)
     get_to(j, "no_data_value", _noDataValue);
     get_to(j, "min_valid_value", _minValidValue);
     get_to(j, "max_valid_value", _maxValidValue);
+    get_to(j, "quantize", _quantize);
     std::string encoding;
     if (get_to(j, "encoding", encoding))
     {
@@ -101,6 +107,8 @@ ElevationLayer::construct(const std::string& JSON, const IOOptions& io)
             _encoding = Encoding::SingleChannel;
         else if (encoding == "mapboxrgb")
             _encoding = Encoding::MapboxRGB;
+        else if (encoding == "terrarium")
+            _encoding = Encoding::TerrariumRGB;
     }
 
     // a small L2 cache will help with things like normal map creation
@@ -131,10 +139,13 @@ ElevationLayer::to_json() const
     set(j, "no_data_value", _noDataValue);
     set(j, "min_valid_value", _minValidValue);
     set(j, "max_valid_value", _maxValidValue);
+    set(j, "quantize", _quantize);
     if (_encoding.has_value(Encoding::SingleChannel))
         set(j, "encoding", "single_channel");
     else if (_encoding.has_value(Encoding::MapboxRGB))
         set(j, "encoding", "mapboxrgb");
+    else if (_encoding.has_value(Encoding::TerrariumRGB))
+        set(j, "encoding", "terrarium");
 
     return j.dump();
 }
@@ -170,12 +181,22 @@ void ElevationLayer::setMaxValidValue(float value) {
 const optional<float>& ElevationLayer::maxValidValue() const {
     return _maxValidValue;
 }
+void ElevationLayer::setQuantize(bool value) {
+    _quantize = value, _reopenRequired = true;
+}
+const optional<bool>& ElevationLayer::quantize() const {
+    return _quantize;
+}
 
 void
 ElevationLayer::normalizeNoDataValues(Heightfield* hf) const
 {
     if ( hf )
     {
+        // quantized heightfields were normalized before encoding
+        if (hf->quantized())
+            return;
+
         // we know heightfields are R32_SFLOAT so take a shortcut.
         float* pixel = hf->data<float>();
         for (unsigned i = 0; i < hf->width()*hf->height(); ++i, ++pixel)
@@ -228,18 +249,43 @@ ElevationLayer::assembleHeightfield(const TileKey& key, const IOOptions& io) con
 
             else
             {
-                TileKey subKey = intersectingKey;
-                Result<GeoHeightfield> subTile;
-                while (subKey.valid() && (!subTile.status.ok() || !subTile.value.heightfield()))
-                {
-                    subTile = createHeightfieldImplementation_internal(subKey, io);
-                    if (subTile.status.failed())
-                        subKey.makeParent();
+                // Neighboring tiles share mosaic sources, so several loader threads
+                // often want the same one at once; they share a single fetch.
+                auto fetch = [&]()
+                    {
+                        TileKey subKey = intersectingKey;
+                        Result<GeoHeightfield> subTile;
+                        while (subKey.valid() && (!subTile.status.ok() || !subTile.value.heightfield()))
+                        {
+                            subTile = createHeightfieldImplementation_internal(subKey, io);
+                            if (subTile.status.failed())
+                                subKey.makeParent();
 
-                    if (io.canceled())
-                        return {};
+                            if (io.canceled())
+                                return std::make_tuple(subKey, subTile, true);
+                        }
+
+                        // sources live on in the dependency cache, so store them compactly
+                        if (_quantize.value() && subTile.status.ok() && subTile.value.heightfield())
+                        {
+                            normalizeNoDataValues(subTile.value.heightfield().get());
+                            subTile.value.heightfield()->quantize();
+                        }
+                        return std::make_tuple(subKey, subTile, false);
+                    };
+
+                bool joined = false;
+                auto [subKey, subTile, canceled] = _sourceFlights.run(intersectingKey, fetch, &joined);
+
+                // the fetch we joined was canceled, but this one wasn't
+                if (joined && canceled && !io.canceled())
+                {
+                    std::tie(subKey, subTile, canceled) = fetch();
                 }
 
+                if (io.canceled())
+                    return {};
+
                 if (subTile.status.ok() && subTile.value.heightfield())
                 {
                     // save it in the weak cache:
@@ -434,6 +480,11 @@ ElevationLayer::createHeightfieldInKeyProfile(
     // Pre-caching operations:
     normalizeNoDataValues(hf.get());
 
+    if (hf && _quantize.value())
+    {
+        hf->quantize();
+    }
+
     // No luck on any path:
     if (hf == nullptr)
     {
@@ -665,10 +716,21 @@ ElevationLayerVector::populateHeightfield(
             {
                 requiresResample = false;
 
-                memcpy(
-                    hf->data<unsigned char>(),
-                    layerHF->heightfield()->data<unsigned char>(),
-                    hf->sizeInBytes());
+                const Heightfield& source = *layerHF->heightfield();
+                if (source.quantized())
+                {
+                    // 16-bit codes; decode them into the float output
+                    for (unsigned r = 0; r < hf->height(); ++r)
+                        for (unsigned c = 0; c < hf->width(); ++c)
+                            hf->heightAt(c, r) = source.heightAt(c, r);
+                }
+                else
+                {
+                    memcpy(
+                        hf->data<unsigned char>(),
+                        source.data<unsigned char>(),
+                        hf->sizeInBytes());
+                }
                 //memcpy(hf->getFloatArray()->asVector().data(),
                 //    layerHF.getHeightfield()->getFloatArray()->asVector().data(),
                 //    sizeof(float) * hf->getFloatArray()->size()
@@ -877,31 +939,101 @@ ElevationLayerVector::populateHeightfield(
     return realData;
 }
 
-shared_ptr<Heightfield>
-ElevationLayer::decodeMapboxRGB(shared_ptr<Image> image) const
+namespace
 {
-    if (!image || !image->valid())
-        return nullptr;
-
-    // convert the RGB Elevation into an actual heightfield
-    auto hf = Heightfield::create(image->width(), image->height());
+    //! RGB elevation encoding: the 24-bit value (R << 16 | G << 8 | B)
+    //! maps to a height of value * scale + offset.
+    struct RGBEncoding
+    {
+        float scale, offset;
+        float minValid, maxValid; // heights outside this range are "no data"
+    };
 
-    glm::fvec4 pixel;
-    for (unsigned y = 0; y < image->height(); ++y)
+    //! Decodes a row of N-component 8-bit pixels into heights
+    template<unsigned N>
+    void decodeRGBRow(const unsigned char* in, float* out, unsigned width, const RGBEncoding& e)
     {
-        for (unsigned x = 0; x < image->width(); ++x)
+        unsigned s = 0;
+#ifdef ROCKY_ELEVATION_SSE2
+        if constexpr (N == 4)
+        {
+            const __m128i lo = _mm_set1_epi32(0xff), mid = _mm_set1_epi32(0xff00);
+            const __m128 scale = _mm_set1_ps(e.scale), offset = _mm_set1_ps(e.offset);
+            const __m128 minValid = _mm_set1_ps(e.minValid), maxValid = _mm_set1_ps(e.maxValid);
+            const __m128 noData = _mm_set1_ps(NO_DATA_VALUE);
+
+            for (; s + 4 <= width; s += 4, in += 16)
+            {
+                // four pixels, one per 32-bit lane with R in the low byte
+                __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+                __m128i value = _mm_or_si128(
+                    _mm_or_si128(_mm_slli_epi32(_mm_and_si128(p, lo), 16), _mm_and_si128(p, mid)),
+                    _mm_and_si128(_mm_srli_epi32(p, 16), lo));
+
+                __m128 h = _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(value), scale), offset);
+                __m128 valid = _mm_and_ps(_mm_cmpge_ps(h, minValid), _mm_cmple_ps(h, maxValid));
+                _mm_storeu_ps(out + s, _mm_or_ps(_mm_and_ps(valid, h), _mm_andnot_ps(valid, noData)));
+            }
+        }
+#endif
+        for (; s < width; ++s, in += N)
         {
-            image->read(pixel, x, y);
+            float h = (float)((in[0] << 16) | (in[1] << 8) | in[2]) * e.scale + e.offset;
+            out[s] = (h >= e.minValid && h <= e.maxValid) ? h : NO_DATA_VALUE;
+        }
+    }
+}
+
+shared_ptr<Heightfield>
+ElevationLayer::decodeRGB(const Image& image, Encoding encoding)
+{
+    if (!image.valid())
+        return nullptr;
 
-            float height = -10000.f +
-                ((pixel.r * 256.0f * 256.0f + pixel.g * 256.0f + pixel.b) * 256.0f * 0.1f);
+    const RGBEncoding e = (encoding == Encoding::TerrariumRGB) ?
+        RGBEncoding{ 1.0f / 256.0f, -32768.0f, -FLT_MAX, FLT_MAX } :
+        RGBEncoding{ 0.1f, -10000.0f, -9999.0f, 999999.0f };
 
-            if (height < -9999 || height > 999999)
-                height = NO_DATA_VALUE;
+    auto hf = Heightfield::create(image.width(), image.height());
+    ImageView<Image::R32_SFLOAT> heights(*hf);
 
-            hf->heightAt(x, y) = height;
+    if (image.pixelFormat() == Image::R8G8B8A8_UNORM)
+    {
+        ImageView<Image::R8G8B8A8_UNORM, true> in(image);
+        for (unsigned t = 0; t < in.height(); ++t)
+            decodeRGBRow<4>(in.row(t), heights.row(t), in.width(), e);
+    }
+    else if (image.pixelFormat() == Image::R8G8B8_UNORM)
+    {
+        ImageView<Image::R8G8B8_UNORM, true> in(image);
+        for (unsigned t = 0; t < in.height(); ++t)
+            decodeRGBRow<3>(in.row(t), heights.row(t), in.width(), e);
+    }
+    else
+    {
+        // other formats: quantize each pixel back to 8-bit components first
+        Image::Pixel pixel;
+        unsigned char rgb[3];
+        for (unsigned t = 0; t < image.height(); ++t)
+        {
+            for (unsigned s = 0; s < image.width(); ++s)
+            {
+                image.read(pixel, s, t);
+                for (int c = 0; c < 3; ++c)
+                    rgb[c] = (unsigned char)std::lround(clamp(pixel[c], 0.0f, 1.0f) * 255.0f);
+                decodeRGBRow<3>(rgb, heights.at(s, t), 1, e);
+            }
         }
     }
 
     return hf;
 }
+
+shared_ptr<Heightfield>
+ElevationLayer::decodeRGB(shared_ptr<Image> image) const
+{
+    if (!image)
+        return nullptr;
+
+    return decodeRGB(*image, _encoding == Encoding::TerrariumRGB ? Encoding::TerrariumRGB : Encoding::MapboxRGB);
+}
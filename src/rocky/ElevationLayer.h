@@ -19,7 +19,8 @@ namespace ROCKY_NAMESPACE
     public:
         enum class Encoding {
             SingleChannel,
-            MapboxRGB
+            MapboxRGB,      // height = -10000 + (R * 65536 + G * 256 + B) * 0.1
+            TerrariumRGB    // height = (R * 256 + G + B / 256) - 32768
         };
 
         //! Whether this layer contains offsets instead of absolute elevation heights
@@ -42,6 +43,13 @@ namespace ROCKY_NAMESPACE
         void setEncoding(Encoding evalue);
         const optional<Encoding>& encoding() const;
 
+        //! Whether to store heightfields as 16-bit codes with a per-tile
+        //! scale and offset instead of 32-bit floats. Halves the memory and
+        //! texture upload size at the cost of some precision (a tile spanning
+        //! 6500m of relief quantizes to 10cm steps).
+        void setQuantize(bool value);
+        const optional<bool>& quantize() const;
+
         //! Serialize this layer
         std::string to_json() const override;
 
@@ -59,6 +67,11 @@ namespace ROCKY_NAMESPACE
             const TileKey& key,
             const IOOptions& io) const;
 
+        //! Decodes an RGB-encoded elevation image (MapboxRGB or TerrariumRGB)
+        //! into a heightfield of the same size. Mapbox heights outside the
+        //! encoding's valid range become NO_DATA_VALUE.
+        static shared_ptr<Heightfield> decodeRGB(const Image& image, Encoding encoding);
+
     protected: // ElevationLayer
 
         //! Construct (from subclass)
@@ -81,8 +94,9 @@ namespace ROCKY_NAMESPACE
             return Result(GeoHeightfield::INVALID);
         }
 
-        //! Decodes a mapbox RGB encoded heightfield image into a heightfield.
-        shared_ptr<Heightfield> decodeMapboxRGB(shared_ptr<Image> image) const;
+        //! Decodes an RGB encoded heightfield image into a heightfield, using
+        //! the layer's encoding (MapboxRGB unless it's TerrariumRGB).
+        shared_ptr<Heightfield> decodeRGB(shared_ptr<Image> image) const;
 
         virtual ~ElevationLayer() { }
 
@@ -91,6 +105,7 @@ namespace ROCKY_NAMESPACE
         optional<float> _noDataValue = NO_DATA_VALUE;
         optional<float> _minValidValue = -FLT_MAX;
         optional<float> _maxValidValue = FLT_MAX;
+        optional<bool> _quantize = false;
 
     private:
         void construct(const std::string& JSON, const IOOptions& io);
@@ -102,7 +117,10 @@ namespace ROCKY_NAMESPACE
         void normalizeNoDataValues(
             Heightfield* hf) const;
 
-        util::Gate<TileKey> _sentry;
+        //! Coalesces concurrent fetches of the same mosaic source. The result is
+        //! the key the data came from (after fallback), the data, and whether
+        //! the fetch was canceled.
+        mutable util::SingleFlight<TileKey, std::tuple<TileKey, Result<GeoHeightfield>, bool>> _sourceFlights;
 
         mutable util::LRUCache<TileKey, Result<GeoHeightfield>> _L2cache;
 
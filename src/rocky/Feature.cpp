@@ -4,6 +4,7 @@
  * MIT License
  */
 #include "Feature.h"
+#include <limits>
 
 #ifdef ROCKY_HAS_GDAL
 #include <gdal.h> // OGR API
@@ -148,10 +149,74 @@ Feature::dirtyExtent()
     extent = GeoExtent(srs, box);
 }
 
+namespace
+{
+    // Wraps another feature iterator and only returns features whose
+    // extents intersect a filter extent.
+    class ExtentFilterIterator : public FeatureSource::iterator
+    {
+    public:
+        ExtentFilterIterator(std::shared_ptr<FeatureSource::iterator> input, const GeoExtent& extent) :
+            _input(input), _extent(extent)
+        {
+            fetch();
+        }
+
+        bool hasMore() const override
+        {
+            return _hasNext;
+        }
+
+        const Feature& next() override
+        {
+            if (_hasNext)
+            {
+                _current = std::move(_next);
+                fetch();
+            }
+            return _current;
+        }
+
+    private:
+        std::shared_ptr<FeatureSource::iterator> _input;
+        GeoExtent _extent;
+        Feature _next, _current;
+        bool _hasNext = false;
+
+        void fetch()
+        {
+            _hasNext = false;
+            while (_input && _input->hasMore())
+            {
+                auto& feature = _input->next();
+                if (feature.extent.intersects(_extent))
+                {
+                    _next = feature;
+                    _hasNext = true;
+                    break;
+                }
+            }
+        }
+    };
+}
+
+std::shared_ptr<FeatureSource::iterator>
+FeatureSource::iterate(const GeoExtent& extent, IOOptions& io)
+{
+    auto input = iterate(io);
+    if (!input)
+        return { };
+
+    return std::make_shared<ExtentFilterIterator>(input, extent);
+}
+
 #ifdef ROCKY_HAS_GDAL
 
 namespace
 {
+    // iterator chunk size that reads the whole result set at once
+    constexpr std::size_t read_all = std::numeric_limits<std::size_t>::max();
+
     void* open_OGR_layer(void* ds, const std::string& layerName)
     {
         // Open a specific layer within the data source, if applicable:
@@ -480,6 +545,12 @@ OGRFeatureSource::~OGRFeatureSource()
 
 std::shared_ptr<FeatureSource::iterator>
 OGRFeatureSource::iterate(IOOptions& io)
+{
+    return iterate(GeoExtent::INVALID, io);
+}
+
+std::shared_ptr<FeatureSource::iterator>
+OGRFeatureSource::iterate(const GeoExtent& extent, IOOptions& io)
 {
     OGRDataSourceH dsHandle = nullptr;
     OGRLayerH layerHandle = externalLayerHandle;
@@ -513,6 +584,30 @@ OGRFeatureSource::iterate(IOOptions& io)
         i->_source = this;
         i->_dsHandle = dsHandle;
         i->_layerHandle = layerHandle;
+
+        // build a spatial filter in the source's SRS:
+        if (extent.valid())
+        {
+            const SRS& srs = _featureProfile.extent.valid() ?
+                _featureProfile.extent.srs() :
+                externalSRS;
+
+            GeoExtent local_extent = extent.transform(srs);
+            if (local_extent.valid())
+            {
+                OGRGeometryH ring = OGR_G_CreateGeometry(wkbLinearRing);
+                OGR_G_AddPoint(ring, local_extent.xmin(), local_extent.ymin(), 0);
+                OGR_G_AddPoint(ring, local_extent.xmax(), local_extent.ymin(), 0);
+                OGR_G_AddPoint(ring, local_extent.xmax(), local_extent.ymax(), 0);
+                OGR_G_AddPoint(ring, local_extent.xmin(), local_extent.ymax(), 0);
+                OGR_G_AddPoint(ring, local_extent.xmin(), local_extent.ymin(), 0);
+
+                OGRGeometryH polygon = OGR_G_CreateGeometry(wkbPolygon);
+                OGR_G_AddGeometryDirectly(polygon, ring);
+                i->_spatialFilterHandle = polygon;
+            }
+        }
+
         i->init();
         return i;
     }
@@ -554,8 +649,20 @@ OGRFeatureSource::iterator::init()
     }
     else
     {
-        // pre-existing layer with no dataset; iterate it directly.
+        // pre-existing layer with no dataset. Every iterator shares this handle,
+        // and its spatial filter and read position, so read the whole result
+        // under the lock and put the layer back the way we found it.
+        std::lock_guard<std::mutex> lock(_source->_externalLayerMutex);
+
         _resultSetHandle = _layerHandle;
+        OGR_L_SetSpatialFilter(_resultSetHandle, _spatialFilterHandle);
+        OGR_L_ResetReading(_resultSetHandle);
+
+        _chunkSize = read_all;
+        readChunk();
+
+        OGR_L_SetSpatialFilter(_resultSetHandle, nullptr);
+        return;
     }
 
     if (_resultSetHandle)
@@ -571,12 +678,27 @@ OGRFeatureSource::iterator::~iterator()
     {
         OGR_F_Destroy(_nextHandleToQueue);
     }
+
+    if (_dsHandle)
+    {
+        if (_resultSetHandle)
+        {
+            GDALDatasetReleaseResultSet(_dsHandle, _resultSetHandle);
+        }
+
+        OGRReleaseDataSource(_dsHandle);
+    }
+
+    if (_spatialFilterHandle)
+    {
+        OGR_G_DestroyGeometry(_spatialFilterHandle);
+    }
 }
 
 void
 OGRFeatureSource::iterator::readChunk()
 {
-    if (!_resultSetHandle)
+    if (!_resultSetHandle || _resultSetEndReached)
         return;
 
     const SRS& srs = _source->_featureProfile.extent.valid() ?
@@ -610,7 +732,7 @@ OGRFeatureSource::iterator::readChunk()
         }
     }
 
-    if (_chunkSize == ~0)
+    if (_chunkSize == read_all)
     {
         OGR_L_ResetReading(_resultSetHandle);
     }
@@ -12,6 +12,7 @@
 #include <vector>
 #include <stack>
 #include <queue>
+#include <mutex>
 
 namespace ROCKY_NAMESPACE
 {
@@ -255,6 +256,12 @@ namespace ROCKY_NAMESPACE
 
         //! Creates a feature iterator
         virtual std::shared_ptr<iterator> iterate(IOOptions& io) = 0;
+
+        //! Creates a feature iterator that only returns features whose extents
+        //! intersect the given extent. The default implementation filters the
+        //! output of iterate(io); subclasses should override this with a
+        //! spatial query when the underlying store supports one.
+        virtual std::shared_ptr<iterator> iterate(const GeoExtent& extent, IOOptions& io);
     };
 
 
@@ -286,6 +293,10 @@ namespace ROCKY_NAMESPACE
         //! Create an interator to read features from the source
         std::shared_ptr<FeatureSource::iterator> iterate(IOOptions& io) override;
 
+        //! Create an iterator to read features intersecting an extent,
+        //! using an OGR spatial filter
+        std::shared_ptr<FeatureSource::iterator> iterate(const GeoExtent& extent, IOOptions& io) override;
+
         //! Number of features, or -1 if the count isn't available
         int featureCount() const override;
 
@@ -299,6 +310,7 @@ namespace ROCKY_NAMESPACE
         void* _layerHandle = nullptr;
         int _featureCount = -1;
         std::thread::id _dsHandleThreadId;
+        std::mutex _externalLayerMutex;
         FeatureProfile _featureProfile;
         std::string _source;
 
@@ -322,7 +334,7 @@ namespace ROCKY_NAMESPACE
             void* _spatialFilterHandle = nullptr;
             void* _nextHandleToQueue = nullptr;
             bool _resultSetEndReached = false;
-            const std::size_t _chunkSize = 500;
+            std::size_t _chunkSize = 500;
             Feature::ID _idGenerator = 1;
         };
     };
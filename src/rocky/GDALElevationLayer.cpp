@@ -175,7 +175,7 @@ GDALElevationLayer::createHeightfieldImplementation(const TileKey& key, const IO
             }
             else // assume Image::R8G8B8_UNORM?
             {
-                auto hf = decodeMapboxRGB(r.value);
+                auto hf = decodeRGB(r.value);
                 return GeoHeightfield(hf, key.extent());
             }
         }
@@ -51,11 +51,13 @@ GeoHeightfield::init()
         _resolution.x = _extent.width() / (double)(_hf->width() - 1);
         _resolution.y = _extent.height() / (double)(_hf->height() - 1);
 
-        for (unsigned row = 0; row < _hf->height(); ++row)
+        // read through const so quantized heights are decoded
+        const Heightfield& hf = *_hf;
+        for (unsigned row = 0; row < hf.height(); ++row)
         {
-            for (unsigned col = 0; col < _hf->width(); ++col)
+            for (unsigned col = 0; col < hf.width(); ++col)
             {
-                float h = _hf->heightAt(col, row);
+                float h = hf.heightAt(col, row);
                 _maxHeight = std::max(_maxHeight, h);
                 _minHeight = std::min(_minHeight, h);
             }
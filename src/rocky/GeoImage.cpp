@@ -139,11 +139,8 @@ namespace
 
     GDALDataset* createDataSetFromImage(const Image* image, double minX, double minY, double maxX, double maxY, const std::string &projection)
     {
-        //Clone the incoming image
-        shared_ptr<Image> clonedImage = image->clone();
-
-        //Flip the image
-        clonedImage->flipVerticalInPlace();
+        //Clone the incoming image with its rows top-down, as GDAL expects
+        shared_ptr<Image> clonedImage = image->clone(Image::TOP_LEFT);
 
         GDALDataType gdalDataType =
             image->pixelFormat() <= Image::R8G8B8A8_UNORM ? GDT_Byte :
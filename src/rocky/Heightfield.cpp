@@ -5,6 +5,9 @@
  */
 #include "Heightfield.h"
 #include "GeoCommon.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
 
 using namespace ROCKY_NAMESPACE;
 
@@ -55,11 +58,20 @@ Heightfield::Heightfield(Image* image)
 {
     if (image)
     {
+        // heightfield code assumes bottom-up rows
+        image->convertOrigin(BOTTOM_LEFT);
+
         _pixelFormat = image->pixelFormat();
         _width = image->width();
         _height = image->height();
         _depth = image->depth();
         _data = image->releaseData();
+
+        if (auto hf = dynamic_cast<Heightfield*>(image))
+        {
+            _scale = hf->_scale;
+            _offset = hf->_offset;
+        }
     }
 }
 
@@ -68,6 +80,11 @@ Heightfield::cast_from(const Image* rhs)
 {
     if (rhs && rhs->pixelFormat() == PixelFormat::R32_SFLOAT)
         return reinterpret_cast<const Heightfield*>(rhs);
+
+    // a quantized field needs its scale and offset, so it must be a real Heightfield
+    else if (rhs && rhs->pixelFormat() == PixelFormat::R16_UNORM)
+        return dynamic_cast<const Heightfield*>(rhs);
+
     else
         return nullptr;
 }
@@ -270,7 +287,79 @@ Heightfield::heightAtPixel(
 void
 Heightfield::fill(float value)
 {
+    if (quantized())
+    {
+        _scale = 0.0f;
+        _offset = value;
+        std::fill_n(data<std::uint16_t>(), sizeInPixels(), value == NO_DATA_VALUE ? NO_DATA_CODE : 0);
+        return;
+    }
+
     float* ptr = data<float>();
     for (unsigned i = 0; i < sizeInPixels(); ++i)
         *ptr++ = value;
 }
+
+void
+Heightfield::quantize()
+{
+    if (pixelFormat() != R32_SFLOAT || !valid())
+        return;
+
+    auto is_valid = [](float h) { return h != NO_DATA_VALUE && !std::isnan(h); };
+
+    float minHeight = FLT_MAX, maxHeight = -FLT_MAX;
+    forEachHeight([&](float h) {
+        if (is_valid(h)) {
+            minHeight = std::min(minHeight, h);
+            maxHeight = std::max(maxHeight, h);
+        }
+    });
+
+    // all no-data
+    if (minHeight > maxHeight)
+        minHeight = maxHeight = 0.0f;
+
+    // codes 0..NO_DATA_CODE-1 span the valid range
+    _offset = minHeight;
+    _scale = (maxHeight - minHeight) / (float)(NO_DATA_CODE - 1);
+    const float invScale = _scale > 0.0f ? 1.0f / _scale : 0.0f;
+
+    auto origin = _origin;
+    unsigned w = width(), h = height(), d = depth();
+    std::unique_ptr<unsigned char[]> source(releaseData());
+    allocate(R16_UNORM, w, h, d);
+    _origin = origin;
+
+    const float* in = reinterpret_cast<const float*>(source.get());
+    std::uint16_t* out = data<std::uint16_t>();
+    for (unsigned i = 0; i < sizeInPixels(); ++i)
+    {
+        out[i] = is_valid(in[i]) ?
+            (std::uint16_t)std::min(std::lround((in[i] - minHeight) * invScale), (long)(NO_DATA_CODE - 1)) :
+            NO_DATA_CODE;
+    }
+}
+
+void
+Heightfield::dequantize()
+{
+    if (!quantized() || !valid())
+        return;
+
+    auto origin = _origin;
+    unsigned w = width(), h = height(), d = depth();
+    std::unique_ptr<unsigned char[]> source(releaseData());
+    allocate(R32_SFLOAT, w, h, d);
+    _origin = origin;
+
+    const std::uint16_t* in = reinterpret_cast<const std::uint16_t*>(source.get());
+    float* out = data<float>();
+    for (unsigned i = 0; i < sizeInPixels(); ++i)
+    {
+        out[i] = in[i] == NO_DATA_CODE ? NO_DATA_VALUE : (float)in[i] * _scale + _offset;
+    }
+
+    _scale = 1.0f;
+    _offset = 0.0f;
+}
@@ -12,7 +12,8 @@ namespace ROCKY_NAMESPACE
     constexpr float NO_DATA_VALUE = -FLT_MAX;
 
     /**
-     * A grid of height values (32-bit floats).
+     * A grid of height values. Heights are 32-bit floats, or (once quantized)
+     * 16-bit codes with a per-field scale and offset.
      */
     class ROCKY_EXPORT Heightfield : public Inherit<Image, Heightfield>
     {
@@ -31,12 +32,18 @@ namespace ROCKY_NAMESPACE
         //! usage: auto hf = Heightfield::cast_from(image);
         static const Heightfield* cast_from(const Image* rhs);
 
-        //! Access the height value at col, row
+        //! Code marking a missing sample in a quantized heightfield
+        static constexpr std::uint16_t NO_DATA_CODE = 65535;
+
+        //! Access the height value at col, row. The writable version
+        //! only works on a float (unquantized) heightfield; to modify a
+        //! quantized one, clone() and dequantize() it first.
         inline float& heightAt(unsigned col, unsigned row);
         inline float heightAt(unsigned col, unsigned row) const;
 
         //! Visits each height in the field with a user-provided function
-        //! that takes "float" or "float&" as an argument.
+        //! that takes "float" or "float&" as an argument. The writable
+        //! version only works on a float (unquantized) heightfield.
         template<typename FUNC>
         void forEachHeight(FUNC func);
 
@@ -55,6 +62,33 @@ namespace ROCKY_NAMESPACE
 
         //! Fill with a single height value
         void fill(float value);
+
+        //! Converts the heights to 16-bit codes (R16_UNORM) spanning the
+        //! field's valid height range, i.e. height = code * scale + offset.
+        //! Halves the memory; the error is at most half a scale step.
+        void quantize();
+
+        //! Converts a quantized heightfield back to 32-bit floats
+        void dequantize();
+
+        //! Whether the heights are stored as 16-bit codes
+        inline bool quantized() const {
+            return pixelFormat() == R16_UNORM;
+        }
+
+        //! Meters per code step of a quantized heightfield
+        inline float quantizationScale() const {
+            return _scale;
+        }
+
+        //! Height of code zero in a quantized heightfield
+        inline float quantizationOffset() const {
+            return _offset;
+        }
+
+    private:
+        float _scale = 1.0f;
+        float _offset = 0.0f;
     };
 
 
@@ -62,17 +96,24 @@ namespace ROCKY_NAMESPACE
 
     float& Heightfield::heightAt(unsigned c, unsigned r)
     {
+        ROCKY_HARD_ASSERT(!quantized(), "Writable heightAt() on a quantized heightfield");
         return data<float>(c, r);
     }
 
     float Heightfield::heightAt(unsigned c, unsigned r) const
     {
+        if (quantized())
+        {
+            auto code = data<std::uint16_t>(c, r);
+            return code == NO_DATA_CODE ? NO_DATA_VALUE : (float)code * _scale + _offset;
+        }
         return data<float>(c, r);
-    }    
+    }
 
     template<typename FUNC>
     void Heightfield::forEachHeight(FUNC func)
     {
+        ROCKY_HARD_ASSERT(!quantized(), "Writable forEachHeight() on a quantized heightfield");
         float* ptr = data<float>();
         for (auto i = 0u; i < sizeInPixels(); ++i, ++ptr)
             func(*ptr);
@@ -81,6 +122,14 @@ namespace ROCKY_NAMESPACE
     template<typename FUNC>
     void Heightfield::forEachHeight(FUNC func) const
     {
+        if (quantized())
+        {
+            const std::uint16_t* ptr = data<std::uint16_t>();
+            for (auto i = 0u; i < sizeInPixels(); ++i, ++ptr)
+                func(*ptr == NO_DATA_CODE ? NO_DATA_VALUE : (float)*ptr * _scale + _offset);
+            return;
+        }
+
         const float* ptr = data<float>();
         for (auto i = 0u; i < sizeInPixels(); ++i, ++ptr)
             func(*ptr);
@@ -45,7 +45,7 @@ IOOptions::operator = (const IOOptions& rhs)
     services = rhs.services;
     referrer = rhs.referrer;
     maxNetworkAttempts = rhs.maxNetworkAttempts;
-    uriGate = rhs.uriGate;
+    uriFlights = rhs.uriFlights;
     _cancelable = rhs._cancelable;
     _properties = rhs._properties;
     return *this;
@@ -22,6 +22,7 @@ namespace ROCKY_NAMESPACE
     class IOOptions;
     class Image;
     class Layer;
+    template<typename T> struct IOResult;
 
     //! Base class for a cache
     class Cache : public Inherit<Object, Cache>
@@ -100,8 +101,8 @@ namespace ROCKY_NAMESPACE
         //! Referring location for an operation using these options
         std::optional<std::string> referrer;
 
-        //! Gate for seriaizing duplicate URI requests (shared)
-        mutable std::shared_ptr<util::Gate<std::string>> uriGate;
+        //! Coalesces concurrent reads of the same URI into one fetch (shared)
+        mutable std::shared_ptr<util::SingleFlight<std::string, IOResult<Content>>> uriFlights;
 
     public:
         IOOptions& operator = (const IOOptions& rhs);
@@ -147,6 +148,10 @@ namespace ROCKY_NAMESPACE
         bool fromCache = false;
         JSON metadata;
 
+        //! Construct an empty (unavailable) result
+        IOResult() :
+            Result<T>(Status(Status::ResourceUnavailable)) { }
+
         IOResult(const T& result) :
             Result<T>(result) { }
 
@@ -4,6 +4,13 @@
  * MIT License
  */
 #include "Image.h"
+#include <algorithm>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define ROCKY_IMAGE_SSE2
+#endif
 
 using namespace ROCKY_NAMESPACE;
 
@@ -87,11 +94,31 @@ Image::Image(
     allocate(format, cols, rows, depth);
 }
 
+Image::Image(
+    PixelFormat format,
+    unsigned cols,
+    unsigned rows,
+    unsigned depth,
+    unsigned char* data,
+    std::shared_ptr<void> owner,
+    Origin origin) :
+
+    super(),
+    _width(cols), _height(rows), _depth(depth),
+    _pixelFormat(format),
+    _data(data),
+    _origin(origin),
+    _owner(owner)
+{
+    ROCKY_SOFT_ASSERT(data && owner, "Image wrapping foreign data requires an owner");
+}
+
 Image::Image(const Image& rhs) :
     super(rhs)
 {
     allocate(rhs.pixelFormat(), rhs.width(), rhs.height(), rhs.depth());
     memcpy(_data, rhs._data, sizeInBytes());
+    _origin = rhs._origin;
 }
 
 Image::Image(Image&& rhs)
@@ -100,12 +127,16 @@ Image::Image(Image&& rhs)
     _height = rhs._height;
     _depth = rhs._depth;
     _pixelFormat = rhs._pixelFormat;
-    _data = rhs.releaseData();
+    _origin = rhs._origin;
+    _owner = std::move(rhs._owner);
+    _data = rhs._data;
+    rhs._data = nullptr;
+    rhs._width = rhs._height = rhs._depth = 0;
 }
 
 Image::~Image()
 {
-    if (_data)
+    if (_data && !_owner)
         delete[] _data;
 }
 
@@ -129,6 +160,38 @@ Image::clone() const
         _data,
         sizeInBytes());
 
+    clone->_origin = _origin;
+
+    return clone;
+}
+
+shared_ptr<Image>
+Image::clone(Origin new_origin) const
+{
+    if (new_origin == _origin)
+        return clone();
+
+    ROCKY_SOFT_ASSERT_AND_RETURN(_data, nullptr);
+
+    auto clone = Image::create(
+        pixelFormat(), width(), height(), depth());
+
+    // copy the rows in reverse order:
+    auto layerBytes = sizeInBytes() / depth();
+    auto rowBytes = rowSizeInBytes();
+
+    for (unsigned d = 0; d < depth(); ++d)
+    {
+        auto src = _data + d * layerBytes;
+        auto dst = clone->_data + d * layerBytes;
+        for (unsigned row = 0; row < height(); ++row)
+        {
+            memcpy(dst + (height() - 1 - row) * rowBytes, src + row * rowBytes, rowBytes);
+        }
+    }
+
+    clone->_origin = new_origin;
+
     return clone;
 }
 
@@ -151,9 +214,11 @@ Image::allocate(
 
     auto layout = _layouts[pixelFormat()];
 
-    if (_data)
+    if (_data && !_owner)
         delete[] _data;
 
+    _owner = nullptr;
+    _origin = BOTTOM_LEFT;
     _data = new unsigned char[sizeInBytes()];
 
     // simple init for one-byte images
@@ -165,7 +230,17 @@ unsigned char*
 Image::releaseData()
 {
     auto released = _data;
+
+    // someone else owns the data, so hand over a copy
+    if (_data && _owner)
+    {
+        released = new unsigned char[sizeInBytes()];
+        memcpy(released, _data, sizeInBytes());
+        _owner = nullptr;
+    }
+
     _data = nullptr;
+    _origin = BOTTOM_LEFT;
     _width = 0;
     _height = 0;
     _depth = 0;
@@ -186,6 +261,20 @@ Image::copyAsSubImage(
         return false;
     }
 
+    // same format: copy the rows directly
+    if (dst->pixelFormat() == pixelFormat())
+    {
+        return visit([&](auto src)
+            {
+                ImageView<std::decay_t<decltype(src)>::format> out(*dst);
+                auto offset = (std::size_t)dst_start_col * src.num_components;
+
+                for (unsigned r = 0; r < depth(); ++r)
+                    for (unsigned t = 0; t < height(); ++t)
+                        std::copy(src.row(t, r), src.row(t, r) + src.rowLength(), out.row(dst_start_row + t, r) + offset);
+            });
+    }
+
     Pixel pixel;
     for (unsigned r = 0; r < depth(); ++r)
     {
@@ -204,9 +293,30 @@ Image::copyAsSubImage(
 
 void
 Image::flipVerticalInPlace()
+{
+    // the accessors read rows through the origin, so relabeling the
+    // memory layout is all it takes to flip the image.
+    _origin = (_origin == BOTTOM_LEFT) ? TOP_LEFT : BOTTOM_LEFT;
+}
+
+void
+Image::convertOrigin(Origin new_origin)
 {
     ROCKY_TODO("handle compressed pixel formats");
 
+    if (new_origin == _origin || !_data)
+        return;
+
+    if (_owner)
+    {
+        // can't modify memory we do not own; take a reordered copy instead.
+        auto copy = clone(new_origin);
+        _data = copy->releaseData();
+        _owner = nullptr;
+        _origin = new_origin;
+        return;
+    }
+
     auto layerBytes = sizeInBytes() / depth();
     auto rowBytes = rowSizeInBytes();
     auto halfRows = height() / 2;
@@ -223,25 +333,222 @@ Image::flipVerticalInPlace()
                 std::swap(*row1, *row2);
         }
     }
+
+    _origin = new_origin;
 }
 
 void
 Image::fill(const Image::Pixel& value)
 {
-    for (unsigned r = 0; r < depth(); ++r)
-        for (unsigned t = 0; t < height(); ++t)
-            for (unsigned s = 0; s < width(); ++s)
-                write(value, s, t, r);
+    visit([&](auto view)
+        {
+            using View = decltype(view);
+            constexpr unsigned n = View::num_components;
+
+            // convert the value once, then replicate it
+            typename View::component_type texel[n];
+            View::traits::write(value, texel);
+
+            view.eachRow([&](auto* row, unsigned, unsigned)
+                {
+                    for (unsigned s = 0; s < view.width(); ++s, row += n)
+                        for (unsigned c = 0; c < n; ++c)
+                            row[c] = texel[c];
+                });
+        });
 }
 
 
+namespace
+{
+    //! out[i] = a*x[i] + b*y[i] + c*z[i], or out[i] += ... if ACCUMULATE
+    template<bool ACCUMULATE>
+    inline void madd3(float* out, const float* x, const float* y, const float* z, float a, float b, float c, std::size_t n)
+    {
+        std::size_t i = 0;
+#ifdef ROCKY_IMAGE_SSE2
+        const __m128 va = _mm_set1_ps(a), vb = _mm_set1_ps(b), vc = _mm_set1_ps(c);
+        for (; i + 4 <= n; i += 4)
+        {
+            __m128 v = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(va, _mm_loadu_ps(x + i)), _mm_mul_ps(vb, _mm_loadu_ps(y + i))),
+                _mm_mul_ps(vc, _mm_loadu_ps(z + i)));
+            if (ACCUMULATE)
+                v = _mm_add_ps(v, _mm_loadu_ps(out + i));
+            _mm_storeu_ps(out + i, v);
+        }
+#endif
+        for (; i < n; ++i)
+        {
+            float v = a * x[i] + b * y[i] + c * z[i];
+            out[i] = ACCUMULATE ? out[i] + v : v;
+        }
+    }
+
+    //! out[i] += a*x[i]
+    inline void madd1(float* out, const float* x, float a, std::size_t n)
+    {
+        std::size_t i = 0;
+#ifdef ROCKY_IMAGE_SSE2
+        const __m128 va = _mm_set1_ps(a);
+        for (; i + 4 <= n; i += 4)
+            _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), _mm_mul_ps(va, _mm_loadu_ps(x + i))));
+#endif
+        for (; i < n; ++i)
+            out[i] += a * x[i];
+    }
+
+    inline float to_float(uchar v) { return (float)v * denorm_8; }
+    inline float to_float(float v) { return v; }
+    inline void from_float(float v, uchar& out) { out = (uchar)(v * norm_8); } // same as NORM8::write
+    inline void from_float(float v, float& out) { out = v; }
+
+    //! Splits a 3x3 kernel into col * row (outer product) plus a weight
+    //! on the center tap alone, if it can be. Box, gaussian and the box
+    //! sharpening kernels all split this way.
+    bool separate(const float* k, float* col, float* row, float& center)
+    {
+        float largest = 0.0f;
+        for (int i = 0; i < 9; ++i)
+            largest = std::max(largest, std::abs(k[i]));
+
+        if (std::abs(k[0]) <= 1e-6f * largest)
+            return false;
+
+        for (int c = 0; c < 3; ++c)
+            row[c] = k[c];
+        for (int r = 0; r < 3; ++r)
+            col[r] = k[3 * r] / k[0];
+
+        for (int i = 0; i < 9; ++i)
+        {
+            if (i != 4 && std::abs(col[i / 3] * row[i % 3] - k[i]) > 1e-6f * largest)
+                return false;
+        }
+
+        center = k[4] - col[1] * row[1];
+        return true;
+    }
+
+    //! 3x3 convolution of an image whose pixels are "channels" values of type T,
+    //! on whole rows of floats at a time. It streams through the image keeping
+    //! only three rows (and their horizontal passes) in flight, so the working
+    //! set stays in cache. Edges clamp, and the output clamps to [0..1], like
+    //! the generic path in Image::convolve.
+    template<typename T>
+    void convolveRows(const Image& input, Image& output, const float* kernel, unsigned channels)
+    {
+        const unsigned width = input.width(), height = input.height();
+        const std::size_t n = (std::size_t)width * channels;
+        const unsigned rowBytes = input.rowSizeInBytes();
+
+        float col[3], row[3], center = 0.0f;
+        bool separable = separate(kernel, col, row, center);
+
+        // three source rows, each padded by one pixel on both ends; the
+        // horizontal passes of those rows; and one row of output.
+        std::vector<float> buffer((n + 2 * channels) * 3 + n * 3 + n);
+        float* padded[3];
+        float* filtered[3];
+        for (int i = 0; i < 3; ++i)
+        {
+            padded[i] = buffer.data() + (n + 2 * channels) * i;
+            filtered[i] = buffer.data() + (n + 2 * channels) * 3 + n * i;
+        }
+        float* result = buffer.data() + (n + 2 * channels) * 3 + n * 3;
+
+        // byte offset of a row in memory, accounting for the origin
+        auto rowOffset = [&](const Image& image, unsigned t, unsigned r)
+            {
+                auto row = r * height + (image.origin() == Image::BOTTOM_LEFT ? t : height - 1 - t);
+                return (std::size_t)row * rowBytes;
+            };
+
+        for (unsigned r = 0; r < input.depth(); ++r)
+        {
+            int slotRow[3] = { -1, -1, -1 };
+
+            // fetch row t into its slot (if it's not already there)
+            auto fetch = [&](unsigned t) -> unsigned
+                {
+                    unsigned slot = t % 3;
+                    if (slotRow[slot] != (int)t)
+                    {
+                        auto src = reinterpret_cast<const T*>(input.data<uchar>() + rowOffset(input, t, r));
+                        float* dst = padded[slot] + channels;
+                        for (std::size_t i = 0; i < n; ++i)
+                            dst[i] = to_float(src[i]);
+                        for (unsigned c = 0; c < channels; ++c)
+                        {
+                            padded[slot][c] = dst[c];
+                            dst[n + c] = dst[n - channels + c];
+                        }
+
+                        if (separable)
+                        {
+                            float* p = padded[slot];
+                            madd3<false>(filtered[slot], p, p + channels, p + 2 * channels, row[0], row[1], row[2], n);
+                        }
+
+                        slotRow[slot] = (int)t;
+                    }
+                    return slot;
+                };
+
+            for (unsigned t = 0; t < height; ++t)
+            {
+                unsigned above = fetch(t > 0 ? t - 1 : t);
+                unsigned here = fetch(t);
+                unsigned below = fetch(t < height - 1 ? t + 1 : t);
+
+                if (separable)
+                {
+                    madd3<false>(result, filtered[above], filtered[here], filtered[below], col[0], col[1], col[2], n);
+                    if (center != 0.0f)
+                        madd1(result, padded[here] + channels, center, n);
+                }
+                else
+                {
+                    const unsigned rows[3] = { above, here, below };
+                    for (int k = 0; k < 3; ++k)
+                    {
+                        float* p = padded[rows[k]];
+                        if (k == 0)
+                            madd3<false>(result, p, p + channels, p + 2 * channels, kernel[0], kernel[1], kernel[2], n);
+                        else
+                            madd3<true>(result, p, p + channels, p + 2 * channels, kernel[3 * k], kernel[3 * k + 1], kernel[3 * k + 2], n);
+                    }
+                }
+
+                auto dst = reinterpret_cast<T*>(output.data<uchar>() + rowOffset(output, t, r));
+                for (std::size_t i = 0; i < n; ++i)
+                    from_float(clamp(result[i], 0.0f, 1.0f), dst[i]);
+            }
+        }
+    }
+}
+
 std::shared_ptr<Image>
 Image::convolve(const float* kernel) const
 {
-    glm::fvec4 samples[9];
+    ROCKY_SOFT_ASSERT_AND_RETURN(valid() && kernel, nullptr);
 
     auto output = clone();
 
+    // fast paths for the common formats
+    if (pixelFormat() == R8G8B8A8_UNORM)
+    {
+        convolveRows<uchar>(*this, *output, kernel, 4);
+        return output;
+    }
+    else if (pixelFormat() == R32_SFLOAT)
+    {
+        convolveRows<float>(*this, *output, kernel, 1);
+        return output;
+    }
+
+    glm::fvec4 samples[9];
+
     for (unsigned r = 0; r < depth(); ++r)
     {
         for (unsigned t = 0; t < height(); ++t)
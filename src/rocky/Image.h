@@ -7,6 +7,8 @@
 
 #include <rocky/Common.h>
 #include <rocky/Math.h>
+#include <limits>
+#include <type_traits>
 
 namespace ROCKY_NAMESPACE
 {
@@ -41,6 +43,12 @@ namespace ROCKY_NAMESPACE
             UNDEFINED
         };
 
+        //! Order of the image's rows in memory
+        enum Origin {
+            BOTTOM_LEFT, // row t=0 is first in memory (the default)
+            TOP_LEFT     // row t=0 is last in memory
+        };
+
         using Pixel = glm::fvec4;
 
     public:
@@ -59,18 +67,39 @@ namespace ROCKY_NAMESPACE
         //! Whether there's an alpha channel
         bool hasAlphaChannel() const;
 
+        //! Order of the rows in memory. Pixel accessors account for this,
+        //! but code that works on the raw data() pointer must as well.
+        Origin origin() const { return _origin; }
+
+        //! Whether this image owns its data (as opposed to referencing
+        //! memory owned by another object)
+        bool ownsData() const { return _owner == nullptr; }
+
     public:
         //! Construct an empty (invalid) image
         Image() = default;
 
-        //! Construct an image an allocate memory for it,
-        //! unless data is non-null, in which case use that memory
+        //! Construct an image an allocate memory for it
         Image(
             PixelFormat format,
             unsigned s,
             unsigned t,
             unsigned r = 1);
 
+        //! Construct an image that references existing pixel data without copying it.
+        //! @param data Pixel data (layout must match the format and dimensions)
+        //! @param owner Object that keeps "data" alive; the image holds a reference
+        //!   to it for as long as it uses the data
+        //! @param origin Order of the rows in "data"
+        Image(
+            PixelFormat format,
+            unsigned s,
+            unsigned t,
+            unsigned r,
+            unsigned char* data,
+            std::shared_ptr<void> owner,
+            Origin origin = BOTTOM_LEFT);
+
         //! Copy constructor
         Image(const Image& rhs);
 
@@ -95,12 +124,12 @@ namespace ROCKY_NAMESPACE
 
         //! Value (type T) at s, t, layer.
         template<class T> T data(unsigned s, unsigned t, unsigned layer = 0) const {
-            return reinterpret_cast<T*>(_data)[layer*width()*height() + t*width() + s];
+            return reinterpret_cast<T*>(_data)[pixelOffset(s, t, layer)];
         }
 
         //! Mutable reference to the value (type T) at s, t, layer.
         template<class T> T& data(unsigned s, unsigned t, unsigned layer = 0) {
-            return reinterpret_cast<T*>(_data)[layer*width()*height() + t*width() + s];
+            return reinterpret_cast<T*>(_data)[pixelOffset(s, t, layer)];
         }
 
         //! Value at the i'th position in the data array
@@ -144,6 +173,9 @@ namespace ROCKY_NAMESPACE
         //! Creates a deep copy of this image
         virtual std::shared_ptr<Image> clone() const;
 
+        //! Creates a deep copy of this image with its rows in the given order
+        std::shared_ptr<Image> clone(Origin origin) const;
+
         //! Creates a cropped copy of this image
         std::shared_ptr<Image> crop(
             double src_minx, double src_miny,
@@ -166,9 +198,15 @@ namespace ROCKY_NAMESPACE
         std::shared_ptr<Image> convolve(
             const float* kernel) const;
 
-        //! Inverts the pixels in the T dimension
+        //! Inverts the pixels in the T dimension. This only changes the
+        //! image's origin; no pixels move in memory.
         void flipVerticalInPlace();
 
+        //! Reorders the rows in memory to match the given origin, without
+        //! changing the image's content. Takes ownership of the data (by
+        //! copying it) if the image does not already own it.
+        void convertOrigin(Origin origin);
+
         //! Copy this entire image to a sub-location in another image
         bool copyAsSubImage(
             Image* destination,
@@ -201,12 +239,27 @@ namespace ROCKY_NAMESPACE
             return iterator(this);
         }
 
+        //! Calls func with a typed view of this image (an ImageView<FORMAT>
+        //! specialized for its pixel format), for loops that work directly on
+        //! the components instead of converting every pixel through a Pixel.
+        //! Typically func is a generic lambda: [&](auto view) { ... }
+        //! @return false if the pixel format has no view
+        template<class CALLABLE>
+        inline bool visit(CALLABLE&& func);
+
+        //! Calls func with a read-only typed view of this image.
+        template<class CALLABLE>
+        inline bool visit(CALLABLE&& func) const;
+
         //! Fills the entire image with a single value
         void fill(const Pixel& p);
 
         //! Releases this image's data without deleting it. 
         //! Use this to transfer ownership of the raw data to someone else.
-        //! The inheritor is responsible to deleting the data.
+        //! The inheritor is responsible to deleting the data (with delete[]).
+        //! If the image does not own its data, this returns a copy.
+        //! The rows are in the order given by origin(); call convertOrigin() first
+        //! if that matters.
         //! This object becomes invalid unless you call allocate() on it again.
         unsigned char* releaseData();
 
@@ -214,6 +267,13 @@ namespace ROCKY_NAMESPACE
         unsigned _width = 0, _height = 0, _depth = 0;
         PixelFormat _pixelFormat = R8G8B8A8_UNORM;
         unsigned char* _data = nullptr;
+        Origin _origin = BOTTOM_LEFT;
+        std::shared_ptr<void> _owner; // non-null when _data belongs to someone else
+
+        //! Index of a pixel in the data array, accounting for the origin
+        inline unsigned pixelOffset(unsigned s, unsigned t, unsigned r) const {
+            return (r * height() + (_origin == BOTTOM_LEFT ? t : height() - 1 - t)) * width() + s;
+        }
 
         void allocate(
             PixelFormat format,
@@ -235,8 +295,152 @@ namespace ROCKY_NAMESPACE
     };
 
 
+    /**
+     * Compile-time description of a pixel format: the type and number of
+     * components in a pixel, and how they convert to and from a Pixel
+     * (the same way Image::read and Image::write do).
+     */
+    template<Image::PixelFormat FORMAT> struct PixelTraits;
+
+    namespace detail
+    {
+        template<typename T, unsigned N, bool NORMALIZED>
+        struct PixelTraitsBase
+        {
+            using component_type = T;
+            static constexpr unsigned num_components = N;
+
+            static constexpr float scale = NORMALIZED ? (float)std::numeric_limits<T>::max() : 1.0f;
+
+            static inline void read(Image::Pixel& pixel, const T* ptr) {
+                for (unsigned i = 0; i < N; ++i)
+                    pixel[i] = NORMALIZED ? (float)ptr[i] * (1.0f / scale) : (float)ptr[i];
+                if constexpr (NORMALIZED && sizeof(T) == 1)
+                    for (unsigned i = N; i < 4; ++i)
+                        pixel[i] = 1.0f; // fills in alpha if source doesn't have it
+            }
+
+            static inline void write(const Image::Pixel& pixel, T* ptr) {
+                for (unsigned i = 0; i < N; ++i)
+                    ptr[i] = NORMALIZED ? (T)(pixel[i] * scale) : (T)pixel[i];
+            }
+        };
+    }
+
+    template<> struct PixelTraits<Image::R8_UNORM> : public detail::PixelTraitsBase<unsigned char, 1, true> { };
+    template<> struct PixelTraits<Image::R8G8_UNORM> : public detail::PixelTraitsBase<unsigned char, 2, true> { };
+    template<> struct PixelTraits<Image::R8G8B8_UNORM> : public detail::PixelTraitsBase<unsigned char, 3, true> { };
+    template<> struct PixelTraits<Image::R8G8B8A8_UNORM> : public detail::PixelTraitsBase<unsigned char, 4, true> { };
+    template<> struct PixelTraits<Image::R16_UNORM> : public detail::PixelTraitsBase<unsigned short, 1, true> { };
+    template<> struct PixelTraits<Image::R32_SFLOAT> : public detail::PixelTraitsBase<float, 1, false> { };
+    template<> struct PixelTraits<Image::R64_SFLOAT> : public detail::PixelTraitsBase<double, 1, false> { };
+
+    /**
+     * Typed view of an image's pixels for one pixel format. Rows are
+     * contiguous arrays of components (width() * num_components of them)
+     * so loops over a row compile to plain, vectorizable code.
+     * The view does not own or keep alive the image.
+     */
+    template<Image::PixelFormat FORMAT, bool READ_ONLY = false>
+    class ImageView
+    {
+    public:
+        using traits = PixelTraits<FORMAT>;
+        using component_type = typename traits::component_type;
+        using pointer = std::conditional_t<READ_ONLY, const component_type*, component_type*>;
+        using image_type = std::conditional_t<READ_ONLY, const Image, Image>;
+
+        static constexpr Image::PixelFormat format = FORMAT;
+        static constexpr unsigned num_components = traits::num_components;
+
+        //! View an image, which must have this pixel format
+        ImageView(image_type& image) :
+            _data(image.template data<component_type>()),
+            _width(image.width()), _height(image.height()), _depth(image.depth()),
+            _rowLength((std::size_t)image.width() * num_components),
+            _topDown(image.origin() == Image::TOP_LEFT)
+        {
+            ROCKY_SOFT_ASSERT(image.pixelFormat() == FORMAT, "ImageView format does not match the image");
+        }
+
+        unsigned width() const { return _width; }
+        unsigned height() const { return _height; }
+        unsigned depth() const { return _depth; }
+
+        //! Number of components in a row
+        std::size_t rowLength() const { return _rowLength; }
+
+        //! First component of row t (accounting for the image's origin)
+        pointer row(unsigned t, unsigned layer = 0) const {
+            return _data + ((std::size_t)layer * _height + (_topDown ? _height - 1 - t : t)) * _rowLength;
+        }
+
+        //! First component of the pixel at s, t
+        pointer at(unsigned s, unsigned t, unsigned layer = 0) const {
+            return row(t, layer) + (std::size_t)s * num_components;
+        }
+
+        //! Read the pixel at s, t
+        void read(Image::Pixel& pixel, unsigned s, unsigned t, unsigned layer = 0) const {
+            traits::read(pixel, at(s, t, layer));
+        }
+
+        //! Write the pixel at s, t
+        void write(const Image::Pixel& pixel, unsigned s, unsigned t, unsigned layer = 0) const {
+            static_assert(!READ_ONLY, "Cannot write through a read-only ImageView");
+            traits::write(pixel, at(s, t, layer));
+        }
+
+        //! Calls func(pointer row, unsigned t, unsigned layer) for each row
+        template<class CALLABLE>
+        void eachRow(CALLABLE&& func) const {
+            for (unsigned r = 0; r < _depth; ++r)
+                for (unsigned t = 0; t < _height; ++t)
+                    func(row(t, r), t, r);
+        }
+
+    private:
+        pointer _data;
+        unsigned _width, _height, _depth;
+        std::size_t _rowLength;
+        bool _topDown;
+    };
+
+
     // inline functions
 
+    template<class CALLABLE>
+    inline bool Image::visit(CALLABLE&& func)
+    {
+        switch (pixelFormat())
+        {
+        case R8_UNORM: func(ImageView<R8_UNORM>(*this)); return true;
+        case R8G8_UNORM: func(ImageView<R8G8_UNORM>(*this)); return true;
+        case R8G8B8_UNORM: func(ImageView<R8G8B8_UNORM>(*this)); return true;
+        case R8G8B8A8_UNORM: func(ImageView<R8G8B8A8_UNORM>(*this)); return true;
+        case R16_UNORM: func(ImageView<R16_UNORM>(*this)); return true;
+        case R32_SFLOAT: func(ImageView<R32_SFLOAT>(*this)); return true;
+        case R64_SFLOAT: func(ImageView<R64_SFLOAT>(*this)); return true;
+        default: return false;
+        }
+    }
+
+    template<class CALLABLE>
+    inline bool Image::visit(CALLABLE&& func) const
+    {
+        switch (pixelFormat())
+        {
+        case R8_UNORM: func(ImageView<R8_UNORM, true>(*this)); return true;
+        case R8G8_UNORM: func(ImageView<R8G8_UNORM, true>(*this)); return true;
+        case R8G8B8_UNORM: func(ImageView<R8G8B8_UNORM, true>(*this)); return true;
+        case R8G8B8A8_UNORM: func(ImageView<R8G8B8A8_UNORM, true>(*this)); return true;
+        case R16_UNORM: func(ImageView<R16_UNORM, true>(*this)); return true;
+        case R32_SFLOAT: func(ImageView<R32_SFLOAT, true>(*this)); return true;
+        case R64_SFLOAT: func(ImageView<R64_SFLOAT, true>(*this)); return true;
+        default: return false;
+        }
+    }
+
     bool Image::valid() const
     {
         return width() > 0 && height() > 0 && depth() > 0 && _data;
@@ -246,7 +450,7 @@ namespace ROCKY_NAMESPACE
     {
         _layouts[pixelFormat()].read(
             pixel,
-            _data + (width()*height()*r + width()*t + s)*_layouts[pixelFormat()].bytes_per_pixel,
+            _data + pixelOffset(s, t, r) * _layouts[pixelFormat()].bytes_per_pixel,
             _layouts[pixelFormat()].num_components);
     }
 
@@ -282,7 +486,7 @@ namespace ROCKY_NAMESPACE
     {
         _layouts[pixelFormat()].write(
             pixel,
-            _data + (width()*height()*r + height() * t + s)*_layouts[pixelFormat()].bytes_per_pixel,
+            _data + pixelOffset(s, t, r) * _layouts[pixelFormat()].bytes_per_pixel,
             _layouts[pixelFormat()].num_components);
     }
 
@@ -13,6 +13,7 @@
 #include "TileKey.h"
 #include "json.h"
 
+#include <algorithm>
 #include <cinttypes>
 
 using namespace ROCKY_NAMESPACE;
@@ -185,13 +186,25 @@ ImageLayer::createImageInKeyProfile(const TileKey& key, const IOOptions& io) con
                 t0 = clamp(t0, 0, (int)result.value.image()->height() - 1);
                 t1 = clamp(t1, 0, (int)result.value.image()->height() - 1);
 
+                // clear everything outside the crop window, a row span at a time
                 auto image = result.value.image();
-                image->get_iterator().forEachPixel([&](auto& i)
+                image->visit([&](auto view)
                     {
-                        if ((int)i.s() < s0 || (int)i.s() > s1 || (int)i.t() < t0 || (int)i.t() > t1)
-                        {
-                            image->write({ 0,0,0,0 }, i.s(), i.t());
-                        }
+                        constexpr unsigned n = decltype(view)::num_components;
+                        auto end = view.rowLength();
+
+                        view.eachRow([&](auto* row, unsigned t, unsigned)
+                            {
+                                if ((int)t < t0 || (int)t > t1)
+                                {
+                                    std::fill(row, row + end, 0);
+                                }
+                                else
+                                {
+                                    std::fill(row, row + s0 * n, 0);
+                                    std::fill(row + (s1 + 1) * n, row + end, 0);
+                                }
+                            });
                     }
                 );
             }
@@ -97,6 +97,8 @@ const Status&
 Layer::setStatus(const Status& status) const
 {
     _status = status;
+    // publishes everything written by openImplementation() to other threads
+    _isOpen.store(_status.ok(), std::memory_order_release);
     return _status;
 }
 
@@ -117,6 +119,12 @@ Layer::open(const IOOptions& io)
 
     std::unique_lock lock(_state_mutex);
 
+    // another thread may have opened the layer while we waited for the lock
+    if (isOpen())
+    {
+        return status();
+    }
+
     setStatus(openImplementation(io));
 
     Log()->debug("Layer \"{}\" status = {}", name(), status().toString());
@@ -124,6 +132,26 @@ Layer::open(const IOOptions& io)
     return status();
 }
 
+jobs::future<Status>
+Layer::openAsync(const IOOptions& io)
+{
+    // network-bound layers spend most of their open time waiting on
+    // round-trips, so allow more of them in flight than we have cores.
+    auto pool = jobs::get_pool(openPoolName);
+    if (pool->concurrency() < 8u)
+        pool->set_concurrency(8u);
+
+    // hold a reference so the layer survives until the open completes
+    auto layer = shared_from_this();
+
+    auto task = [layer, io](Cancelable&)
+        {
+            return layer->open(io);
+        };
+
+    return jobs::dispatch(task, jobs::context{ "open " + name(), pool });
+}
+
 void
 Layer::close()
 {
@@ -131,7 +159,7 @@ Layer::close()
     {
         std::unique_lock lock(_state_mutex);
         closeImplementation();
-        _status = Status(Status::ResourceUnavailable, "Layer closed");
+        setStatus(Status(Status::ResourceUnavailable, "Layer closed"));
     }
 }
 
@@ -150,7 +178,7 @@ Layer::closeImplementation()
 bool
 Layer::isOpen() const
 {
-    return status().ok();
+    return _isOpen.load(std::memory_order_acquire);
 }
 
 const Status&
@@ -10,7 +10,9 @@
 #include <rocky/DateTime.h>
 #include <rocky/IOTypes.h>
 #include <rocky/Status.h>
+#include <rocky/Threading.h>
 #include <rocky/URI.h>
+#include <atomic>
 #include <vector>
 #include <shared_mutex>
 
@@ -34,7 +36,8 @@ namespace ROCKY_NAMESPACE
      *   open() to initialize any underlying data sources;
      *   addedToMap() to signal to the layer that it is now a member of a Map.
      */
-    class ROCKY_EXPORT Layer : public Inherit<Object, Layer>
+    class ROCKY_EXPORT Layer : public Inherit<Object, Layer>,
+        public std::enable_shared_from_this<Layer>
     {
     public:
         //! Destructor
@@ -51,6 +54,16 @@ namespace ROCKY_NAMESPACE
         //! Open a layer.
         Status open(const IOOptions& options);
 
+        //! Open a layer in the background on the layer-open job pool.
+        //! The layer must be held by a shared_ptr (i.e. made with create()).
+        //! Keep the returned future until it resolves; abandoning it
+        //! before the job starts will cancel the open.
+        //! @return Future result of open()
+        jobs::future<Status> openAsync(const IOOptions& options);
+
+        //! Name of the job pool that runs openAsync()
+        static constexpr const char* openPoolName = "rocky.layers.open";
+
         //! Close this layer.
         void close();
 
@@ -153,6 +166,7 @@ namespace ROCKY_NAMESPACE
         UID _uid = -1;
         RenderType _renderType = RenderType::NONE;
         mutable Status _status = Status_OK;
+        mutable std::atomic_bool _isOpen = { false };
         std::atomic<Revision> _revision = { 1 };
         mutable std::shared_mutex _state_mutex;
         std::string _layerTypeName;
@@ -397,13 +397,22 @@ MBTiles::Driver::write(const TileKey& key, shared_ptr<Image> input, const IOOpti
     if (_forceRGB && input->pixelFormat() == Image::R8G8B8A8_UNORM)
     {
         image_to_write = Image::create(Image::R8G8B8_UNORM, input->width(), input->height(), input->depth());
-        input->get_iterator().forEachPixel([&](const Image::iterator& i)
+        ImageView<Image::R8G8B8A8_UNORM, true> in(*input);
+        ImageView<Image::R8G8B8_UNORM> out(*image_to_write);
+
+        // drop the alpha channel
+        for (unsigned r = 0; r < in.depth(); ++r)
+        {
+            for (unsigned t = 0; t < in.height(); ++t)
             {
-                glm::fvec4 pixel;
-                input->read(pixel, i.s(), i.t(), i.r());
-                image_to_write->write(pixel, i.s(), i.t(), i.r());
+                auto src = in.row(t, r);
+                auto dst = out.row(t, r);
+                for (unsigned s = 0; s < in.width(); ++s, src += 4, dst += 3)
+                {
+                    dst[0] = src[0], dst[1] = src[1], dst[2] = src[2];
+                }
             }
-        );
+        }
     }
 
     Status wr = io.services.writeImageToStream(image_to_write, buf, _options.format, io);
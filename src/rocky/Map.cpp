@@ -148,19 +148,30 @@ Map::removeCallback(UID uid)
     onLayerMoved.remove(uid);
 }
 
+std::vector<jobs::future<Status>>
+Map::openAllLayersAsync(const IOOptions& io)
+{
+    std::vector<jobs::future<Status>> results;
+    for (auto& layer : layers().all())
+    {
+        if (layer->openAutomatically() && !layer->isOpen())
+        {
+            results.emplace_back(layer->openAsync(io));
+        }
+    }
+    return results;
+}
+
 Status
 Map::openAllLayers(const IOOptions& io)
 {
     Status status;
-    for (auto& layer : layers().all())
+    for (auto& result : openAllLayersAsync(io))
     {
-        if (layer->openAutomatically() && !layer->isOpen())
+        auto& layer_status = result.join();
+        if (layer_status.failed())
         {
-            auto layer_status = layer->open(io);
-            if (layer_status.failed())
-            {
-                status = Status_GeneralError;
-            }
+            status = Status_GeneralError;
         }
     }
     return status;
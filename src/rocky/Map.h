@@ -47,8 +47,15 @@ namespace ROCKY_NAMESPACE
         //! Note, this method will be called automatically by the MapNode, but you 
         //! are free to call it manually if you want to force all layers to open 
         //! and check for errors.
+        //! Layers open concurrently; this method waits for all of them.
         Status openAllLayers(const IOOptions& options);
 
+        //! Start opening all layers that are marked for openAutomatically,
+        //! concurrently and without waiting. Each layer becomes available to
+        //! the terrain as soon as it opens.
+        //! @return One future per layer being opened; keep them until they resolve
+        std::vector<jobs::future<Status>> openAllLayersAsync(const IOOptions& options);
+
         //! Gets the revision # of the map. The revision # changes every time
         //! you add, remove, or move layers. You can use this to track changes
         //! in the map model (as a alternative to installing a MapCallback).
@@ -7,6 +7,7 @@
 #include "TileKey.h"
 #include "Math.h"
 #include "json.h"
+#include <mutex>
 
 using namespace ROCKY_NAMESPACE;
 using namespace ROCKY_NAMESPACE::util;
@@ -20,6 +21,52 @@ const double MERC_MINY = -20037508.34278925;
 const double MERC_MAXX = 20037508.34278925;
 const double MERC_MAXY = 20037508.34278925;
 
+namespace
+{
+    //! Process-wide table of distinct profiles. Each one gets a small integer
+    //! id that it shares with every profile equivalent to it.
+    struct ProfileRegistry
+    {
+        struct Entry
+        {
+            std::string wellKnownName;
+            GeoExtent extent;
+            unsigned tx, ty;
+        };
+        std::mutex mutex;
+        std::vector<Entry> distinct; // id = index + 1
+    };
+
+    ProfileRegistry& profile_registry()
+    {
+        static ProfileRegistry registry;
+        return registry;
+    }
+
+    //! Identity of a profile, by the same rules as Profile::equivalentTo used to
+    //! apply on every comparison.
+    std::uint32_t intern_profile(const std::string& wellKnownName, const GeoExtent& extent, unsigned tx, unsigned ty)
+    {
+        auto& registry = profile_registry();
+        std::scoped_lock lock(registry.mutex);
+
+        for (std::uint32_t i = 0; i < registry.distinct.size(); ++i)
+        {
+            auto& entry = registry.distinct[i];
+
+            if (!wellKnownName.empty() && wellKnownName == entry.wellKnownName)
+                return i + 1;
+
+            if (entry.tx == tx && entry.ty == ty && entry.extent == extent &&
+                entry.extent.srs().equivalentTo(extent.srs()))
+                return i + 1;
+        }
+
+        registry.distinct.push_back({ wellKnownName, extent, tx, ty });
+        return (std::uint32_t)registry.distinct.size();
+    }
+}
+
 void
 Profile::setup(
     const SRS& srs,
@@ -78,7 +125,11 @@ Profile::setup(
         // make a profile sig (sans srs) and an srs sig for quick comparisons.
         std::string temp = to_json();
         _shared->_fullSignature = util::make_string() << std::hex << util::hashString(temp);
-        _shared->_hash = std::hash<std::string>()(temp);
+
+        // intern it so comparisons and hashes don't have to look at the SRS or extent;
+        // equivalent profiles (which may serialize differently) share an id and a hash.
+        _shared->_id = intern_profile(_shared->_wellKnownName, _shared->_extent, tx, ty);
+        _shared->_hash = std::hash<std::uint32_t>()(_shared->_id);
     }
 }
 
@@ -94,22 +145,8 @@ Profile::equivalentTo(const Profile& rhs) const
     if (!valid() || !rhs.valid())
         return false;
 
-    if (_shared == rhs._shared)
-        return true;
-
-    if (!_shared->_wellKnownName.empty() && _shared->_wellKnownName == rhs._shared->_wellKnownName)
-        return true;
-
-    if (_shared->_numTilesHighAtLod0 != rhs._shared->_numTilesHighAtLod0)
-        return false;
-
-    if (_shared->_numTilesWideAtLod0 != rhs._shared->_numTilesWideAtLod0)
-        return false;
-
-    if (_shared->_extent != rhs._shared->_extent)
-        return false;
-
-    return _shared->_extent.srs().equivalentTo(rhs._shared->_extent.srs());
+    // equivalent profiles share an id (see intern_profile)
+    return _shared->_id == rhs._shared->_id;
 }
 
 bool
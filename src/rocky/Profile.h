@@ -148,6 +148,11 @@ namespace ROCKY_NAMESPACE
         //! Get the hash code for this profile
         inline std::size_t hash() const;
 
+        //! Identifier shared by all equivalent profiles in this process (0 if
+        //! invalid). Equivalence is resolved once, when a profile is created,
+        //! so comparing profiles is just comparing ids.
+        inline std::uint32_t id() const;
+
         //! Given an input extent, translate it into one or more
         //! GeoExtents in this profile.
         bool transformAndExtractContiguousExtents(
@@ -186,7 +191,8 @@ namespace ROCKY_NAMESPACE
             unsigned    _numTilesHighAtLod0;
             std::string _fullSignature;
             std::string _horizSignature;
-            std::size_t _hash;
+            std::size_t _hash = 0;
+            std::uint32_t _id = 0;
         };
         shared_ptr<Data> _shared;
     };
@@ -196,6 +202,7 @@ namespace ROCKY_NAMESPACE
     const std::string& Profile::getFullSignature() const { return _shared->_fullSignature; }
     const std::string& Profile::getHorizSignature() const { return _shared->_horizSignature; }
     std::size_t Profile::hash() const { return _shared->_hash; }
+    std::uint32_t Profile::id() const { return _shared->_id; }
 }
 
 namespace std {
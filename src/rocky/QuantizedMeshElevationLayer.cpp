@@ -0,0 +1,312 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#include "QuantizedMeshElevationLayer.h"
+#ifdef ROCKY_HAS_TMS
+
+#include "Instance.h"
+#include "Heightfield.h"
+#include "json.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+
+using namespace ROCKY_NAMESPACE;
+
+#undef LC
+#define LC "[QuantizedMesh] "
+
+ROCKY_ADD_OBJECT_FACTORY(QuantizedMeshElevation,
+    [](const std::string& JSON, const IOOptions& io) {
+        return QuantizedMeshElevationLayer::create(JSON, io); })
+
+namespace
+{
+    //! Reads little-endian values from a byte buffer
+    struct Reader
+    {
+        const char* begin;
+        const char* ptr;
+        const char* end;
+
+        bool has(std::size_t bytes) const {
+            return (std::size_t)(end - ptr) >= bytes;
+        }
+
+        template<typename T> T read() {
+            T value;
+            std::memcpy(&value, ptr, sizeof(T));
+            ptr += sizeof(T);
+            return value;
+        }
+
+        void align(std::size_t bytes) {
+            ptr += (bytes - (std::size_t)(ptr - begin) % bytes) % bytes;
+        }
+    };
+
+    // quantized coordinates run from 0 to this value across the tile
+    constexpr float maxQuantized = 32767.0f;
+
+    // center, min/max height, bounding sphere and horizon occlusion point
+    constexpr std::size_t headerSize = 3 * 8 + 2 * 4 + 4 * 8 + 3 * 8;
+}
+
+QuantizedMeshElevationLayer::QuantizedMeshElevationLayer() :
+    super()
+{
+    construct({}, {});
+}
+
+QuantizedMeshElevationLayer::QuantizedMeshElevationLayer(const std::string& JSON, const IOOptions& io) :
+    super(JSON, io)
+{
+    construct(JSON, io);
+}
+
+void
+QuantizedMeshElevationLayer::construct(const std::string& JSON, const IOOptions& io)
+{
+    setLayerTypeName("QuantizedMeshElevation");
+    const auto j = parse_json(JSON);
+    get_to(j, "uri", uri, io);
+    get_to(j, "invert_y", invertY);
+}
+
+JSON
+QuantizedMeshElevationLayer::to_json() const
+{
+    auto j = parse_json(super::to_json());
+    set(j, "uri", uri);
+    set(j, "invert_y", invertY);
+    return j.dump();
+}
+
+Status
+QuantizedMeshElevationLayer::openImplementation(const IOOptions& io)
+{
+    Status parent = super::openImplementation(io);
+    if (parent.failed())
+        return parent;
+
+    if (!uri.has_value() || uri->empty())
+        return Status(Status::ConfigurationError, "Missing required uri");
+
+    setProfile(Profile::GLOBAL_GEODETIC);
+
+    unsigned minLevel = 0u, maxLevel = maxDataLevel().value();
+
+    if (uri->full().find("{z}") != std::string::npos)
+    {
+        _tileTemplate = uri->full();
+    }
+    else
+    {
+        // a tileset folder; its layer.json describes the tiles
+        auto base = uri->full();
+        if (base.back() != '/')
+            base += '/';
+
+        auto fetch = URI(base + "layer.json", uri->context()).read(io);
+        if (fetch.status.failed())
+            return fetch.status;
+
+        const auto j = parse_json(fetch->data);
+        if (j.status.failed())
+            return j.status;
+
+        std::string format, scheme, version, title;
+        std::vector<std::string> tiles;
+        get_to(j, "format", format);
+        get_to(j, "scheme", scheme);
+        get_to(j, "version", version);
+        get_to(j, "name", title);
+        get_to(j, "tiles", tiles);
+        get_to(j, "minzoom", minLevel);
+        get_to(j, "maxzoom", maxLevel);
+
+        if (!format.empty() && format.rfind("quantized-mesh", 0) != 0)
+            return Status(Status::ResourceUnavailable, "Unsupported tile format \"" + format + "\"");
+
+        if (scheme == "slippyMap")
+            invertY.set_default(true);
+
+        _tileTemplate = tiles.empty() ? "{z}/{x}/{y}.terrain?v={version}" : tiles.front();
+        util::replace_in_place(_tileTemplate, "{version}", version);
+
+        if (_tileTemplate.find("://") == std::string::npos)
+            _tileTemplate = base + _tileTemplate;
+
+        if (name().empty() && !title.empty())
+            setName(title);
+    }
+
+    setDataExtents({ DataExtent(profile().extent(), minLevel, maxLevel) });
+
+    return StatusOK;
+}
+
+std::vector<URI>
+QuantizedMeshElevationLayer::tileURIs(const TileKey& key) const
+{
+    // a key in another profile gets assembled from several source tiles
+    if (!isOpen() || key.profile() != profile())
+        return {};
+
+    auto [cols, rows] = profile().numTiles(key.levelOfDetail());
+    unsigned y = invertY.value() ? key.tileY() : rows - key.tileY() - 1;
+
+    auto location = _tileTemplate;
+    util::replace_in_place(location, "{z}", std::to_string(key.levelOfDetail()));
+    util::replace_in_place(location, "{x}", std::to_string(key.tileX()));
+    util::replace_in_place(location, "{y}", std::to_string(y));
+
+    return { URI(location, uri->context()) };
+}
+
+Result<GeoHeightfield>
+QuantizedMeshElevationLayer::createHeightfieldImplementation(const TileKey& key, const IOOptions& io) const
+{
+    if (!isOpen())
+        return status();
+
+    auto locations = tileURIs(key);
+    if (locations.empty())
+        return Status_ResourceUnavailable;
+
+    auto fetch = locations.front().read(io);
+    if (fetch.status.failed())
+        return fetch.status;
+
+    std::string data = std::move(fetch->data);
+
+    // tiles are often stored gzipped
+    if (data.size() >= 2 && (unsigned char)data[0] == 0x1f && (unsigned char)data[1] == 0x8b)
+    {
+#ifdef ROCKY_HAS_ZLIB
+        std::istringstream in(data);
+        std::string inflated;
+        if (!util::ZLibCompressor().decompress(in, inflated))
+            return Status(Status::ResourceUnavailable, "Failed to decompress tile");
+        data = std::move(inflated);
+#else
+        return Status(Status::ResourceUnavailable, "Compressed tile requires zlib support");
+#endif
+    }
+
+    auto hf = decode(data, tileSize(), tileSize());
+    if (hf.status.failed())
+        return hf.status;
+
+    return GeoHeightfield(hf.value, key.extent());
+}
+
+Result<shared_ptr<Heightfield>>
+QuantizedMeshElevationLayer::decode(const std::string& data, unsigned cols, unsigned rows)
+{
+    ROCKY_SOFT_ASSERT_AND_RETURN(cols >= 2 && rows >= 2, Status(Status::AssertionFailure));
+
+    Reader in{ data.data(), data.data(), data.data() + data.size() };
+
+    if (!in.has(headerSize + 4))
+        return Status(Status::ResourceUnavailable, "Quantized mesh header is truncated");
+
+    in.ptr += 3 * 8; // center
+    float minHeight = in.read<float>();
+    float maxHeight = in.read<float>();
+    in.ptr += 4 * 8 + 3 * 8; // bounding sphere, horizon occlusion point
+
+    auto vertexCount = in.read<std::uint32_t>();
+    if (!in.has((std::size_t)vertexCount * 3 * 2))
+        return Status(Status::ResourceUnavailable, "Quantized mesh vertex data is truncated");
+
+    // u, v and height arrays, each zig-zag and delta encoded. Scale u and v
+    // to heightfield samples and height to meters.
+    std::vector<float> x(vertexCount), y(vertexCount), h(vertexCount);
+    const float scale[3] = { (float)(cols - 1) / maxQuantized, (float)(rows - 1) / maxQuantized, (maxHeight - minHeight) / maxQuantized };
+    const float offset[3] = { 0.0f, 0.0f, minHeight };
+    std::vector<float>* arrays[3] = { &x, &y, &h };
+
+    for (int a = 0; a < 3; ++a)
+    {
+        int value = 0;
+        for (auto& out : *arrays[a])
+        {
+            int code = in.read<std::uint16_t>();
+            value += (code >> 1) ^ -(code & 1);
+            out = (float)value * scale[a] + offset[a];
+        }
+    }
+
+    // triangle indices, high-water-mark encoded
+    bool wide = vertexCount > 65536;
+    if (wide)
+        in.align(4);
+
+    if (!in.has(4))
+        return Status(Status::ResourceUnavailable, "Quantized mesh index data is truncated");
+
+    auto triangleCount = in.read<std::uint32_t>();
+    if (!in.has((std::size_t)triangleCount * 3 * (wide ? 4 : 2)))
+        return Status(Status::ResourceUnavailable, "Quantized mesh index data is truncated");
+
+    std::vector<std::uint32_t> indices(triangleCount * 3);
+    std::uint32_t highest = 0;
+    for (auto& index : indices)
+    {
+        std::uint32_t code = wide ? in.read<std::uint32_t>() : in.read<std::uint16_t>();
+        index = highest - code;
+        if (code == 0)
+            ++highest;
+        if (index >= vertexCount)
+            return Status(Status::ResourceUnavailable, "Quantized mesh has an invalid index");
+    }
+
+    // the edge indices and extensions (normals, water mask) that follow
+    // are not needed for a heightfield.
+
+    auto hf = Heightfield::create(cols, rows);
+    hf->fill(NO_DATA_VALUE);
+    ImageView<Image::R32_SFLOAT> heights(*hf);
+
+    // rasterize each triangle into the samples it covers
+    constexpr float epsilon = 1e-5f;
+
+    for (std::size_t i = 0; i < indices.size(); i += 3)
+    {
+        auto i0 = indices[i], i1 = indices[i + 1], i2 = indices[i + 2];
+        float x0 = x[i0], y0 = y[i0], x1 = x[i1], y1 = y[i1], x2 = x[i2], y2 = y[i2];
+
+        float area = (x1 - x0) * (y2 - y0) - (x2 - x0) * (y1 - y0);
+        if (area == 0.0f)
+            continue;
+        float invArea = 1.0f / area;
+
+        int s0 = std::max((int)std::ceil(std::min({ x0, x1, x2 }) - epsilon), 0);
+        int s1 = std::min((int)std::floor(std::max({ x0, x1, x2 }) + epsilon), (int)cols - 1);
+        int t0 = std::max((int)std::ceil(std::min({ y0, y1, y2 }) - epsilon), 0);
+        int t1 = std::min((int)std::floor(std::max({ y0, y1, y2 }) + epsilon), (int)rows - 1);
+
+        for (int t = t0; t <= t1; ++t)
+        {
+            float* row = heights.row(t);
+            for (int s = s0; s <= s1; ++s)
+            {
+                // barycentric weights of the sample
+                float w0 = ((x1 - s) * (y2 - t) - (x2 - s) * (y1 - t)) * invArea;
+                float w1 = ((x2 - s) * (y0 - t) - (x0 - s) * (y2 - t)) * invArea;
+                float w2 = 1.0f - w0 - w1;
+
+                if (w0 >= -epsilon && w1 >= -epsilon && w2 >= -epsilon)
+                    row[s] = w0 * h[i0] + w1 * h[i1] + w2 * h[i2];
+            }
+        }
+    }
+
+    return hf;
+}
+
+#endif // ROCKY_HAS_TMS
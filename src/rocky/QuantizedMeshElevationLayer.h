@@ -0,0 +1,64 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#pragma once
+#include <rocky/Version.h>
+
+#ifdef ROCKY_HAS_TMS
+
+#include <rocky/ElevationLayer.h>
+#include <rocky/URI.h>
+
+namespace ROCKY_NAMESPACE
+{
+    /**
+     * Elevation layer reading quantized-mesh terrain tiles (the Cesium
+     * ".terrain" format) and decoding each one directly into a heightfield.
+     * Tiles use the global geodetic profile (two tiles at the root) and
+     * may come from a local folder or a server.
+     */
+    class ROCKY_EXPORT QuantizedMeshElevationLayer : public Inherit<ElevationLayer, QuantizedMeshElevationLayer>
+    {
+    public:
+        //! Construct an empty quantized-mesh layer
+        QuantizedMeshElevationLayer();
+        QuantizedMeshElevationLayer(const std::string& JSON, const IOOptions& io);
+
+        //! Location of the tileset: either a folder or URL holding a layer.json
+        //! file, or a tile template with {z}, {x} and {y} placeholders
+        optional<URI> uri;
+
+        //! Whether tile rows count down from the north ("slippyMap" scheme)
+        //! instead of up from the south ("tms" scheme, the default)
+        optional<bool> invertY = false;
+
+        //! Serialize
+        std::string to_json() const override;
+
+        //! Location of the tile for a key in the layer's own profile
+        std::vector<URI> tileURIs(const TileKey& key) const override;
+
+        //! Decodes a quantized-mesh-1.0 tile into a heightfield of cols x rows
+        //! samples spanning the tile's extent (edges included).
+        static Result<shared_ptr<Heightfield>> decode(const std::string& data, unsigned cols, unsigned rows);
+
+    public: // Layer
+
+        Status openImplementation(const IOOptions& io) override;
+
+        //! Creates a heightfield for the given tile key
+        Result<GeoHeightfield> createHeightfieldImplementation(const TileKey& key, const IOOptions& io) const override;
+
+    private:
+        std::string _tileTemplate;
+        void construct(const std::string& JSON, const IOOptions& io);
+    };
+}
+
+#else // if !ROCKY_HAS_TMS
+#ifndef ROCKY_BUILDING_SDK
+#error TMS support is not enabled in Rocky.
+#endif
+#endif // ROCKY_HAS_TMS
@@ -9,6 +9,7 @@
 #include "Instance.h"
 
 #include <filesystem>
+#include <mutex>
 #include <proj.h>
 
 #define LC "[SRS] "
@@ -56,6 +57,7 @@ namespace
         std::string proj;
         Ellipsoid ellipsoid = { };
         std::string error;
+        std::uint32_t id = 0; // interned identity (see intern_srs)
     };
 
     //! SRS data factory and PROJ main interface
@@ -458,6 +460,70 @@ namespace
 
     // create an SRS repo per thread since proj is not thread safe.
     thread_local SRSFactory g_srs_factory;
+
+    //! Process-wide table of distinct SRSs. Each one gets a small integer id
+    //! that it shares with every SRS equivalent to it.
+    struct SRSRegistry
+    {
+        std::mutex mutex;
+        std::unordered_map<std::string, std::uint32_t> ids; // id by definition
+        std::vector<std::string> distinct; // first definition seen for each id (id = index + 1)
+    };
+
+    SRSRegistry& srs_registry()
+    {
+        static SRSRegistry registry;
+        return registry;
+    }
+
+    //! Identity of an SRS definition, or 0 if it's invalid. PROJ equivalence
+    //! tests only happen the first time a definition is seen in the process;
+    //! after that each thread finds the id in its own cache entry.
+    std::uint32_t intern_srs(const std::string& def)
+    {
+        auto& entry = g_srs_factory.get_or_create(def);
+
+        if (entry.id == 0 && entry.pj != nullptr)
+        {
+            auto& registry = srs_registry();
+            std::scoped_lock lock(registry.mutex);
+
+            auto iter = registry.ids.find(def);
+            if (iter != registry.ids.end())
+            {
+                entry.id = iter->second;
+            }
+            else
+            {
+                bool geodetic =
+                    entry.horiz_crs_type == PJ_TYPE_GEOGRAPHIC_2D_CRS ||
+                    entry.horiz_crs_type == PJ_TYPE_GEOGRAPHIC_3D_CRS;
+
+                PJ_COMPARISON_CRITERION criterion =
+                    geodetic ? PJ_COMP_EQUIVALENT_EXCEPT_AXIS_ORDER_GEOGCRS :
+                    PJ_COMP_EQUIVALENT;
+
+                std::uint32_t id = 0;
+                for (std::uint32_t i = 0; i < registry.distinct.size() && id == 0; ++i)
+                {
+                    PJ* pj = g_srs_factory.get_or_create(registry.distinct[i]).pj;
+                    if (pj && proj_is_equivalent_to_with_ctx(g_srs_factory.threading_context(), entry.pj, pj, criterion))
+                        id = i + 1;
+                }
+
+                if (id == 0)
+                {
+                    registry.distinct.push_back(def);
+                    id = (std::uint32_t)registry.distinct.size();
+                }
+
+                registry.ids[def] = id;
+                entry.id = id;
+            }
+        }
+
+        return entry.id;
+    }
 }
 
 
@@ -497,6 +563,8 @@ SRS::SRS(const std::string& h) :
             type == PJ_TYPE_GEOGRAPHIC_3D_CRS;
 
         _isGeocentric = type == PJ_TYPE_GEOCENTRIC_CRS;
+
+        _id = intern_srs(h);
     }
 }
 
@@ -548,23 +616,8 @@ SRS::hasVerticalDatumShift() const
 bool
 SRS::equivalentTo(const SRS& rhs) const
 {
-    if (definition().empty() || rhs.definition().empty())
-        return false;
-
-    PJ* pj1 = g_srs_factory.get_or_create(definition()).pj;
-    if (!pj1)
-        return false;
-
-    PJ* pj2 = g_srs_factory.get_or_create(rhs.definition()).pj;
-    if (!pj2)
-        return false;
-
-    PJ_COMPARISON_CRITERION criterion =
-        _isGeodetic ? PJ_COMP_EQUIVALENT_EXCEPT_AXIS_ORDER_GEOGCRS :
-        PJ_COMP_EQUIVALENT;
-
-    return proj_is_equivalent_to_with_ctx(
-        g_srs_factory.threading_context(), pj1, pj2, criterion);
+    // equivalent SRSs share an id (see intern_srs)
+    return _id != 0 && _id == rhs._id;
 }
 
 bool
@@ -573,6 +626,9 @@ SRS::horizontallyEquivalentTo(const SRS& rhs) const
     if (definition().empty() || rhs.definition().empty())
         return false;
 
+    if (_id != 0 && _id == rhs._id)
+        return true;
+
     if (_isGeodetic && rhs._isGeodetic && ellipsoid() == rhs.ellipsoid())
         return true;
 
@@ -8,6 +8,7 @@
 #include <rocky/Common.h>
 #include <rocky/Units.h>
 #include <rocky/Ellipsoid.h>
+#include <cstdint>
 
 namespace ROCKY_NAMESPACE
 {
@@ -107,6 +108,13 @@ namespace ROCKY_NAMESPACE
         //! Whether this SRS is mathematically equivalent to another SRS
         bool equivalentTo(const SRS& rhs) const;
 
+        //! Identifier shared by all equivalent SRSs in this process (0 if invalid).
+        //! Equivalence is resolved once, when an SRS is created, so comparing
+        //! SRSs is just comparing ids.
+        std::uint32_t id() const {
+            return _id;
+        }
+
         //! Whether this SRS is mathematically equivalent to another SRS
         bool operator == (const SRS& rhs) const {
             return equivalentTo(rhs);
@@ -157,6 +165,7 @@ namespace ROCKY_NAMESPACE
         bool _valid = false;
         bool _isGeodetic = false;
         bool _isGeocentric = false;
+        std::uint32_t _id = 0;
         friend class SRSOperation;
     };
 
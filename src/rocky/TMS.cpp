@@ -679,10 +679,9 @@ TMS::Driver::open(const URI& uri, Profile& profile, const std::string& format, D
     return StatusOK;
 }
 
-Result<shared_ptr<Image>>
-TMS::Driver::read(const TileKey& key, bool invertY, bool isMapboxRGB, const URIContext& context, const IOOptions& io) const
+URI
+TMS::Driver::tileURI(const TileKey& key, bool invertY, bool isMapboxRGB, const URIContext& context) const
 {
-    shared_ptr<Image> image;
     URI imageURI;
 
     // create the URI from the tile map?
@@ -700,6 +699,20 @@ TMS::Driver::read(const TileKey& key, bool invertY, bool isMapboxRGB, const URIC
             else
                 imageURI = URI(imageURI.full() + "&mapbox=true", context);
         }
+    }
+
+    return imageURI;
+}
+
+Result<shared_ptr<Image>>
+TMS::Driver::read(const TileKey& key, bool invertY, bool isMapboxRGB, const URIContext& context, const IOOptions& io) const
+{
+    shared_ptr<Image> image;
+
+    // create the URI from the tile map?
+    if (tileMap.valid() && key.levelOfDetail() <= tileMap.maxLevel)
+    {
+        URI imageURI = tileURI(key, invertY, isMapboxRGB, context);
 
         auto fetch = imageURI.read(io);
         if (fetch.status.failed())
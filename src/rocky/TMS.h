@@ -129,6 +129,13 @@ namespace ROCKY_NAMESPACE
                 const URIContext& context,
                 const IOOptions& io) const;
 
+            //! Location of the tile for a key, or an empty URI if there's none
+            URI tileURI(
+                const TileKey& key,
+                bool invertY,
+                bool isMapboxRGB,
+                const URIContext& context) const;
+
             //! Source information structure
             TileMap tileMap;
         };
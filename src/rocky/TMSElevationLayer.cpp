@@ -94,6 +94,20 @@ TMSElevationLayer::closeImplementation()
     super::closeImplementation();
 }
 
+std::vector<URI>
+TMSElevationLayer::tileURIs(const TileKey& key) const
+{
+    // a key in another profile gets assembled from several source tiles
+    if (!isOpen() || key.profile() != profile())
+        return {};
+
+    auto tileURI = _driver.tileURI(key, invertY, _encoding == Encoding::MapboxRGB, uri->context());
+    if (tileURI.empty())
+        return {};
+
+    return { tileURI };
+}
+
 Result<GeoHeightfield>
 TMSElevationLayer::createHeightfieldImplementation(const TileKey& key, const IOOptions& io) const
 {
@@ -111,7 +125,7 @@ TMSElevationLayer::createHeightfieldImplementation(const TileKey& key, const IOO
         }
         else // assume Image::R8G8B8_UNORM?
         {
-            auto hf = decodeMapboxRGB(r.value);
+            auto hf = decodeRGB(r.value);
             return GeoHeightfield(hf, key.extent());
         }
     }
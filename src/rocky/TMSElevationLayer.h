@@ -27,6 +27,9 @@ namespace ROCKY_NAMESPACE
         //! Serialize
         std::string to_json() const override;
 
+        //! Location of the tile for a key in the layer's own profile
+        std::vector<URI> tileURIs(const TileKey& key) const override;
+
         optional<Encoding> encoding;
 
     public: // Layer
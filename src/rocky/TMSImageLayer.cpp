@@ -98,6 +98,20 @@ TMSImageLayer::closeImplementation()
     super::closeImplementation();
 }
 
+std::vector<URI>
+TMSImageLayer::tileURIs(const TileKey& key) const
+{
+    // a key in another profile gets assembled from several source tiles
+    if (!isOpen() || key.profile() != profile())
+        return {};
+
+    auto tileURI = _driver.tileURI(key, invertY, false, uri->context());
+    if (tileURI.empty())
+        return {};
+
+    return { tileURI };
+}
+
 Result<GeoImage>
 TMSImageLayer::createImageImplementation(const TileKey& key, const IOOptions& io) const
 {
@@ -25,6 +25,9 @@ namespace ROCKY_NAMESPACE
         //! serialize
         std::string to_json() const override;
 
+        //! Location of the tile for a key in the layer's own profile
+        std::vector<URI> tileURIs(const TileKey& key) const override;
+
     protected: // Layer
 
         Status openImplementation(const IOOptions& io) override;
@@ -17,7 +17,24 @@ namespace
     void replace_nodata_values(GeoHeightfield& geohf)
     {
         auto grid = geohf.heightfield();
-        if (grid)
+        if (grid && grid->quantized())
+        {
+            // zero may fall outside the quantized range, so decode,
+            // patch and re-encode - but only when there are holes.
+            // The grid may be shared (caches, other tiles) so patch a copy.
+            bool holes = false;
+            const Heightfield& codes = *grid;
+            codes.forEachHeight([&](float h) { holes = holes || h == NO_DATA_VALUE; });
+            if (holes)
+            {
+                auto patched = Heightfield::create(codes);
+                patched->dequantize();
+                patched->forEachHeight([](float& h) { if (h == NO_DATA_VALUE) h = 0.0f; });
+                patched->quantize();
+                geohf = GeoHeightfield(patched, geohf.extent());
+            }
+        }
+        else if (grid)
         {
             for (unsigned col = 0; col < grid->height(); ++col)
             {
@@ -68,10 +85,9 @@ CreateTileManifest::empty() const
 bool
 CreateTileManifest::inSyncWith(const Map* map) const
 {
-#if 0
     for(auto& iter : _layers)
     {
-        auto layer = map->getLayerByUID(iter.first);
+        auto layer = map->layers().withUID(iter.first);
 
         // note: if the layer is null, it was removed, so let it pass.
         if (layer && layer->revision() != iter.second)
@@ -79,23 +95,20 @@ CreateTileManifest::inSyncWith(const Map* map) const
             return false;
         }
     }
-#endif
     return true;
 }
 
 void
 CreateTileManifest::updateRevisions(const Map* map)
 {
-#if 0
     for (auto& iter : _layers)
     {
-        auto layer = map->getLayerByUID(iter.first);
+        auto layer = map->layers().withUID(iter.first);
         if (layer)
         {
             iter.second = layer->revision();
         }
     }
-#endif
 }
 
 bool
@@ -368,26 +381,7 @@ TerrainTileModelFactory::addElevation(
     unsigned border,
     const IOOptions& io)
 {
-    bool needElevation = manifest.includesElevation();
-
-    auto layers = map->layers().all();
-
-    if (layers.empty())
-        return false;
-
-    int combinedRevision = map->revision();
-    if (!manifest.empty())
-    {
-        for (const auto& layer : layers)
-        {
-            if (needElevation == false && manifest.includes(layer.get()))
-            {
-                needElevation = true;
-            }
-            combinedRevision += layer->revision();
-        }
-    }
-    if (!needElevation)
+    if (!manifest.includesElevation())
         return false;
 
     auto layer = map->layers().firstOfType<ElevationLayer>();
@@ -5,6 +5,10 @@
  */
 #pragma once
 #include <rocky/Common.h>
+#include <array>
+#include <atomic>
+#include <future>
+#include <unordered_map>
 #include <vector>
 
 #define WEEJOBS_NAMESPACE jobs
@@ -45,91 +49,91 @@ namespace ROCKY_NAMESPACE
             container_t _data;
         };
 
-        /** Primitive that only allows one thread at a time access to a keyed resourse */
-        template<typename T>
-        class Gate
+        /**
+         * Coalesces concurrent work on the same key ("single flight").
+         * The first caller for a key does the work; callers that arrive while
+         * it's underway wait for it and share its result (or its exception)
+         * instead of repeating it. Nothing is cached: once the work finishes,
+         * the next caller starts over.
+         *
+         * Keys hash to shards with their own locks, so unrelated keys don't
+         * contend with each other.
+         */
+        template<typename K, typename V, typename HASH = std::hash<K>>
+        class SingleFlight
         {
         public:
-            Gate() = default;
-
-            //! Lock key's gate
-            inline void lock(const T& key)
+            SingleFlight() = default;
+
+            //! Runs work() for the key, or if another thread is already
+            //! running it, waits for that call and returns its result.
+            //! @param key Key identifying the work
+            //! @param work Callable returning a V
+            //! @param out_joined Optional; set to true if the result came from
+            //!   another thread's call
+            template<typename CALLABLE>
+            V run(const K& key, CALLABLE&& work, bool* out_joined = nullptr)
             {
-                std::unique_lock<std::mutex> lock(_m);
-                for (;;) {
-                    if (emplace(key))
-                        return;
-                    _block.wait(lock);
+                auto& shard = _shards[HASH()(key) % NUM_SHARDS];
+
+                std::promise<V> promise;
+                {
+                    std::unique_lock lock(shard.mutex);
+                    auto i = shard.inflight.find(key);
+                    if (i != shard.inflight.end())
+                    {
+                        auto future = i->second;
+                        lock.unlock();
+
+                        _joined++;
+                        if (out_joined)
+                            *out_joined = true;
+                        return future.get();
+                    }
+                    shard.inflight.emplace(key, promise.get_future().share());
                 }
-            }
 
-            //! Unlock the key's gate
-            inline void unlock(const T& key)
-            {
-                std::unique_lock<std::mutex> lock(_m);
-                _keys.erase(std::remove(_keys.begin(), _keys.end(), key), _keys.end());
-                _block.notify_all();
-            }
+                if (out_joined)
+                    *out_joined = false;
 
-        private:
-            std::mutex _m;
-            std::condition_variable_any _block;
-            std::vector<T> _keys;
-
-            inline bool emplace(const T& key)
-            {
-                for(auto& k : _keys)
-                    if (k == key)
-                        return false;
-                _keys.emplace_back(key);
-                return true;
+                try
+                {
+                    V value = work();
+                    finish(shard, key);
+                    promise.set_value(value);
+                    return value;
+                }
+                catch (...)
+                {
+                    finish(shard, key);
+                    promise.set_exception(std::current_exception());
+                    throw;
+                }
             }
-        };
 
-        //! Gate the locks for the duration of this object's scope
-        template<typename T>
-        struct ScopedGate
-        {
-        public:
-            //! Lock a gate based on key "key"
-            ScopedGate(Gate<T>& gate, const T& key) :
-                _gate(&gate),
-                _key(key)
-            {
-                if (_gate)
-                    _gate->lock(key);
+            //! Number of calls that shared another call's result
+            //! instead of doing the work themselves
+            std::size_t joined() const {
+                return _joined;
             }
 
-            //! Lock a gate based on key "key" IFF the predicate is true,
-            //! else it's a nop.
-            template<typename CALLABLE>
-            ScopedGate(Gate<T>& gate, const T& key, CALLABLE&& pred) :
-                _gate(pred() ? &gate : nullptr),
-                _key(key)
-            {
-                if (_gate)
-                    _gate->lock(_key);
-            }
+        private:
+            static constexpr unsigned NUM_SHARDS = 16;
 
-            //! Lock a gate if the pointer to the gate is valid; else NOOP.
-            ScopedGate(std::shared_ptr<Gate<T>>& gate, const T& key) :
-                _gate(gate.get()),
-                _key(key)
+            struct Shard
             {
-                if (_gate)
-                    _gate->lock(_key);
-            }
+                std::mutex mutex;
+                std::unordered_map<K, std::shared_future<V>, HASH> inflight;
+            };
+
+            std::array<Shard, NUM_SHARDS> _shards;
+            std::atomic<std::size_t> _joined = { 0 };
 
-            //! End-of-scope destructor unlocks the gate
-            ~ScopedGate()
+            void finish(Shard& shard, const K& key)
             {
-                if (_gate)
-                    _gate->unlock(_key);
+                std::scoped_lock lock(shard.mutex);
+                shard.inflight.erase(key);
             }
-
-        private:
-            Gate<T>* _gate = nullptr;
-            T _key;
         };
     }
 
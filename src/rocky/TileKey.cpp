@@ -22,9 +22,11 @@ TileKey& TileKey::operator = (TileKey&& rhs)
     _x = rhs._x;
     _y = rhs._y;
     _lod = rhs._lod;
+    _profileId = rhs._profileId;
     _profile = std::move(rhs._profile);
     _hash = rhs._hash;
     rhs._profile = {};
+    rhs._profileId = 0;
     return *this;
 }
 
@@ -36,6 +38,7 @@ TileKey::TileKey(
     _y = tile_y;
     _lod = lod;
     _profile = profile;
+    _profileId = profile.valid() ? profile.id() : 0;
     rehash();
 }
 
@@ -47,7 +50,7 @@ TileKey::rehash()
             (std::size_t)_lod, 
             (std::size_t)_x,
             (std::size_t)_y,
-            _profile.hash()) :
+            (std::size_t)_profileId) :
         0ULL;
 }
 
@@ -149,6 +152,8 @@ TileKey::makeParent()
     if (_lod == 0)
     {
         _profile = Profile(); // invalidate
+        _profileId = 0;
+        rehash();
         return false;
     }
 
@@ -17,6 +17,7 @@ namespace ROCKY_NAMESPACE
     /**
      * Uniquely identifies a single tile on the map, relative to a Profile.
      * Profiles have an origin of 0,0 at the top left.
+     * Keys compare and hash by (profile id, lod, x, y), all integers.
      */
     class ROCKY_EXPORT TileKey
     {
@@ -42,27 +43,22 @@ namespace ROCKY_NAMESPACE
             unsigned tile_y,
             const Profile& profile);
 
-        //! Compare two tilekeys for equality.
+        //! Compare two tilekeys for equality. Invalid keys are never equal.
         inline bool operator == (const TileKey& rhs) const {
             return
-                valid() == rhs.valid() &&
+                _profileId != 0 &&
+                _profileId == rhs._profileId &&
                 _lod == rhs._lod &&
                 _x == rhs._x &&
-                _y == rhs._y &&
-                _profile.equivalentTo(rhs._profile);
+                _y == rhs._y;
         }
 
         //! Compare two tilekeys for inequality
         inline bool operator != (const TileKey& rhs) const {
-            return 
-                valid() != rhs.valid() ||
-                _lod != rhs._lod ||
-                _x != rhs._x ||
-                _y != rhs._y ||
-                !_profile.equivalentTo(rhs._profile);
+            return !(*this == rhs);
         }
 
-        //! Sorts tilekeys, ignoring profiles
+        //! Sorts tilekeys by lod, x, y, and then profile
         inline bool operator < (const TileKey& rhs) const {
             if (_lod < rhs._lod) return true;
             if (_lod > rhs._lod) return false;
@@ -70,7 +66,7 @@ namespace ROCKY_NAMESPACE
             if (_x > rhs._x) return false;
             if (_y < rhs._y) return true;
             if (_y > rhs._y) return false;
-            return _profile.getHorizSignature() < rhs._profile.getHorizSignature();
+            return _profileId < rhs._profileId;
         }
 
         //! Canonical invalid tile key
@@ -85,7 +81,7 @@ namespace ROCKY_NAMESPACE
 
         //! Whether this is a valid key.
         bool valid() const {
-            return _profile.valid();
+            return _profileId != 0;
         }
 
         //! Get the quadrant relative to this key's parent.
@@ -175,11 +171,12 @@ namespace ROCKY_NAMESPACE
         }
 
     protected:
-        unsigned _lod;
-        unsigned _x;
-        unsigned _y;
+        unsigned _lod = 0;
+        unsigned _x = 0;
+        unsigned _y = 0;
+        std::uint32_t _profileId = 0; // same as _profile.id(), kept here for fast compares
         Profile _profile;
-        size_t _hash;
+        size_t _hash = 0;
         void rehash();
 
     public:
@@ -431,3 +431,9 @@ TileLayer::mayHaveData(const TileKey& key) const
 {
     return (key == bestAvailableTileKey(key));
 }
+
+std::vector<URI>
+TileLayer::tileURIs(const TileKey& key) const
+{
+    return {};
+}
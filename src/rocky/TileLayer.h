@@ -10,6 +10,7 @@
 #include <rocky/VisibleLayer.h>
 #include <rocky/Profile.h>
 #include <rocky/TileKey.h>
+#include <rocky/URI.h>
 
 namespace ROCKY_NAMESPACE
 {
@@ -101,6 +102,12 @@ namespace ROCKY_NAMESPACE
         //! Extent that is the union of all the extents in dataExtents().
         const DataExtent& dataExtentsUnion() const;
 
+        //! Remote locations that creating data for a key will read, if the
+        //! layer can name them up front. The terrain fetches these on the
+        //! network I/O stage (URI::readAsync) before a loader thread decodes
+        //! the tile. Default is none.
+        virtual std::vector<URI> tileURIs(const TileKey& key) const;
+
     public: // Layer
 
         //! Extent of this layer
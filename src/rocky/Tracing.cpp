@@ -0,0 +1,334 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#include "Tracing.h"
+#include "Threading.h"
+#include "Log.h"
+#include "json.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+using namespace ROCKY_NAMESPACE;
+using namespace ROCKY_NAMESPACE::util;
+
+#define LC "[Trace] "
+
+namespace
+{
+    using Clock = Trace::Clock;
+
+    // Splits a trailing tile key off a name, e.g. "load data 5/3/2"
+    // becomes "load data" and "5/3/2".
+    void splitKey(const std::string& input, std::string& name, std::string& key)
+    {
+        auto pos = input.find_last_of(' ');
+        if (pos != std::string::npos && pos + 1 < input.size())
+        {
+            auto tail = input.substr(pos + 1);
+            if (tail.find('/') != std::string::npos &&
+                tail.find_first_not_of("0123456789/") == std::string::npos)
+            {
+                name = input.substr(0, pos);
+                key = tail;
+                return;
+            }
+        }
+        name = input;
+        key.clear();
+    }
+
+    struct StatsData
+    {
+        std::mutex mutex;
+        std::map<std::string, JobStats::Entry> byPool;
+        std::map<std::string, JobStats::Entry> byName;
+    };
+
+    StatsData& statsData()
+    {
+        static StatsData data;
+        return data;
+    }
+
+    struct TraceSpan
+    {
+        std::string name;
+        std::string key;
+        std::string category;
+        std::uint32_t thread;
+        Clock::time_point queued, start, end;
+    };
+
+    struct TraceData
+    {
+        std::mutex mutex;
+        std::vector<TraceSpan> spans;
+        std::size_t maxSpans = 0;
+        std::size_t dropped = 0;
+        Clock::time_point origin;
+        std::map<std::uint32_t, std::string> threadNames;
+    };
+
+    TraceData& traceData()
+    {
+        static TraceData data;
+        return data;
+    }
+
+    std::atomic_bool statsEnabled = { false };
+    std::atomic_bool traceActive = { false };
+
+    // small, stable id for the calling thread
+    std::uint32_t threadID()
+    {
+        static std::atomic_uint next = { 1u };
+        thread_local std::uint32_t id = next++;
+        return id;
+    }
+
+    void record(
+        const std::string& name, const std::string& category,
+        Clock::time_point queued, Clock::time_point start, Clock::time_point end,
+        const std::string* threadName)
+    {
+        TraceSpan span;
+        splitKey(name, span.name, span.key);
+        span.category = category;
+        span.thread = threadID();
+        span.queued = queued;
+        span.start = start;
+        span.end = end;
+
+        auto& data = traceData();
+        std::scoped_lock lock(data.mutex);
+
+        if (data.spans.size() >= data.maxSpans)
+        {
+            ++data.dropped;
+            return;
+        }
+
+        if (threadName && data.threadNames.count(span.thread) == 0)
+        {
+            data.threadNames[span.thread] = *threadName;
+        }
+
+        data.spans.emplace_back(std::move(span));
+    }
+
+    void observeJob(const jobs::job_timing& job)
+    {
+        if (statsEnabled)
+        {
+            std::string name, key;
+            splitKey(job.ctx.name, name, key);
+
+            auto& data = statsData();
+            std::scoped_lock lock(data.mutex);
+
+            for (auto* entry : { &data.byPool[job.pool], &data.byName[name] })
+            {
+                entry->wait.add(job.started - job.queued);
+                if (job.canceled)
+                    ++entry->canceled;
+                else
+                    entry->run.add(job.finished - job.started);
+            }
+        }
+
+        if (traceActive && !job.canceled)
+        {
+            record(job.ctx.name, job.pool, job.queued, job.started, job.finished, &job.pool);
+        }
+    }
+
+    // the job observer is only installed while someone is listening
+    void updateJobObserver()
+    {
+        if (statsEnabled || traceActive)
+            jobs::set_job_observer(observeJob);
+        else
+            jobs::set_job_observer(nullptr);
+    }
+}
+
+void
+LatencyHistogram::add(std::chrono::steady_clock::duration value)
+{
+    auto micros = (std::uint64_t)std::max((std::int64_t)0,
+        (std::int64_t)std::chrono::duration_cast<std::chrono::microseconds>(value).count());
+
+    // bucket i holds durations under 2^i us
+    unsigned i = 0;
+    while (i < numBuckets - 1 && (micros >> i) > 0)
+        ++i;
+
+    ++buckets[i];
+    ++_count;
+    _totalMicros += micros;
+}
+
+std::chrono::microseconds
+LatencyHistogram::mean() const
+{
+    return std::chrono::microseconds(_count > 0 ? _totalMicros / _count : 0);
+}
+
+std::chrono::microseconds
+LatencyHistogram::percentile(float p) const
+{
+    if (_count == 0)
+        return std::chrono::microseconds(0);
+
+    auto target = (std::uint64_t)std::ceil(std::clamp(p, 0.0f, 1.0f) * (float)_count);
+    std::uint64_t sum = 0;
+    for (unsigned i = 0; i < numBuckets; ++i)
+    {
+        sum += buckets[i];
+        if (sum >= target && sum > 0)
+            return std::chrono::microseconds(std::uint64_t(1) << i);
+    }
+    return std::chrono::microseconds(std::uint64_t(1) << (numBuckets - 1));
+}
+
+void
+JobStats::setEnabled(bool value)
+{
+    statsEnabled = value;
+    updateJobObserver();
+}
+
+bool
+JobStats::enabled()
+{
+    return statsEnabled;
+}
+
+std::map<std::string, JobStats::Entry>
+JobStats::byPool()
+{
+    auto& data = statsData();
+    std::scoped_lock lock(data.mutex);
+    return data.byPool;
+}
+
+std::map<std::string, JobStats::Entry>
+JobStats::byName()
+{
+    auto& data = statsData();
+    std::scoped_lock lock(data.mutex);
+    return data.byName;
+}
+
+void
+JobStats::reset()
+{
+    auto& data = statsData();
+    std::scoped_lock lock(data.mutex);
+    data.byPool.clear();
+    data.byName.clear();
+}
+
+void
+Trace::start(std::size_t maxSpans)
+{
+    {
+        auto& data = traceData();
+        std::scoped_lock lock(data.mutex);
+        data.spans.clear();
+        data.threadNames.clear();
+        data.maxSpans = maxSpans;
+        data.dropped = 0;
+        data.origin = Clock::now();
+    }
+
+    traceActive = true;
+    updateJobObserver();
+}
+
+bool
+Trace::active()
+{
+    return traceActive;
+}
+
+void
+Trace::span(const std::string& name, const std::string& category, Clock::time_point queued, Clock::time_point start, Clock::time_point end)
+{
+    if (traceActive)
+    {
+        record(name, category, queued, start, end, nullptr);
+    }
+}
+
+Status
+Trace::stop(const std::string& filename)
+{
+    traceActive = false;
+    updateJobObserver();
+
+    std::vector<TraceSpan> spans;
+    std::map<std::uint32_t, std::string> threadNames;
+    Clock::time_point origin;
+    std::size_t dropped;
+    {
+        auto& data = traceData();
+        std::scoped_lock lock(data.mutex);
+        spans.swap(data.spans);
+        threadNames.swap(data.threadNames);
+        origin = data.origin;
+        dropped = data.dropped;
+    }
+
+    std::ofstream out(filename);
+    if (!out.is_open())
+    {
+        return Status(Status::ResourceUnavailable, "Cannot write trace to " + filename);
+    }
+
+    auto micros = [&](Clock::duration d) {
+        return 1e-3 * (double)std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+    };
+
+    auto str = [](const std::string& value) {
+        return json(value).dump();
+    };
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out << "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":1,\"args\":{\"name\":\"rocky\"}}";
+
+    for (auto& [thread, name] : threadNames)
+    {
+        out << ",\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << thread
+            << ",\"args\":{\"name\":" << str(name) << "}}";
+    }
+
+    for (auto& span : spans)
+    {
+        out << ",\n{\"ph\":\"X\",\"pid\":1,\"tid\":" << span.thread
+            << ",\"name\":" << str(span.name)
+            << ",\"cat\":" << str(span.category)
+            << ",\"ts\":" << micros(span.start - origin)
+            << ",\"dur\":" << micros(span.end - span.start)
+            << ",\"args\":{\"wait_us\":" << micros(span.start - span.queued);
+
+        if (!span.key.empty())
+            out << ",\"key\":" << str(span.key);
+
+        out << "}}";
+    }
+
+    out << "\n]}\n";
+    out.close();
+
+    Log()->info(LC "Wrote {} spans to {}{}", spans.size(), filename,
+        dropped > 0 ? " (" + std::to_string(dropped) + " dropped)" : std::string());
+
+    return StatusOK;
+}
@@ -0,0 +1,142 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#pragma once
+
+#include <rocky/Common.h>
+#include <rocky/Status.h>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace ROCKY_NAMESPACE
+{
+    namespace util
+    {
+        /**
+         * Histogram of durations in power-of-two microsecond buckets,
+         * from under 1us up to about two minutes.
+         */
+        class ROCKY_EXPORT LatencyHistogram
+        {
+        public:
+            static constexpr unsigned numBuckets = 28;
+
+            //! Count one duration
+            void add(std::chrono::steady_clock::duration value);
+
+            //! Number of durations counted
+            std::uint64_t count() const { return _count; }
+
+            //! Mean of the durations counted
+            std::chrono::microseconds mean() const;
+
+            //! Estimate of the duration below which the fraction p (0..1) of
+            //! the counted durations fall, i.e. the upper bound of its bucket.
+            std::chrono::microseconds percentile(float p) const;
+
+            //! Counts per bucket; bucket i holds durations under 2^i us.
+            std::array<std::uint64_t, numBuckets> buckets = { };
+
+        private:
+            std::uint64_t _count = 0;
+            std::uint64_t _totalMicros = 0;
+        };
+
+        /**
+         * Process-wide latency statistics for the jobs in every job pool: how
+         * long each job waited in its queue, how long it ran, and how often it
+         * was canceled. Jobs are grouped by pool and by name, where a name
+         * loses any trailing tile key (so "load data 5/3/2" counts under
+         * "load data"). Collecting is off until enabled.
+         */
+        class ROCKY_EXPORT JobStats
+        {
+        public:
+            struct Entry
+            {
+                LatencyHistogram wait;
+                LatencyHistogram run;
+                std::uint64_t canceled = 0;
+
+                //! Fraction of the jobs that were canceled
+                float cancelRate() const {
+                    auto total = wait.count();
+                    return total > 0 ? (float)canceled / (float)total : 0.0f;
+                }
+            };
+
+            //! Start or stop collecting statistics
+            static void setEnabled(bool value);
+
+            //! Whether statistics are being collected
+            static bool enabled();
+
+            //! Snapshot of the statistics per job pool
+            static std::map<std::string, Entry> byPool();
+
+            //! Snapshot of the statistics per job name
+            static std::map<std::string, Entry> byName();
+
+            //! Discard the statistics collected so far
+            static void reset();
+        };
+
+        /**
+         * Process-wide recorder of timed spans, written out in the Chrome trace
+         * event format (JSON) that chrome://tracing and ui.perfetto.dev open.
+         * While a trace is running it records every job from every job pool,
+         * along with any span the SDK reports (e.g. the terrain pager stages).
+         * A span name that ends in a tile key records the key separately.
+         */
+        class ROCKY_EXPORT Trace
+        {
+        public:
+            using Clock = std::chrono::steady_clock;
+
+            //! Start recording, discarding any previous trace.
+            //! @param maxSpans Spans to record before dropping new ones
+            static void start(std::size_t maxSpans = 1000000);
+
+            //! Stop recording and write the trace to a JSON file
+            static Status stop(const std::string& filename);
+
+            //! Whether a trace is recording
+            static bool active();
+
+            //! Record a span on the calling thread.
+            //! @param name Name of the span, optionally followed by a tile key
+            //! @param category Category of the span, e.g. a job pool name
+            //! @param queued When the work was requested
+            //! @param start When the work started
+            //! @param end When the work finished
+            static void span(
+                const std::string& name,
+                const std::string& category,
+                Clock::time_point queued,
+                Clock::time_point start,
+                Clock::time_point end);
+
+            //! Records a span from construction to destruction
+            class Scope
+            {
+            public:
+                Scope(const std::string& name, const std::string& category, Clock::time_point queued = {}) :
+                    _name(name), _category(category), _queued(queued), _start(Clock::now()) { }
+
+                ~Scope() {
+                    if (active())
+                        span(_name, _category, _queued == Clock::time_point{} ? _start : _queued, _start, Clock::now());
+                }
+
+            private:
+                std::string _name, _category;
+                Clock::time_point _queued, _start;
+            };
+        };
+    }
+}
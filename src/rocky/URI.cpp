@@ -17,6 +17,10 @@
 #include <cstdlib>
 #include <random>
 #include <algorithm>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 
 #ifdef ROCKY_HAS_HTTPLIB
     #ifdef ROCKY_HAS_OPENSSL
@@ -183,10 +187,8 @@ namespace
     }
 
 
-    IOResult<HTTPResponse> http_get_curl(const HTTPRequest& request, const IOOptions& io)
+    CURL* create_curl_handle(const HTTPRequest& request, stream_object& so, curl_slist*& headers, char* errorBuf)
     {
-        HTTPResponse response;
-
         auto handle = curl_easy_init();
 
         curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, stream_object_write_function);
@@ -209,7 +211,6 @@ namespace
         //todo: proxy server
 
         // request headers:
-        struct curl_slist* headers = nullptr;
         for (auto& h : request.headers)
         {
             std::string header = h.name + ": " + h.value;
@@ -218,18 +219,79 @@ namespace
         curl_easy_setopt(handle, CURLOPT_HTTPHEADER, headers);
         curl_easy_setopt(handle, CURLOPT_URL, request.url.c_str());
 
-        stream_object so;
         curl_easy_setopt(handle, CURLOPT_WRITEDATA, (void*)&so);
         curl_easy_setopt(handle, CURLOPT_HEADERDATA, (void*)&so);
 
-        char errorBuf[CURL_ERROR_SIZE];
         errorBuf[0] = 0;
         curl_easy_setopt(handle, CURLOPT_ERRORBUFFER, (void*)errorBuf);
 
-        CURLcode result = CURLE_OK;
-        std::random_device device;
-        std::default_random_engine engine(device());
+        return handle;
+    }
+
+    // whether a failed attempt is worth repeating
+    bool curl_should_retry(CURLcode result, long status)
+    {
+        return
+            result == CURLE_COULDNT_CONNECT ||
+            result == CURLE_OPERATION_TIMEDOUT ||
+            (result == CURLE_OK && status == 429); // TOO MANY REQUESTS (rate limiting)
+    }
+
+    std::chrono::milliseconds curl_retry_delay(unsigned attempt)
+    {
+        thread_local std::default_random_engine engine(std::random_device{}());
         std::uniform_real_distribution distribution;
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            1000ms * std::pow(2, attempt + distribution(engine)));
+    }
+
+    IOResult<HTTPResponse> curl_response(
+        const std::string& url, CURLcode result, long status, stream_object& so, const char* errorBuf,
+        std::chrono::steady_clock::duration elapsed)
+    {
+        if (result != CURLE_OK)
+        {
+            return Status(Status::ServiceUnavailable, errorBuf);
+        }
+
+        HTTPResponse response;
+        response.status = (int)status;
+        response.data = so.stream.str();
+        response.headers = so.headers;
+
+        if (httpDebug)
+        {
+            auto dur_ms = 1e-6 * (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+            auto cti = findHeader(response.headers, "Content-Type");
+            auto ct = cti.empty() ? "unknown" : cti;
+            Log()->info(LC "({} {:3d}ms {:6}b {}) HTTP GET {}", response.status, (int)dur_ms, response.data.size(), ct, url);
+        }
+
+        if (response.status != 200)
+        {
+            if (response.status == 404) // NOT FOUND (permanent)
+            {
+                return Status(Status::ResourceUnavailable, url);
+            }
+            else
+            {
+                return Status(Status::ResourceUnavailable, std::to_string(response.status));
+            }
+        }
+
+        return response;
+    }
+
+    IOResult<HTTPResponse> http_get_curl(const HTTPRequest& request, const IOOptions& io)
+    {
+        stream_object so;
+        curl_slist* headers = nullptr;
+        char errorBuf[CURL_ERROR_SIZE];
+
+        auto handle = create_curl_handle(request, so, headers, errorBuf);
+
+        CURLcode result = CURLE_OK;
+        long status = 0;
 
         auto t0 = std::chrono::steady_clock::now();
 
@@ -239,62 +301,30 @@ namespace
         {
             if (attempts > 1)
             {
-                auto delay = 1000ms * std::pow(2, attempts + distribution(engine));
                 if (!io.canceled())
-                    std::this_thread::sleep_for(delay);
+                    std::this_thread::sleep_for(curl_retry_delay(attempts));
             }
 
+            so.stream.str({});
+            so.headers.clear();
+
             result = curl_easy_perform(handle);
 
-            if (result == CURLE_COULDNT_CONNECT || result == CURLE_OPERATION_TIMEDOUT)
+            if (result == CURLE_OK)
             {
-                continue;
+                curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &status);
             }
 
-            curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &response.status);
-
-            if (response.status == 429) // TOO MANY REQUESTS (rate limiting)
+            if (!curl_should_retry(result, status))
             {
-                continue;
+                break;
             }
-
-            break;
         }
 
         curl_easy_cleanup(handle);
+        curl_slist_free_all(headers);
 
-        if (result == CURLE_OK)
-        {
-            response.data = so.stream.str();
-            response.headers = so.headers;
-
-            auto t1 = std::chrono::steady_clock::now();
-            if (httpDebug)
-            {
-                auto dur_ms = 1e-6 * (double)(t1 - t0).count();
-                auto cti = findHeader(response.headers, "Content-Type");
-                auto ct = cti.empty() ? "unknown" : cti;
-                Log()->info(LC "({} {:3d}ms {:6}b {}) HTTP GET {}", response.status, (int)dur_ms, response.data.size(), ct, request.url);
-            }
-
-            if (response.status != 200)
-            {
-                if (response.status == 404) // NOT FOUND (permanent)
-                {
-                    return Status(Status::ResourceUnavailable, request.url);
-                }
-                else
-                {
-                    return Status(Status::ResourceUnavailable, std::to_string(response.status));
-                }
-            }
-        }
-        else
-        {
-            return Status(Status::ServiceUnavailable, errorBuf);
-        }
-
-        return response;
+        return curl_response(request.url, result, status, so, errorBuf, std::chrono::steady_clock::now() - t0);
     }
 #endif
 
@@ -437,6 +467,294 @@ namespace
         return Status(Status::ServiceUnavailable, "HTTP not supported without curl or httplib");
 #endif
     }
+
+    HTTPRequest createRequest(const std::string& url, const URIContext& context, std::string::size_type r0, std::string::size_type r1)
+    {
+        HTTPRequest request{ url };
+
+        for(auto& header : context.headers)
+        {
+            request.headers.push_back({ header.first, header.second });
+        }
+
+        // resolve a rotation:
+        static std::atomic_int rotator = { 0 };
+        if (r0 != std::string::npos && r1 != std::string::npos)
+        {
+            util::replace_in_place(
+                request.url,
+                request.url.substr(r0, r1 - r0 + 1),
+                request.url.substr(r0 + 1 + (rotator++ % (r1 - r0 - 1)), 1));
+        }
+
+        return request;
+    }
+
+    Content createContent(const HTTPRequest& request, HTTPResponse& response)
+    {
+        std::string contentType = findHeader(response.headers, "Content-Type");
+
+        if (contentType.empty())
+        {
+            auto p = request.url.find_first_of('?');
+            auto url_path = p != std::string::npos ? request.url.substr(0, p) : request.url;
+            contentType = inferContentTypeFromFileExtension(url_path);
+        }
+
+        if (contentType.empty())
+        {
+            contentType = inferContentTypeFromData(response.data);
+        }
+
+        return { contentType, std::move(response.data) };
+    }
+
+    IOResult<Content> canceledRead()
+    {
+        IOResult<Content> canceled(Status(Status::ResourceUnavailable, "Read canceled"));
+        canceled.ioCode = canceled.RESULT_CANCELED;
+        return canceled;
+    }
+
+    std::atomic<unsigned> maxConcurrentReads = { 32u };
+
+    // A read in flight on the network I/O stage (see URI::readAsync)
+    struct AsyncRead
+    {
+        std::string location; // full URI, the content cache key
+        HTTPRequest request;
+        IOOptions io;
+        jobs::future<IOResult<Content>> promise;
+
+        //! The caller canceled the read, or nobody holds its future any more
+        bool canceled() const
+        {
+            return io.canceled() || promise.canceled();
+        }
+
+        void complete(IOResult<HTTPResponse>&& r)
+        {
+            if (canceled())
+            {
+                promise.resolve(canceledRead());
+            }
+            else if (r.status.failed())
+            {
+                promise.resolve(IOResult<Content>::propagate(r));
+            }
+            else
+            {
+                auto content = createContent(request, r.value);
+
+                if (io.services.contentCache)
+                {
+                    io.services.contentCache->put(location, Result<Content>(content));
+                }
+
+                promise.resolve(IOResult<Content>(content));
+            }
+        }
+    };
+
+#if defined(ROCKY_HAS_CURL)
+
+    // Runs every async read on one thread through a curl multi handle, so
+    // any number of requests can wait on the network without a thread each.
+    class CurlMultiLoop
+    {
+    public:
+        static CurlMultiLoop& instance()
+        {
+            static CurlMultiLoop loop;
+            return loop;
+        }
+
+        void submit(std::shared_ptr<AsyncRead> read)
+        {
+            auto transfer = std::make_unique<Transfer>();
+            transfer->read = read;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _submitted.emplace_back(std::move(transfer));
+            }
+            curl_multi_wakeup(_multi);
+        }
+
+    private:
+        struct Transfer
+        {
+            std::shared_ptr<AsyncRead> read;
+            CURL* handle = nullptr;
+            curl_slist* headers = nullptr;
+            stream_object so;
+            char errorBuf[CURL_ERROR_SIZE];
+            unsigned attempts = 0;
+            std::chrono::steady_clock::time_point start;
+            std::chrono::steady_clock::time_point notBefore;
+
+            ~Transfer()
+            {
+                if (handle) curl_easy_cleanup(handle);
+                if (headers) curl_slist_free_all(headers);
+            }
+        };
+
+        CURLM* _multi = nullptr;
+        std::mutex _mutex;
+        std::vector<std::unique_ptr<Transfer>> _submitted;
+        std::atomic_bool _done = { false };
+        std::thread _thread;
+
+        CurlMultiLoop()
+        {
+            _multi = curl_multi_init();
+            _thread = std::thread([this]() { run(); });
+        }
+
+        ~CurlMultiLoop()
+        {
+            _done = true;
+            curl_multi_wakeup(_multi);
+            if (_thread.joinable())
+                _thread.join();
+            curl_multi_cleanup(_multi);
+        }
+
+        void run()
+        {
+            // transfers that haven't started, or are backing off before a retry:
+            std::list<std::unique_ptr<Transfer>> waiting;
+            std::unordered_map<CURL*, std::unique_ptr<Transfer>> active;
+
+            while (!_done)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    for (auto& t : _submitted)
+                        waiting.emplace_back(std::move(t));
+                    _submitted.clear();
+                }
+
+                auto now = std::chrono::steady_clock::now();
+                auto max_active = std::max(1u, maxConcurrentReads.load());
+
+                // start waiting transfers in order, up to the limit:
+                for (auto i = waiting.begin(); i != waiting.end(); )
+                {
+                    auto& t = *i;
+                    if (t->read->canceled())
+                    {
+                        t->read->complete({});
+                        i = waiting.erase(i);
+                    }
+                    else if (active.size() < max_active && t->notBefore <= now)
+                    {
+                        if (!t->handle)
+                        {
+                            t->handle = create_curl_handle(t->read->request, t->so, t->headers, t->errorBuf);
+                            t->start = now;
+                        }
+
+                        t->so.stream.str({});
+                        t->so.headers.clear();
+                        ++t->attempts;
+
+                        curl_multi_add_handle(_multi, t->handle);
+                        active[t->handle] = std::move(t);
+                        i = waiting.erase(i);
+                    }
+                    else ++i;
+                }
+
+                int running = 0;
+                curl_multi_perform(_multi, &running);
+
+                int queued = 0;
+                while (auto* msg = curl_multi_info_read(_multi, &queued))
+                {
+                    if (msg->msg != CURLMSG_DONE)
+                        continue;
+
+                    auto i = active.find(msg->easy_handle);
+                    if (i == active.end())
+                        continue;
+
+                    // msg is invalid once its handle is removed
+                    auto result = msg->data.result;
+                    auto t = std::move(i->second);
+                    active.erase(i);
+                    curl_multi_remove_handle(_multi, t->handle);
+
+                    long status = 0;
+                    if (result == CURLE_OK)
+                        curl_easy_getinfo(t->handle, CURLINFO_RESPONSE_CODE, &status);
+
+                    auto max_attempts = std::max(1u, t->read->io.maxNetworkAttempts);
+
+                    if (curl_should_retry(result, status) && t->attempts < max_attempts && !t->read->canceled())
+                    {
+                        t->notBefore = now + curl_retry_delay(t->attempts + 1);
+                        waiting.emplace_back(std::move(t));
+                    }
+                    else
+                    {
+                        auto elapsed = std::chrono::steady_clock::now() - t->start;
+                        t->read->complete(curl_response(t->read->request.url, result, status, t->so, t->errorBuf, elapsed));
+                    }
+                }
+
+                // drop the transfers nobody wants any more:
+                for (auto i = active.begin(); i != active.end(); )
+                {
+                    if (i->second->read->canceled())
+                    {
+                        curl_multi_remove_handle(_multi, i->first);
+                        i->second->read->complete({});
+                        i = active.erase(i);
+                    }
+                    else ++i;
+                }
+
+                // sleep until there's network activity or a new submission; wake up
+                // regularly anyway to check for cancelation and due retries.
+                curl_multi_poll(_multi, nullptr, 0, 100, nullptr);
+            }
+
+            for (auto& entry : active)
+            {
+                curl_multi_remove_handle(_multi, entry.first);
+            }
+        }
+    };
+
+    void submit(std::shared_ptr<AsyncRead> read)
+    {
+        CurlMultiLoop::instance().submit(read);
+    }
+
+#else
+
+    // httplib only offers blocking requests, so they run on a pool of their
+    // own. The pool's threads wait on sockets instead of the callers' threads.
+    const std::string networkPoolName = "rocky.network";
+
+    void submit(std::shared_ptr<AsyncRead> read)
+    {
+        static auto* pool = []()
+            {
+                auto* pool = jobs::get_pool(networkPoolName);
+                pool->set_concurrency(maxConcurrentReads);
+                return pool;
+            }();
+
+        auto task = [read]()
+            {
+                read->complete(read->canceled() ? IOResult<HTTPResponse>() : http_get(read->request, read->io));
+            };
+
+        jobs::dispatch(task, jobs::context{ read->request.url, pool });
+    }
+#endif
 }
 
 //------------------------------------------------------------------------
@@ -557,9 +875,25 @@ URI::findRotation()
 IOResult<Content>
 URI::read(const IOOptions& io) const
 {
-    // protect against multiple threads trying to read the same URI at the same time
-    util::ScopedGate<std::string> gate(io.uriGate, full());
+    if (!io.uriFlights)
+        return fetch(io);
 
+    // threads reading the same URI at the same time share one fetch
+    bool joined = false;
+    auto result = io.uriFlights->run(full(), [&]() { return fetch(io); }, &joined);
+
+    // the fetch we joined was canceled, but this read wasn't
+    if (joined && result.ioCode == result.RESULT_CANCELED && !io.canceled())
+    {
+        result = fetch(io);
+    }
+
+    return result;
+}
+
+IOResult<Content>
+URI::fetch(const IOOptions& io) const
+{
     if (io.services.contentCache)
     {
         auto cached = io.services.contentCache->get(full());
@@ -596,22 +930,7 @@ URI::read(const IOOptions& io) const
 
     else if (isRemote())
     {
-        HTTPRequest request{ full() };
-
-        for(auto& header : _context.headers)
-        {
-            request.headers.push_back({ header.first, header.second });
-        }
-
-        // resolve a rotation:
-        static int rotator = 0;
-        if (_r0 != std::string::npos && _r1 != std::string::npos)
-        {
-            util::replace_in_place(
-                request.url,
-                request.url.substr(_r0, _r1 - _r0 + 1),
-                request.url.substr(_r0 + 1 + (rotator++ % (_r1 - _r0 - 1)), 1));
-        }
+        auto request = createRequest(full(), _context, _r0, _r1);
 
         // make the actual request:
         auto r = http_get(request, io);
@@ -620,24 +939,13 @@ URI::read(const IOOptions& io) const
             return IOResult<Content>::propagate(r);
         }
 
-        std::string contentType = findHeader(r.value.headers, "Content-Type");
-
-        if (contentType.empty())
-        {
-            auto p = request.url.find_first_of('?');
-            auto url_path = p != std::string::npos ? request.url.substr(0, p) : request.url;
-            contentType = inferContentTypeFromFileExtension(url_path);
-        }
-
-        if (contentType.empty())
+        // don't hand a canceled (empty) response to anyone sharing this fetch
+        if (io.canceled())
         {
-            contentType = inferContentTypeFromData(r.value.data);
+            return canceledRead();
         }
 
-        content = {
-            contentType,
-            r.value.data
-        };
+        content = createContent(request, r.value);
     }
     else
     {
@@ -652,6 +960,57 @@ URI::read(const IOOptions& io) const
     return content;
 }
 
+jobs::future<IOResult<Content>>
+URI::readAsync(const IOOptions& io) const
+{
+    jobs::future<IOResult<Content>> promise;
+
+    // only remote reads are worth handing to the network stage
+    if (!isRemote())
+    {
+        promise.resolve(read(io));
+        return promise;
+    }
+
+    if (io.services.contentCache)
+    {
+        auto cached = io.services.contentCache->get(full());
+        if (cached.status.ok())
+        {
+            IOResult<Content> result(cached.value);
+            result.fromCache = true;
+            promise.resolve(result);
+            return promise;
+        }
+    }
+
+    if (io.canceled())
+    {
+        promise.resolve(canceledRead());
+        return promise;
+    }
+
+    auto read = std::make_shared<AsyncRead>();
+    read->location = full();
+    read->request = createRequest(full(), _context, _r0, _r1);
+    read->io = io;
+    read->promise = promise;
+
+    submit(read);
+
+    return promise;
+}
+
+void
+URI::setMaxConcurrentReads(unsigned value)
+{
+    maxConcurrentReads = std::max(1u, value);
+
+#if !defined(ROCKY_HAS_CURL)
+    jobs::get_pool(networkPoolName)->set_concurrency(maxConcurrentReads);
+#endif
+}
+
 bool
 URI::isRemote() const
 {
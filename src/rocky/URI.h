@@ -111,6 +111,15 @@ namespace ROCKY_NAMESPACE
         //! Reads the URI into a data buffer
         IOResult<Content> read(const IOOptions& io) const;
 
+        //! Starts reading the URI and returns at once. Remote reads run on a
+        //! shared network I/O stage, so the calling thread never waits on a
+        //! socket; the result also lands in the content cache.
+        //! Local files and cached content resolve immediately.
+        jobs::future<IOResult<Content>> readAsync(const IOOptions& io) const;
+
+        //! Maximum number of readAsync() requests in flight at once
+        static void setMaxConcurrentReads(unsigned value);
+
     public:
 
         bool operator < (const URI& rhs) const { 
@@ -139,6 +148,9 @@ namespace ROCKY_NAMESPACE
 
         void set(const std::string& location, const URIContext& context);
         void findRotation();
+
+        //! Reads the URI without coalescing with other reads
+        IOResult<Content> fetch(const IOOptions& io) const;
     };
 
     /**
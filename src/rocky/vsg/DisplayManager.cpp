@@ -220,6 +220,26 @@ DisplayManager::addWindow(vsg::ref_ptr<vsg::WindowTraits> traits)
 
     auto window = vsg::Window::create(traits);
 
+    if (!traits->device)
+    {
+        // Terrain draws indirect with these when available (see TerrainSettings::multiDrawIndirect).
+        // The device doesn't exist yet, so the features still apply.
+        VkPhysicalDeviceFeatures supported;
+        vkGetPhysicalDeviceFeatures(window->getOrCreatePhysicalDevice()->vk(), &supported);
+
+        if (!traits->deviceFeatures)
+        {
+            traits->deviceFeatures = vsg::DeviceFeatures::create();
+        }
+        auto& features = traits->deviceFeatures->get();
+        if (supported.multiDrawIndirect)
+            features.multiDrawIndirect = VK_TRUE;
+        if (supported.drawIndirectFirstInstance)
+            features.drawIndirectFirstInstance = VK_TRUE;
+        if (supported.shaderSampledImageArrayDynamicIndexing)
+            features.shaderSampledImageArrayDynamicIndexing = VK_TRUE;
+    }
+
     addWindow(window);
 
     return window;
@@ -194,13 +194,78 @@ namespace
             }
         }
 
+        // collect the polygon's segments (all rings):
+        std::vector<weemesh::segment_t> segments;
+        Geometry::const_iterator segment_iter(local_geom);
+        while (segment_iter.hasMore())
+        {
+            auto& part = segment_iter.next();
+            for (unsigned i = 0; i < part.points.size(); ++i)
+            {
+                unsigned j = (i == part.points.size() - 1) ? 0 : i + 1;
+                segments.emplace_back(part.points[i], part.points[j]);
+            }
+        }
+
         // start with a weemesh covering the feature extent.
         weemesh::mesh_t m;
+        m.max_verts = INT_MAX;
         int marker = 0;
         double xspan = gnomonic_scale * resolution_degrees * 3.14159 / 180.0;
         double yspan = gnomonic_scale * resolution_degrees * 3.14159 / 180.0;
         int cols = std::max(2, (int)(local_ex.width() / xspan));
         int rows = std::max(2, (int)(local_ex.height() / yspan));
+        double cell_width = local_ex.width() / (double)(cols - 1);
+        double cell_height = local_ex.height() / (double)(rows - 1);
+
+        // Find the grid cells that lie entirely outside the polygon so we can skip them.
+        // First flag the cells that a polygon segment passes through (conservatively,
+        // by the segment's bounding box). Cells that no segment touches are either
+        // entirely inside or entirely outside, so we classify those by their centers,
+        // using an even-odd scanline across each row of cells.
+        std::vector<bool> keep_cell((rows - 1) * (cols - 1), false);
+        auto cell_col = [&](double x) { return std::clamp((int)((x - local_ex.xmin) / cell_width), 0, cols - 2); };
+        auto cell_row = [&](double y) { return std::clamp((int)((y - local_ex.ymin) / cell_height), 0, rows - 2); };
+        for (auto& seg : segments)
+        {
+            int c0 = cell_col(std::min(seg.first.x, seg.second.x)), c1 = cell_col(std::max(seg.first.x, seg.second.x));
+            int r0 = cell_row(std::min(seg.first.y, seg.second.y)), r1 = cell_row(std::max(seg.first.y, seg.second.y));
+            for (int row = r0; row <= r1; ++row)
+                for (int col = c0; col <= c1; ++col)
+                    keep_cell[row * (cols - 1) + col] = true;
+        }
+
+        std::vector<double> crossings;
+        for (int row = 0; row < rows - 1; ++row)
+        {
+            double cy = local_ex.ymin + ((double)row + 0.5) * cell_height;
+
+            crossings.clear();
+            for (auto& seg : segments)
+            {
+                auto& a = seg.first;
+                auto& b = seg.second;
+                if ((a.y <= cy && cy < b.y) || (b.y <= cy && cy < a.y))
+                    crossings.push_back(a.x + (cy - a.y) * (b.x - a.x) / (b.y - a.y));
+            }
+            std::sort(crossings.begin(), crossings.end());
+
+            std::size_t c = 0;
+            for (int col = 0; col < cols - 1; ++col)
+            {
+                double cx = local_ex.xmin + ((double)col + 0.5) * cell_width;
+                while (c < crossings.size() && crossings[c] < cx)
+                    ++c;
+
+                // odd number of crossings to the left means we are inside
+                if (c & 1)
+                    keep_cell[row * (cols - 1) + col] = true;
+            }
+        }
+
+        m.reserve(rows * cols + segments.size() * 2, (rows - 1) * (cols - 1) * 2 + segments.size() * 4);
+        m.set_spatial_index_cell_size(std::max(cell_width, cell_height));
+
         for (int row = 0; row < rows; ++row)
         {
             double v = (double)row / (double)(rows - 1);
@@ -219,6 +284,9 @@ namespace
         {
             for (int col = 0; col < cols - 1; ++col)
             {
+                if (!keep_cell[row * (cols - 1) + col])
+                    continue;
+
                 int k = row * cols + col;
                 m.add_triangle(k, k + 1, k + cols);
                 m.add_triangle(k + 1, k + cols + 1, k + cols);
@@ -226,42 +294,19 @@ namespace
         }
 
         // next, apply the segments of the polygon to slice the mesh into triangles.
-        Geometry::const_iterator segment_iter(local_geom);
-        while (segment_iter.hasMore())
-        {
-            auto& part = segment_iter.next();
-            for (unsigned i = 0; i < part.points.size(); ++i)
-            {
-                unsigned j = (i == part.points.size() - 1) ? 0 : i + 1;
-                m.insert(weemesh::segment_t{ part.points[i], part.points[j] }, marker);
-            }
-        }
+        m.insert(segments.begin(), segments.end(), marker);
 
         // next we need to remove all the exterior triangles.
-        std::unordered_set<weemesh::triangle_t*> insiders;
-        std::unordered_set<weemesh::triangle_t*> outsiders;
-        Geometry::const_iterator remove_iter(local_geom, false);
-        while (remove_iter.hasMore())
+        std::vector<weemesh::UID> outsiders;
+        for (auto& tri : m.triangles)
         {
-            auto& part = remove_iter.next();
-
-            for (auto& tri_iter : m.triangles)
-            {
-                weemesh::triangle_t& tri = tri_iter.second;
-                auto c = (tri.p0 + tri.p1 + tri.p2) * (1.0 / 3.0); // centroid
-                bool inside = part.contains(c.x, c.y);
-                if (inside)
-                    insiders.insert(&tri);
-                else
-                    outsiders.insert(&tri);
-            }
+            auto c = (tri.p0 + tri.p1 + tri.p2) * (1.0 / 3.0); // centroid
+            if (!local_geom.contains(c.x, c.y))
+                outsiders.push_back(tri.uid);
         }
-        for (auto tri : outsiders)
+        for (auto uid : outsiders)
         {
-            if (insiders.count(tri) == 0)
-            {
-                m.remove_triangle(*tri);
-            }
+            m.remove_triangle(uid);
         }
 
         for (auto& v : m.verts)
@@ -291,15 +336,61 @@ namespace
 
         for (auto& tri : m.triangles)
         {
-            temp.verts[0] = m.verts[tri.second.i0];
-            temp.verts[1] = m.verts[tri.second.i1];
-            temp.verts[2] = m.verts[tri.second.i2];
+            temp.verts[0] = m.verts[tri.i0];
+            temp.verts[1] = m.verts[tri.i1];
+            temp.verts[2] = m.verts[tri.i2];
             mesh.add(temp);
         }
     }
+
+    // Compiles a single feature into a Line or a Mesh depending on its geometry type.
+    // The getters are only called if the corresponding geometry is needed.
+    template<class GET_LINE, class GET_MESH>
+    void compile_feature(const Feature& feature, const StyleSheet& styles, const SRS& geom_srs, GET_LINE&& get_line, GET_MESH&& get_mesh)
+    {
+        if (feature.geometry.type == Geometry::Type::LineString ||
+            feature.geometry.type == Geometry::Type::MultiLineString)
+        {
+            compile_feature_to_lines(feature, styles, geom_srs, get_line());
+        }
+        else if (feature.geometry.type == Geometry::Type::Polygon)
+        {
+            compile_polygon_feature_with_weemesh(feature, feature.geometry, styles, geom_srs, get_mesh());
+        }
+        else if (feature.geometry.type == Geometry::Type::MultiPolygon)
+        {
+            auto& mesh = get_mesh();
+            for (auto& part : feature.geometry.parts)
+            {
+                compile_polygon_feature_with_weemesh(feature, part, styles, geom_srs, mesh);
+            }
+        }
+        else
+        {
+            Log()->warn("FeatureView no support for " + Geometry::typeToString(feature.geometry.type));
+        }
+    }
 }
 
 
+struct FeatureView::AsyncState
+{
+    bool canceled() const {
+        return cleared || promise.canceled();
+    }
+
+    std::vector<Feature> features;
+    StyleSheet styles;
+    SRS srs;
+    ProgressCallback progress;
+    jobs::promise<bool> promise;
+    std::atomic_bool cleared = { false };
+    std::size_t chunks_remaining = 0;
+    std::size_t features_merged = 0;
+    std::vector<entt::entity> entities;
+};
+
+
 FeatureView::FeatureView()
 {
     //nop
@@ -323,6 +414,28 @@ FeatureView::clear(entt::registry& registry)
         registry.remove<Line>(_entity);
         registry.remove<Mesh>(_entity);
     }
+
+    // stop any generation in progress and destroy what it already merged.
+    for (auto& state : _async)
+    {
+        state->cleared = true;
+        if (!state->promise.available())
+            state->promise.resolve(false);
+
+        for (auto entity : state->entities)
+        {
+            if (registry.valid(entity))
+                registry.destroy(entity);
+        }
+    }
+    _async.clear();
+
+    for (auto entity : _asyncEntities)
+    {
+        if (registry.valid(entity))
+            registry.destroy(entity);
+    }
+    _asyncEntities.clear();
 }
 
 void
@@ -335,32 +448,17 @@ FeatureView::generate(entt::registry& registry, const SRS& geom_srs, Runtime& ru
 
     for (auto& feature : features)
     {
-        if (feature.geometry.type == Geometry::Type::LineString ||
-            feature.geometry.type == Geometry::Type::MultiLineString)
-        {
-            auto& geom = registry.get_or_emplace<Line>(_entity);
-            compile_feature_to_lines(feature, styles, geom_srs, geom);
-            geom.active_ptr = &active;
-        }
-        else if (feature.geometry.type == Geometry::Type::Polygon)
-        {
-            auto& geom = registry.get_or_emplace<Mesh>(_entity);
-            compile_polygon_feature_with_weemesh(feature, feature.geometry, styles, geom_srs, geom);
-            geom.active_ptr = &active;
-        }
-        else if (feature.geometry.type == Geometry::Type::MultiPolygon)
-        {
-            auto& geom = registry.get_or_emplace<Mesh>(_entity);
-            for (auto& part : feature.geometry.parts)
-            {
-                compile_polygon_feature_with_weemesh(feature, part, styles, geom_srs, geom);
+        compile_feature(feature, styles, geom_srs,
+            [&]() -> Line& {
+                auto& geom = registry.get_or_emplace<Line>(_entity);
                 geom.active_ptr = &active;
-            }
-        }
-        else
-        {
-            Log()->warn("FeatureView no support for " + Geometry::typeToString(feature.geometry.type));
-        }
+                return geom;
+            },
+            [&]() -> Mesh& {
+                auto& geom = registry.get_or_emplace<Mesh>(_entity);
+                geom.active_ptr = &active;
+                return geom;
+            });
     }
 
     next_entity = _entity;
@@ -371,9 +469,165 @@ FeatureView::generate(entt::registry& registry, const SRS& geom_srs, Runtime& ru
     }
 }
 
+jobs::future<bool>
+FeatureView::generateAsync(entt::registry& registry, const SRS& geom_srs, Runtime& runtime,
+    bool keep_features, unsigned features_per_chunk, ProgressCallback progress)
+{
+    // Only the AsyncState holds a reference to the promise besides the caller,
+    // so the jobs see the promise as canceled once the caller abandons the future.
+    jobs::future<bool> result;
+
+    auto state = std::make_shared<AsyncState>();
+    state->styles = styles;
+    state->srs = geom_srs;
+    state->progress = progress;
+    state->promise = result;
+
+    if (keep_features)
+    {
+        state->features = features;
+    }
+    else
+    {
+        state->features = std::move(features);
+        features.clear();
+    }
+
+    // retire finished generations, keeping only their entities, so the
+    // states (features, promise) don't pile up across calls:
+    for (auto i = _async.begin(); i != _async.end(); )
+    {
+        if ((*i)->promise.available())
+        {
+            _asyncEntities.insert(_asyncEntities.end(), (*i)->entities.begin(), (*i)->entities.end());
+            i = _async.erase(i);
+        }
+        else ++i;
+    }
+
+    _async.emplace_back(state);
+
+    const std::size_t total = state->features.size();
+    const std::size_t chunk_size = std::max(features_per_chunk, 1u);
+    state->chunks_remaining = (total + chunk_size - 1) / chunk_size;
+
+    if (state->chunks_remaining == 0)
+    {
+        result.resolve(true);
+        return result;
+    }
+
+    bool* active_flag = &active;
+
+    jobs::context context;
+    context.name = "FeatureView::generateAsync";
+    context.pool = jobs::get_pool("rocky.features");
+
+    for (std::size_t begin = 0; begin < total; begin += chunk_size)
+    {
+        std::size_t end = std::min(begin + chunk_size, total);
+
+        auto compile_chunk = [state, begin, end, &registry, &runtime, active_flag]()
+        {
+            if (state->canceled())
+                return;
+
+            auto line = std::make_shared<Line>();
+            auto mesh = std::make_shared<Mesh>();
+            bool has_line = false, has_mesh = false;
+
+            for (std::size_t i = begin; i < end; ++i)
+            {
+                if (state->canceled())
+                    return;
+
+                compile_feature(state->features[i], state->styles, state->srs,
+                    [&]() -> Line& { has_line = true; return *line; },
+                    [&]() -> Mesh& { has_mesh = true; return *mesh; });
+            }
+
+            // merge into the registry during the update pass:
+            auto merge_chunk = [state, begin, end, line, mesh, has_line, has_mesh, &registry, &runtime, active_flag]()
+            {
+                if (state->canceled())
+                    return;
+
+                if (has_line || has_mesh)
+                {
+                    auto entity = registry.create();
+
+                    if (has_line)
+                    {
+                        auto& geom = registry.emplace<Line>(entity, std::move(*line));
+                        geom.active_ptr = active_flag;
+                    }
+
+                    if (has_mesh)
+                    {
+                        auto& geom = registry.emplace<Mesh>(entity, std::move(*mesh));
+                        geom.active_ptr = active_flag;
+                    }
+
+                    state->entities.emplace_back(entity);
+                }
+
+                state->features_merged += (end - begin);
+
+                if (state->progress)
+                {
+                    state->progress(state->features_merged, state->features.size());
+                }
+
+                if (--state->chunks_remaining == 0)
+                {
+                    state->promise.resolve(true);
+                }
+
+                runtime.requestFrame();
+            };
+
+            runtime.onNextUpdate(merge_chunk);
+        };
+
+        jobs::dispatch(compile_chunk, context);
+    }
+
+    return result;
+}
+
 void
 FeatureView::dirtyStyles(entt::registry& entities)
 {
+    auto restyle = [&](entt::entity entity)
+        {
+            if (styles.line.has_value())
+            {
+                if (auto* line = entities.try_get<Line>(entity))
+                {
+                    line->style = styles.line.value();
+                    line->dirty();
+                }
+            }
+
+            if (styles.mesh.has_value())
+            {
+                if (auto* mesh = entities.try_get<Mesh>(entity))
+                {
+                    mesh->style = styles.mesh.value();
+                    mesh->dirty();
+                }
+            }
+        };
+
+    for (auto& state : _async)
+    {
+        for (auto entity : state->entities)
+            restyle(entity);
+    }
+
+    for (auto entity : _asyncEntities)
+        restyle(entity);
+
     if (_entity == entt::null)
         return;
 
@@ -10,6 +10,9 @@
 #include <rocky/vsg/Line.h>
 #include <rocky/vsg/Mesh.h>
 #include <rocky/vsg/Icon.h>
+#include <rocky/Threading.h>
+#include <atomic>
+#include <memory>
 
 namespace ROCKY_NAMESPACE
 {
@@ -50,6 +53,33 @@ namespace ROCKY_NAMESPACE
             Runtime& runtime,
             bool keep_features = false);
 
+        //! Callback reporting asynchronous generation progress
+        //! (number of features merged, total number of features)
+        using ProgressCallback = std::function<void(std::size_t, std::size_t)>;
+
+        //! Create VSG geometry from the feature list in the background.
+        //! Features are split into chunks that compile in parallel on the
+        //! "rocky.features" job pool; each compiled chunk is then merged into
+        //! the registry (as its own entity) during the runtime's update pass.
+        //! Abandon or cancel the returned future to stop generation.
+        //! This object must remain valid until the future resolves.
+        //! @param registry Entity registry
+        //! @param srs SRS or resulting geometry
+        //! @param runtime Runtime operations interface
+        //! @param keep_features Whether to keep the "features" vector intact;
+        //!   by default it is moved to the background job
+        //! @param features_per_chunk Number of features to compile in each job
+        //! @param progress Optional callback, invoked in the update pass after
+        //!   each chunk merges
+        //! @return Future that resolves to true once all chunks have merged
+        jobs::future<bool> generateAsync(
+            entt::registry& registry,
+            const SRS& srs,
+            Runtime& runtime,
+            bool keep_features = false,
+            unsigned features_per_chunk = 256u,
+            ProgressCallback progress = {});
+
         //! Deletes any geometries previously created by generate()
         void clear(entt::registry& registry);
 
@@ -71,5 +101,9 @@ namespace ROCKY_NAMESPACE
 
     private:
         entt::entity _entity = entt::null;
+
+        struct AsyncState;
+        std::vector<std::shared_ptr<AsyncState>> _async;
+        std::vector<entt::entity> _asyncEntities; // from finished async generations
     };
 }
@@ -392,7 +392,7 @@ InstanceVSG::ctor(int& argc, char** argv)
 
     io().services.contentCache = std::make_shared<ContentCache>(128);
 
-    io().uriGate = std::make_shared<util::Gate<std::string>>();
+    io().uriFlights = std::make_shared<util::SingleFlight<std::string, IOResult<Content>>>();
 }
 
 InstanceVSG::InstanceVSG(const InstanceVSG& rhs) :
@@ -12,7 +12,6 @@
 
 #include <vsg/io/Options.h>
 #include <vsg/utils/ComputeBounds.h>
-#include <vsg/utils/LineSegmentIntersector.h>
 #include <vsg/ui/ApplicationEvent.h>
 #include <vsg/ui/KeyEvent.h>
 #include <vsg/ui/ScrollWheelEvent.h>
@@ -920,6 +919,14 @@ MapManipulator::setViewpoint(const Viewpoint& vp, std::chrono::duration<float> d
                 if ( fabs(_state.setVPAccel ) < 1.0 ) _state.setVPAccel = 0.0;
             }
 
+            // let the terrain start loading tiles for the destination
+            auto mapNode = getMapNode();
+            if (mapNode && mapNode->terrainNode)
+            {
+                vsg::dvec3 up = _worldSRS.isGeocentric() ? vsg::normalize(endWorld) : vsg::dvec3(0, 0, 1);
+                mapNode->terrainNode->setCameraDestination(endWorld + up * range1, duration_seconds);
+            }
+
 #if 0
             // Adjust the duration if necessary.
             if ( _settings->getAutoViewpointDurationEnabled() )
@@ -1111,26 +1118,11 @@ bool
 MapManipulator::intersect(const vsg::dvec3& start, const vsg::dvec3& end, vsg::dvec3& out_intersection) const
 {
     auto mapNode = _mapNode_weakptr.ref_ptr();
-    if (mapNode)
+    if (mapNode && mapNode->terrainNode)
     {
-        vsg::LineSegmentIntersector lsi(start, end);
-
-        mapNode->terrainNode->accept(lsi);
-
-        if (!lsi.intersections.empty())
-        {
-            int closest = 0;
-            for (int i = 1; i < lsi.intersections.size(); ++i)
-            {
-                if (lsi.intersections[i]->ratio < lsi.intersections[closest]->ratio)
-                {
-                    closest = i;
-                }
-            }
-
-            out_intersection = lsi.intersections[closest]->worldIntersection;
-            return true;
-        }
+        // intersect the terrain tiles' proxy meshes directly; much faster than
+        // a general-purpose intersection visitor.
+        return mapNode->terrainNode->intersect(start, end, out_intersection);
     }
     return false;
 }
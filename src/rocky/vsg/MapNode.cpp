@@ -13,6 +13,7 @@
 #include <vsg/io/Options.h>
 #include <vsg/app/RecordTraversal.h>
 #include <vsg/vk/State.h>
+#include <algorithm>
 
 using namespace ROCKY_NAMESPACE;
 using namespace ROCKY_NAMESPACE::util;
@@ -102,6 +103,12 @@ MapNode::terrainSettings()
     return *terrainNode.get();
 }
 
+shared_ptr<TerrainHeightQuery>
+MapNode::terrainHeightQuery() const
+{
+    return terrainNode->heightQuery;
+}
+
 const SRS&
 MapNode::mapSRS() const
 {
@@ -139,13 +146,24 @@ MapNode::update(const vsg::FrameStamp* f)
         }
     }
 
-    // on our first update, open any layers that are marked to automatic opening.
+    // on our first update, start opening any layers that are marked for automatic
+    // opening. They open in the background and the terrain picks up each one
+    // as soon as it's ready, so we don't hold up the first frame.
     if (!_openedLayers)
     {
-        map->openAllLayers(instance.io());
+        _openingLayers = map->openAllLayersAsync(instance.io());
         _openedLayers = true;
     }
 
+    // release the futures of layers that have finished opening.
+    if (!_openingLayers.empty())
+    {
+        auto done = [](const jobs::future<Status>& f) { return f.available(); };
+        _openingLayers.erase(
+            std::remove_if(_openingLayers.begin(), _openingLayers.end(), done),
+            _openingLayers.end());
+    }
+
     return terrainNode->update(f, instance.io());
 }
 
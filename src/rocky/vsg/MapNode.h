@@ -9,6 +9,7 @@
 #include <rocky/vsg/InstanceVSG.h>
 #include <rocky/vsg/TerrainSettings.h>
 #include <rocky/vsg/engine/TerrainNode.h>
+#include <rocky/vsg/engine/TerrainHeightQuery.h>
 #include <rocky/Map.h>
 #include <vsg/nodes/Group.h>
 #include <vsg/app/CompileManager.h>
@@ -59,6 +60,10 @@ namespace ROCKY_NAMESPACE
         //! Immutable access to the terrain settings
         const TerrainSettings& terrainSettings() const;
 
+        //! Service for querying terrain heights from the resident terrain tiles.
+        //! Safe to use from any thread.
+        shared_ptr<TerrainHeightQuery> terrainHeightQuery() const;
+
         //! deserialize from JSON
         Status from_json(const std::string& JSON, const IOOptions& io);
 
@@ -80,5 +85,6 @@ namespace ROCKY_NAMESPACE
         SRS _worldSRS;
         vsg::ref_ptr<vsg::Group> _layerNodes;
         bool _openedLayers = false;
+        std::vector<jobs::future<Status>> _openingLayers;
     };
 }
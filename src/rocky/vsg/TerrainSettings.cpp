@@ -20,8 +20,17 @@ TerrainSettings::from_json(const std::string& JSON)
     get_to(j, "screen_space_error", screenSpaceError);
     get_to(j, "tile_pixel_size", tilePixelSize);
     get_to(j, "skirt_ratio", skirtRatio);
+    get_to(j, "morph_terrain", morphTerrain);
+    get_to(j, "adaptive_mesh_error", adaptiveMeshError);
+    get_to(j, "multi_draw_indirect", multiDrawIndirect);
     get_to(j, "color", color);
     get_to(j, "concurrency", concurrency);
+    get_to(j, "network_concurrency", networkConcurrency);
+    get_to(j, "mipmap_color", mipmapColor);
+    get_to(j, "color_compression", colorCompression);
+    get_to(j, "gpu_memory_budget", gpuMemoryBudget);
+    get_to(j, "cpu_memory_budget", cpuMemoryBudget);
+    get_to(j, "prefetch_time", prefetchTime);
 
     return Status_OK;
 }
@@ -37,7 +46,16 @@ TerrainSettings::to_json() const
     set(j, "screen_space_error", screenSpaceError);
     set(j, "tile_pixel_size", tilePixelSize);
     set(j, "skirt_ratio", skirtRatio);
+    set(j, "morph_terrain", morphTerrain);
+    set(j, "adaptive_mesh_error", adaptiveMeshError);
+    set(j, "multi_draw_indirect", multiDrawIndirect);
     set(j, "color", color);
     set(j, "concurrency", concurrency);
+    set(j, "network_concurrency", networkConcurrency);
+    set(j, "mipmap_color", mipmapColor);
+    set(j, "color_compression", colorCompression);
+    set(j, "gpu_memory_budget", gpuMemoryBudget);
+    set(j, "cpu_memory_budget", cpuMemoryBudget);
+    set(j, "prefetch_time", prefetchTime);
     return j.dump();
 }
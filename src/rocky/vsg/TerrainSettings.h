@@ -51,12 +51,63 @@ namespace ROCKY_NAMESPACE
         //! levels of detail. A value of 0 means no skirt.
         optional<float> skirtRatio = 0.0f;
 
+        //! Whether tiles gradually morph into their parent's shape as they
+        //! approach the range at which they swap LODs. This hides LOD popping
+        //! and keeps the edges between tiles of different LODs watertight,
+        //! so skirts aren't needed.
+        optional<bool> morphTerrain = true;
+
+        //! Maximum height error (in meters) of adaptive tile meshes. Above zero,
+        //! tiles with their own elevation data render a mesh with only as many
+        //! triangles as it takes to follow the terrain within this error, so
+        //! flat areas cost far less than mountains. Requires a tileSize of
+        //! 2^N+1. 0 renders every tile as the full tileSize x tileSize grid.
+        optional<float> adaptiveMeshError = 0.0f;
+
+        //! Whether to draw the terrain with one descriptor set bind and one
+        //! multi-draw-indirect call per shared mesh, instead of a bind and a
+        //! draw per tile. Tile textures live in descriptor arrays and tile
+        //! uniforms in one storage buffer. Falls back to per-tile rendering
+        //! if the GPU can't index that many textures. Takes effect when the
+        //! terrain is built.
+        optional<bool> multiDrawIndirect = false;
+
         //! Color of the untextured globe (where no imagery is displayed)
         optional<Color> color = Color::White;
 
         //! Number of threads dedicated to loading terrain data
         optional<unsigned> concurrency = 4;
 
+        //! Maximum number of network requests in flight at once. Remote tile
+        //! data is fetched on a separate network I/O stage so the loader
+        //! threads only decode and composite; zero reads on the loader threads.
+        optional<unsigned> networkConcurrency = 32;
+
+        //! Whether to build mipmaps for color textures on the loader threads.
+        //! Mipmaps stop distant tiles from aliasing, at the cost of a third
+        //! more texture memory.
+        optional<bool> mipmapColor = false;
+
+        //! Block compression for color textures, applied on the loader threads:
+        //! "none", "bc1" (8:1, 1-bit alpha) or "bc3" (4:1, 8-bit alpha).
+        //! Requires a GPU that supports BC texture compression.
+        optional<std::string> colorCompression = std::string("none");
+
+        //! Memory (in MB) that terrain tiles may occupy on the GPU before the
+        //! pager starts evicting tiles that are out of view. Tiles that leave
+        //! the view stay cached until then, so returning to them is free.
+        //! 0 disables the cache (out-of-view tiles unload right away).
+        optional<unsigned> gpuMemoryBudget = 512u;
+
+        //! Memory (in MB) that terrain tile data may occupy in system memory
+        //! before the pager starts evicting tiles that are out of view.
+        //! 0 disables the cache (out-of-view tiles unload right away).
+        optional<unsigned> cpuMemoryBudget = 1024u;
+
+        //! How far ahead (in seconds) to anticipate camera motion and start
+        //! loading the terrain tiles it will need. 0 disables prefetching.
+        optional<float> prefetchTime = 1.0f;
+
     public: // internal runtime settings, not serialized.
 
         //! TEMPORARY.
@@ -0,0 +1,274 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#include "TiledFeatureView.h"
+#include "engine/Runtime.h"
+#include "engine/Utils.h"
+#include <vsg/app/RecordTraversal.h>
+#include <algorithm>
+
+using namespace ROCKY_NAMESPACE;
+
+#define LC "[TiledFeatureView] "
+
+namespace
+{
+    vsg::dsphere computeBound(const TileKey& key)
+    {
+        auto bs = key.extent().createWorldBoundingSphere(0.0, 0.0);
+        return vsg::dsphere(bs.center.x, bs.center.y, bs.center.z, bs.radius);
+    }
+}
+
+TiledFeatureView::TiledFeatureView(entt::registry& registry, Runtime& runtime) :
+    _registry(registry),
+    _runtime(runtime)
+{
+    //nop
+}
+
+std::size_t
+TiledFeatureView::residentTiles() const
+{
+    std::scoped_lock lock(_mutex);
+    return _tiles.size();
+}
+
+const vsg::dsphere&
+TiledFeatureView::bound(const TileKey& key) const
+{
+    auto i = _bounds.find(key);
+    if (i != _bounds.end())
+        return i->second;
+
+    return _bounds.emplace(key, computeBound(key)).first->second;
+}
+
+void
+TiledFeatureView::accept(vsg::RecordTraversal& rv) const
+{
+    if (!active || !source)
+        return;
+
+    std::vector<std::pair<TileKey, float>> visible;
+    {
+        std::scoped_lock lock(_mutex);
+
+        std::vector<TileKey> rootKeys;
+        Profile::getRootKeys(profile, rootKeys);
+
+        for (auto& key : rootKeys)
+        {
+            traverseKey(key, rv, visible);
+        }
+    }
+
+    visit(visible, rv.getFrameStamp()->frameCount);
+
+    // schedule an update pass to process the requests and expirations:
+    std::scoped_lock lock(_mutex);
+    if (!_updateQueued)
+    {
+        _updateQueued = true;
+
+        vsg::observer_ptr<TiledFeatureView> weak(const_cast<TiledFeatureView*>(this));
+        _runtime.onNextUpdate([weak]()
+            {
+                auto view = weak.ref_ptr();
+                if (view)
+                    view->update();
+            });
+    }
+}
+
+void
+TiledFeatureView::traverseKey(const TileKey& key, vsg::RecordTraversal& rv, std::vector<std::pair<TileKey, float>>& visible) const
+{
+    auto* state = rv.getState();
+
+    if (key.levelOfDetail() < levelOfDetail)
+    {
+        // interior key: only descend if some tile beneath it might be in range.
+        auto& bs = bound(key);
+        if (!state->intersect(bs))
+            return;
+
+        double range = distanceTo(bs.center, state);
+        double target_radius = bs.radius / (double)(1u << (levelOfDetail - key.levelOfDetail()));
+        if (range - bs.radius > rangeFactor * target_radius)
+            return;
+
+        for (unsigned q = 0; q < 4; ++q)
+        {
+            traverseKey(key.createChildKey(q), rv, visible);
+        }
+    }
+    else
+    {
+        // tile key: resident tiles carry their own bound.
+        auto i = _tiles.find(key);
+        auto bs = i != _tiles.end() ? i->second->bound : computeBound(key);
+
+        if (!state->intersect(bs))
+            return;
+
+        float range = distanceTo(bs.center, state);
+        if (range > rangeFactor * bs.radius)
+            return;
+
+        visible.emplace_back(key, range);
+    }
+}
+
+void
+TiledFeatureView::visit(const std::vector<std::pair<TileKey, float>>& keys, std::uint64_t frame) const
+{
+    std::scoped_lock lock(_mutex);
+
+    _frame = std::max(_frame, frame);
+
+    for (auto& [key, range] : keys)
+    {
+        auto i = _tiles.find(key);
+        if (i != _tiles.end())
+        {
+            i->second->lastFrame = _frame;
+            i->second->lastRange = range;
+        }
+        else
+        {
+            _requests.emplace_back(key, range);
+        }
+    }
+}
+
+std::vector<Feature>
+TiledFeatureView::readTile(FeatureSource& source, const TileKey& key, Cancelable& cancelable)
+{
+    std::vector<Feature> result;
+    IOOptions io(cancelable);
+
+    auto iter = source.iterate(key.extent(), io);
+
+    while (iter && iter->hasMore() && !cancelable.canceled())
+    {
+        auto& feature = iter->next();
+
+        // a centroid on a shared tile edge lands in exactly one key:
+        auto owner = TileKey::createTileKeyContainingPoint(
+            feature.extent.centroid(), key.levelOfDetail(), key.profile());
+
+        if (owner == key)
+        {
+            result.emplace_back(feature);
+        }
+    }
+    return result;
+}
+
+void
+TiledFeatureView::update()
+{
+    std::scoped_lock lock(_mutex);
+
+    _updateQueued = false;
+
+    unsigned loading = 0u;
+
+    for (auto i = _tiles.begin(); i != _tiles.end(); )
+    {
+        auto& tile = i->second;
+
+        if (_frame - tile->lastFrame > expirationFrames)
+        {
+            // off-screen or out of range for too long; unload it.
+            // Abandoning the futures cancels any jobs still in flight.
+            tile->reader.abandon();
+            tile->view.clear(_registry);
+            i = _tiles.erase(i);
+            continue;
+        }
+
+        tile->view.active = active;
+
+        // features are ready; start compiling them.
+        if (tile->reader.available())
+        {
+            tile->view.features = tile->reader.value();
+            tile->reader.abandon();
+            tile->view.styles = styles;
+            tile->generator = tile->view.generateAsync(_registry, srs, _runtime);
+        }
+
+        if (tile->reader.working() || tile->generator.working())
+        {
+            ++loading;
+        }
+
+        ++i;
+    }
+
+    // service new requests, closest first:
+    std::sort(_requests.begin(), _requests.end(),
+        [](const auto& lhs, const auto& rhs) { return lhs.second < rhs.second; });
+
+    jobs::context context;
+    context.pool = jobs::get_pool("rocky.features.load");
+
+    for (auto& request : _requests)
+    {
+        if (loading >= maxConcurrentLoads)
+            break;
+
+        auto& key = request.first;
+        if (_tiles.count(key) > 0)
+            continue;
+
+        auto tile = std::make_shared<Tile>();
+        tile->key = key;
+        tile->bound = computeBound(key);
+        tile->lastFrame = _frame;
+        tile->lastRange = request.second;
+        tile->view.active = active;
+
+        auto source_copy = source;
+
+        auto read = [source_copy, key](Cancelable& c)
+        {
+            return readTile(*source_copy, key, c);
+        };
+
+        context.name = "TiledFeatureView " + key.str();
+        std::weak_ptr<Tile> weak_tile = tile;
+        context.priority = [weak_tile]()
+            {
+                auto tile = weak_tile.lock();
+                return tile ? -tile->lastRange.load() : -FLT_MAX;
+            };
+
+        tile->reader = jobs::dispatch(read, context);
+
+        _tiles[key] = tile;
+        ++loading;
+    }
+
+    _requests.clear();
+}
+
+void
+TiledFeatureView::clear()
+{
+    std::scoped_lock lock(_mutex);
+
+    for (auto& i : _tiles)
+    {
+        i.second->reader.abandon();
+        i.second->view.clear(_registry);
+    }
+
+    _tiles.clear();
+    _bounds.clear();
+    _requests.clear();
+}
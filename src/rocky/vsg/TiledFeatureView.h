@@ -0,0 +1,117 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#pragma once
+#include <rocky/vsg/FeatureView.h>
+#include <rocky/Profile.h>
+#include <rocky/TileKey.h>
+#include <vsg/nodes/Node.h>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <cfloat>
+
+namespace ROCKY_NAMESPACE
+{
+    /**
+    * TiledFeatureView pages features from a FeatureSource into the scene
+    * one tile at a time, so that large datasets only keep the geometry near
+    * the camera resident.
+    *
+    * Features are indexed on a quadtree of TileKeys at a single level of detail.
+    * During the record traversal this node finds the tiles that are visible and
+    * within range of the camera; each such tile reads its features with a spatial
+    * query and compiles them in the background (via FeatureView::generateAsync).
+    * Tiles that fall out of view expire after a few frames and their geometry
+    * is removed from the registry.
+    *
+    * Place this node in the scene graph so it receives record traversals.
+    */
+    class ROCKY_EXPORT TiledFeatureView : public vsg::Inherit<vsg::Node, TiledFeatureView>
+    {
+    public:
+        //! Construct a tiled view
+        //! @param registry Entity registry that will hold the compiled geometry
+        //! @param runtime Runtime operations interface
+        TiledFeatureView(entt::registry& registry, Runtime& runtime);
+
+        //! Source of the features to display
+        shared_ptr<FeatureSource> source;
+
+        //! Styles to use when compiling features
+        StyleSheet styles;
+
+        //! SRS of the resulting geometry (usually the map's world SRS)
+        SRS srs;
+
+        //! Tiling profile used to index the features
+        Profile profile = Profile::GLOBAL_GEODETIC;
+
+        //! Level of detail at which to tile the features
+        unsigned levelOfDetail = 8u;
+
+        //! A tile is requested when the camera is within this many times
+        //! its bounding radius
+        float rangeFactor = 6.0f;
+
+        //! Number of frames a tile can go without a visit before it is unloaded
+        unsigned expirationFrames = 60u;
+
+        //! Maximum number of tiles that can be loading at once
+        unsigned maxConcurrentLoads = 4u;
+
+        //! Whether to render the view
+        bool active = true;
+
+        //! Number of tiles currently resident
+        std::size_t residentTiles() const;
+
+        //! Removes all tiles and their geometry from the registry.
+        //! Call from the update thread.
+        void clear();
+
+    public: // vsg::Node
+
+        void accept(vsg::RecordTraversal&) const override;
+
+    protected:
+
+        //! Runs once per frame during the update pass
+        void update();
+
+        //! Marks tile keys (with their camera ranges) as visited in a frame,
+        //! requesting any that aren't resident yet
+        void visit(const std::vector<std::pair<TileKey, float>>& keys, std::uint64_t frame) const;
+
+        //! Reads the features belonging to a tile key. Each feature belongs to
+        //! exactly one tile, the one containing its centroid, so features that
+        //! span tile edges aren't duplicated.
+        static std::vector<Feature> readTile(FeatureSource& source, const TileKey& key, Cancelable& cancelable);
+
+    private:
+        struct Tile
+        {
+            TileKey key;
+            vsg::dsphere bound;
+            FeatureView view;
+            jobs::future<std::vector<Feature>> reader;
+            jobs::future<bool> generator;
+            std::uint64_t lastFrame = 0;
+            std::atomic<float> lastRange = { FLT_MAX };
+        };
+
+        entt::registry& _registry;
+        Runtime& _runtime;
+        mutable std::mutex _mutex;
+        mutable std::unordered_map<TileKey, std::shared_ptr<Tile>> _tiles;
+        mutable std::unordered_map<TileKey, vsg::dsphere> _bounds; // interior keys only
+        mutable std::vector<std::pair<TileKey, float>> _requests;
+        mutable std::uint64_t _frame = 0;
+        mutable bool _updateQueued = false;
+
+        void traverseKey(const TileKey& key, vsg::RecordTraversal&, std::vector<std::pair<TileKey, float>>& visible) const;
+        const vsg::dsphere& bound(const TileKey& key) const;
+    };
+}
@@ -0,0 +1,97 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#include "CameraPredictor.h"
+
+using namespace ROCKY_NAMESPACE;
+
+namespace
+{
+    // weight of the newest velocity measurement; smooths out frame jitter
+    constexpr double velocitySmoothing = 0.3;
+
+    // forget the velocity if the camera wasn't seen for this long (e.g. while
+    // rendering on demand), since it no longer describes the motion
+    constexpr double maxSampleGap = 0.5;
+
+    // predictions closer than this to the current eye aren't worth acting on
+    constexpr double minDisplacement = 1.0;
+
+    inline double seconds(vsg::time_point later, vsg::time_point earlier)
+    {
+        return std::chrono::duration<double>(later - earlier).count();
+    }
+}
+
+void
+CameraPredictor::sample(const vsg::dvec3& eye, std::uint64_t frame, vsg::time_point time)
+{
+    std::scoped_lock lock(_mutex);
+    if (frame != _sampleFrame)
+    {
+        _sample = eye;
+        _sampleTime = time;
+        _sampleFrame = frame;
+        _hasSample = true;
+    }
+}
+
+void
+CameraPredictor::setDestination(const vsg::dvec3& eye, vsg::time_point arrival)
+{
+    std::scoped_lock lock(_mutex);
+    _destination = eye;
+    _arrival = arrival;
+    _hasDestination = true;
+}
+
+void
+CameraPredictor::update(vsg::time_point now, float lookahead)
+{
+    std::scoped_lock lock(_mutex);
+
+    _hasPrediction = false;
+
+    if (!_hasSample || lookahead <= 0.0f)
+        return;
+
+    // fold the newest sample into the velocity estimate
+    if (_sampleFrame != _eyeFrame)
+    {
+        if (_hasEye)
+        {
+            double dt = seconds(_sampleTime, _eyeTime);
+            if (dt > maxSampleGap)
+            {
+                _velocity = vsg::dvec3(0, 0, 0);
+            }
+            else if (dt > 0.0)
+            {
+                auto v = (_sample - _eye) / dt;
+                _velocity = _velocity * (1.0 - velocitySmoothing) + v * velocitySmoothing;
+            }
+        }
+
+        _eye = _sample;
+        _eyeTime = _sampleTime;
+        _eyeFrame = _sampleFrame;
+        _hasEye = true;
+    }
+
+    if (_hasDestination && now < _arrival)
+    {
+        // head for the destination, as far as the lookahead reaches
+        double remaining = seconds(_arrival, now);
+        double t = remaining > lookahead ? (double)lookahead / remaining : 1.0;
+        _predicted = _eye + (_destination - _eye) * t;
+    }
+    else
+    {
+        _hasDestination = false;
+        _predicted = _eye + _velocity * (double)lookahead;
+    }
+
+    _hasPrediction = vsg::length(_predicted - _eye) > minDisplacement;
+}
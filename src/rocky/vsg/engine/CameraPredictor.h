@@ -0,0 +1,73 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#pragma once
+
+#include <rocky/vsg/Common.h>
+#include <vsg/maths/vec3.h>
+#include <vsg/ui/UIEvent.h> // time_point
+#include <mutex>
+
+namespace ROCKY_NAMESPACE
+{
+    /**
+     * Predicts where the camera will be a short time from now, so the
+     * terrain can start loading tiles before they come into view.
+     *
+     * The prediction extrapolates the eye's recent velocity, or heads for
+     * a known destination (like the end of a viewpoint transition) when
+     * there is one.
+     */
+    class ROCKY_VSG_INTERNAL CameraPredictor
+    {
+    public:
+        //! Record the eye position (world coordinates) seen during record.
+        //! Only the first sample of each frame counts. Thread safe.
+        void sample(const vsg::dvec3& eye, std::uint64_t frame, vsg::time_point time);
+
+        //! Tell the predictor the camera will arrive at an eye position
+        //! (world coordinates) at the given time. Thread safe.
+        void setDestination(const vsg::dvec3& eye, vsg::time_point arrival);
+
+        //! Recompute the prediction. Call once per frame during update.
+        //! @param now Current frame time
+        //! @param lookahead Seconds into the future to predict
+        void update(vsg::time_point now, float lookahead);
+
+        //! Predicted eye position (world coordinates).
+        //! Read during record; only update() changes it.
+        //! @return false if there's no prediction (e.g., the camera is still)
+        bool predict(vsg::dvec3& out) const
+        {
+            if (_hasPrediction)
+                out = _predicted;
+            return _hasPrediction;
+        }
+
+    private:
+        std::mutex _mutex;
+
+        // latest sample (written during record)
+        vsg::dvec3 _sample;
+        vsg::time_point _sampleTime;
+        std::uint64_t _sampleFrame = ~0ull;
+        bool _hasSample = false;
+
+        // known destination
+        vsg::dvec3 _destination;
+        vsg::time_point _arrival;
+        bool _hasDestination = false;
+
+        // motion state (update only)
+        vsg::dvec3 _eye;
+        vsg::time_point _eyeTime;
+        std::uint64_t _eyeFrame = ~0ull;
+        vsg::dvec3 _velocity;
+        bool _hasEye = false;
+
+        vsg::dvec3 _predicted;
+        bool _hasPrediction = false;
+    };
+}
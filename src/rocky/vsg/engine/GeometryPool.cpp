@@ -5,7 +5,9 @@
  */
 #include "GeometryPool.h"
 #include <rocky/vsg/TerrainSettings.h>
+#include <rocky/Heightfield.h>
 #include <vsg/commands/DrawIndexed.h>
+#include <cstring>
 
 #undef LC
 #define LC "[GeometryPool] "
@@ -35,7 +37,7 @@ GeometryPool::getPooledGeometry(const TileKey& tileKey, const Settings& settings
 
     // convert to a unique-geometry key:
     GeometryKey geomKey;
-    createKeyForTileKey(tileKey, settings.tileSize, geomKey);
+    createKeyForTileKey(tileKey, settings, geomKey);
 
     // make our globally shared EBO if we need it
     {
@@ -50,12 +52,7 @@ GeometryPool::getPooledGeometry(const TileKey& tileKey, const Settings& settings
 
     if ( _enabled )
     {
-        // Protect access on a per key basis to prevent the same key from being created twice.  
-        // This was causing crashes with multiple windows opening and closing.
-        util::ScopedGate<GeometryKey> gatelock(_keygate, geomKey);
-
         // first check the sharing cache:
-        //if (!meshEditor.hasEdits())
         {
             std::scoped_lock lock(_mutex);
             auto i = _sharedGeometries.find(geomKey);
@@ -68,17 +65,40 @@ GeometryPool::getPooledGeometry(const TileKey& tileKey, const Settings& settings
 
         if (!out.valid())
         {
-            out = createGeometry(
-                tileKey,
-                settings,
-                //meshEditor,
-                progress);
-
-            // only store as a shared geometry if there are no constraints.
-            if (out.valid()) //&& !meshEditor.hasEdits())
+            // Threads that need the same key at the same time share one
+            // geometry, so it's never created twice.
+            auto create = [&]() -> vsg::ref_ptr<SharedGeometry>
+                {
+                    // another thread may have just finished it
+                    {
+                        std::scoped_lock lock(_mutex);
+                        auto i = _sharedGeometries.find(geomKey);
+                        if (i != _sharedGeometries.end())
+                            return i->second;
+                    }
+
+                    auto geom = createGeometry(
+                        tileKey,
+                        settings,
+                        //meshEditor,
+                        progress);
+
+                    // only store as a shared geometry if there are no constraints.
+                    if (geom.valid()) //&& !meshEditor.hasEdits())
+                    {
+                        std::scoped_lock lock(_mutex);
+                        _sharedGeometries.emplace(geomKey, geom);
+                    }
+                    return geom;
+                };
+
+            bool joined = false;
+            out = _keyFlights.run(geomKey, create, &joined);
+
+            // the creation we joined was canceled, but this one wasn't
+            if (!out.valid() && joined && !(progress && progress->canceled()))
             {
-                std::scoped_lock lock(_mutex);
-                _sharedGeometries.emplace(geomKey, out);
+                out = create();
             }
         }
     }
@@ -98,12 +118,13 @@ GeometryPool::getPooledGeometry(const TileKey& tileKey, const Settings& settings
 void
 GeometryPool::createKeyForTileKey(
     const TileKey& tileKey,
-    unsigned tileSize,
+    const Settings& settings,
     GeometryKey& out) const
 {
     out.lod  = tileKey.levelOfDetail();
     out.tileY = tileKey.profile().srs().isGeodetic()? tileKey.tileY() : 0;
-    out.size = tileSize;
+    out.size = settings.tileSize;
+    out.morph = settings.morphing;
 }
 
 int
@@ -115,12 +136,15 @@ GeometryPool::getNumSkirtElements(
 
 namespace
 {
-    int getMorphNeighborIndexOffset(unsigned col, unsigned row, int rowSize)
+    // Morph marker for the vertex at (col, row). Vertices in even columns and
+    // rows also exist in the parent tile; the others lie on the midpoint of a
+    // parent edge: horizontal (odd column), vertical (odd row), or the diagonal
+    // that createIndices() splits each quad along (odd column and row).
+    int getMorphMarker(unsigned col, unsigned row)
     {
-        if ( (col & 0x1)==1 && (row & 0x1)==1 ) return rowSize+2;
-        if ( (row & 0x1)==1 )                   return rowSize+1;
-        if ( (col & 0x1)==1 )                   return 2;
-        return 1;
+        return
+            ((col & 0x1) ? VERTEX_MORPH_U : 0) |
+            ((row & 0x1) ? VERTEX_MORPH_V : 0);
     }
 }
 
@@ -281,7 +305,8 @@ GeometryPool::createGeometry(const TileKey& tileKey, const Settings& settings, C
     vsg::ref_ptr<vsg::vec3Array> neighbors;
     vsg::ref_ptr<vsg::vec3Array> neighborNormals;
 
-    if (settings.morphing == true)
+    // morphing requires an odd tile size so that every other vertex also exists in the parent
+    if (settings.morphing == true && (tileSize & 0x1) == 1)
     {
         neighbors = vsg::vec3Array::create(numVerts);
         neighborNormals = vsg::vec3Array::create(numVerts);
@@ -313,25 +338,39 @@ GeometryPool::createGeometry(const TileKey& tileKey, const Settings& settings, C
                 expandSphereToInclude(tileBound, vsg::dvec3(local.x, local.y, local.z));
 
                 // Use the Z coord as a type marker
-                float marker = VERTEX_VISIBLE;
-                uvs->set(i, vsg::vec3(nx, ny, marker));
+                int marker = VERTEX_VISIBLE;
+                if (neighbors)
+                    marker |= getMorphMarker(col, row);
+                uvs->set(i, vsg::vec3(nx, ny, (float)marker));
 
                 unit.z = 1.0;
                 world_plus_one = locator.unitToWorld(unit);
                 normal = glm::normalize((world2local*world_plus_one) - local);
                 normals->set(i, vsg::vec3(normal.x, normal.y, normal.z));
+            }
+        }
 
-                // neighbor:
-                if (neighbors)
+        // Morph targets: where each vertex sits on the parent tile's surface,
+        // i.e. the midpoint of the parent edge it splits. The shader blends
+        // toward this (plus the parent's interpolated elevation) as the tile
+        // approaches the range at which it gives way to its parent.
+        if (neighbors)
+        {
+            for (unsigned row = 0; row < tileSize; ++row)
+            {
+                for (unsigned col = 0; col < tileSize; ++col)
                 {
-                    auto& modelNeighborLTP = (*verts)[verts->size() - getMorphNeighborIndexOffset(col, row, tileSize)];
-                    neighbors->set(i, modelNeighborLTP);
-                }
+                    unsigned i = row * tileSize + col;
+                    int marker = getMorphMarker(col, row);
+                    unsigned a = i, b = i;
 
-                if (neighborNormals)
-                {
-                    auto& modelNeighborNormalLTP = (*normals)[normals->size() - getMorphNeighborIndexOffset(col, row, tileSize)];
-                    neighborNormals->set(i, modelNeighborNormalLTP);
+                    if (marker & VERTEX_MORPH_U)
+                        a -= 1, b += 1;
+                    if (marker & VERTEX_MORPH_V)
+                        a -= tileSize, b += tileSize;
+
+                    neighbors->set(i, ((*verts)[a] + (*verts)[b]) * 0.5f);
+                    neighborNormals->set(i, vsg::normalize((*normals)[a] + (*normals)[b]));
                 }
             }
         }
@@ -364,8 +403,10 @@ GeometryPool::createGeometry(const TileKey& tileKey, const Settings& settings, C
         // the geometry:
         auto geom = SharedGeometry::create();
 
-        geom->assignArrays(vsg::DataList{
-            verts, normals, uvs, neighbors, neighborNormals });
+        if (neighbors)
+            geom->assignArrays(vsg::DataList{ verts, normals, uvs, neighbors, neighborNormals });
+        else
+            geom->assignArrays(vsg::DataList{ verts, normals, uvs });
 
         geom->assignIndices(indices);
 
@@ -382,16 +423,216 @@ GeometryPool::createGeometry(const TileKey& tileKey, const Settings& settings, C
         geom->proxy_normals = normals;
         geom->proxy_uvs = uvs;
         geom->proxy_indices = indices;
+        geom->proxy_tileSize = tileSize;
 
         return geom;
     }
 }
 
+namespace
+{
+    struct Triangle
+    {
+        int ax, ay, bx, by, cx, cy;
+    };
+
+    // FNV-1a over an index array
+    std::size_t hashIndices(const vsg::ushortArray& indices)
+    {
+        std::uint64_t h = 14695981039346656037ull;
+        for (auto i : indices)
+        {
+            h ^= i;
+            h *= 1099511628211ull;
+        }
+        return (std::size_t)h;
+    }
+}
+
+vsg::ref_ptr<SharedGeometry>
+GeometryPool::createAdaptiveGeometry(
+    const TileKey& tileKey,
+    const Settings& settings,
+    const Heightfield& heightfield,
+    const glm::dmat4& elevationMatrix,
+    float maxError,
+    Cancelable* progress)
+{
+    // The RTIN needs 2^N+1 verts per side.
+    // Approach: https://github.com/mapbox/martini
+    const int size = (int)settings.tileSize;
+    const int max = size - 1;
+    if (size < 3 || (max & (max - 1)) != 0)
+        return {};
+
+    auto pooled = getPooledGeometry(tileKey, settings, progress);
+    if (!pooled || !pooled->proxy_uvs || !pooled->proxy_indices)
+        return {};
+
+    // height at each grid vertex, sampled as the vertex shader will see it
+    double
+        scaleU = elevationMatrix[0][0],
+        scaleV = elevationMatrix[1][1],
+        biasU = elevationMatrix[3][0],
+        biasV = elevationMatrix[3][1];
+
+    auto& uvs = *pooled->proxy_uvs;
+    std::vector<float> heights(size * size);
+    for (int i = 0; i < size * size; ++i)
+    {
+        float h = heightfield.heightAtUV(
+            clamp(uvs[i].x * scaleU + biasU, 0.0, 1.0),
+            clamp(uvs[i].y * scaleV + biasV, 0.0, 1.0));
+        heights[i] = h != NO_DATA_VALUE ? h : 0.0f;
+    }
+
+    if (progress && progress->canceled())
+        return {};
+
+    // Every triangle the RTIN can contain, as the (a, b) ends of its long edge,
+    // indexed in an implicit binary tree. The two roots split the grid along the
+    // same diagonal createIndices() uses.
+    const int numTriangles = max * max * 2 - 2;
+    const int numParentTriangles = numTriangles - max * max;
+    std::vector<Triangle> triangles(numTriangles);
+    for (int i = 0; i < numTriangles; ++i)
+    {
+        int id = i + 2;
+        Triangle t{ 0, 0, 0, 0, 0, 0 };
+        if (id & 1)
+            t.bx = t.by = t.cx = max;
+        else
+            t.ax = t.ay = t.cy = max;
+
+        while ((id >>= 1) > 1)
+        {
+            int mx = (t.ax + t.bx) >> 1, my = (t.ay + t.by) >> 1;
+            if (id & 1)
+                t.bx = t.ax, t.by = t.ay, t.ax = t.cx, t.ay = t.cy;
+            else
+                t.ax = t.bx, t.ay = t.by, t.bx = t.cx, t.by = t.cy;
+            t.cx = mx, t.cy = my;
+        }
+        triangles[i] = t;
+    }
+
+    // Error of leaving out each vertex, accumulated up the tree from the smallest
+    // triangles so that a split always brings in the splits it depends on.
+    // Edge vertices are never left out, so tiles line up with any neighbor.
+    std::vector<float> errors(size * size, 0.0f);
+    for (int k = 0; k < size; ++k)
+    {
+        errors[k] = errors[max * size + k] = FLT_MAX;
+        errors[k * size] = errors[k * size + max] = FLT_MAX;
+    }
+
+    for (int i = numTriangles - 1; i >= 0; --i)
+    {
+        auto& t = triangles[i];
+        int mx = (t.ax + t.bx) >> 1, my = (t.ay + t.by) >> 1;
+        int cx = mx + my - t.ay, cy = my + t.ax - mx;
+
+        int middle = my * size + mx;
+        float interpolated = 0.5f * (heights[t.ay * size + t.ax] + heights[t.by * size + t.bx]);
+        errors[middle] = std::max(errors[middle], std::abs(interpolated - heights[middle]));
+
+        if (i < numParentTriangles)
+        {
+            int left = ((t.ay + cy) >> 1) * size + ((t.ax + cx) >> 1);
+            int right = ((t.by + cy) >> 1) * size + ((t.bx + cx) >> 1);
+            errors[middle] = std::max({ errors[middle], errors[left], errors[right] });
+        }
+    }
+
+    // Walk the tree, splitting wherever the error is too large:
+    std::vector<unsigned short> surface;
+    surface.reserve(max * max * 6);
+
+    std::vector<Triangle> stack{ { 0, 0, max, max, max, 0 }, { max, max, 0, 0, 0, max } };
+    while (!stack.empty())
+    {
+        auto t = stack.back();
+        stack.pop_back();
+
+        int mx = (t.ax + t.bx) >> 1, my = (t.ay + t.by) >> 1;
+        if (std::abs(t.ax - t.cx) + std::abs(t.ay - t.cy) > 1 && errors[my * size + mx] > maxError)
+        {
+            stack.push_back({ t.cx, t.cy, t.ax, t.ay, mx, my });
+            stack.push_back({ t.bx, t.by, t.cx, t.cy, mx, my });
+        }
+        else
+        {
+            // same winding as createIndices()
+            if ((t.bx - t.ax) * (t.cy - t.ay) - (t.cx - t.ax) * (t.by - t.ay) < 0)
+                std::swap(t.bx, t.cx), std::swap(t.by, t.cy);
+
+            surface.push_back((unsigned short)(t.ay * size + t.ax));
+            surface.push_back((unsigned short)(t.by * size + t.bx));
+            surface.push_back((unsigned short)(t.cy * size + t.cx));
+        }
+    }
+
+    // skirt elements, if any, come last in the pooled indices and still apply
+    auto& pooledIndices = *pooled->proxy_indices;
+    unsigned numSkirtElements = getNumSkirtElements(settings);
+
+    auto indices = vsg::ushortArray::create(surface.size() + numSkirtElements);
+    std::copy(surface.begin(), surface.end(), indices->begin());
+    std::copy(pooledIndices.end() - numSkirtElements, pooledIndices.end(), indices->begin() + surface.size());
+
+    auto indexBuffer = shareIndices(indices);
+
+    auto geom = SharedGeometry::create();
+    geom->arrays = pooled->arrays; // share the vertex buffers
+    geom->indices = indexBuffer;
+
+    geom->commands.push_back(
+        vsg::DrawIndexed::create(
+            indexBuffer->data->valueCount(), // index count
+            1,               // instance count
+            0,               // first index
+            0,               // vertex offset
+            0));             // first instance
+
+    geom->adaptive = true;
+    geom->proxy_verts = pooled->proxy_verts;
+    geom->proxy_normals = pooled->proxy_normals;
+    geom->proxy_uvs = pooled->proxy_uvs;
+    geom->proxy_indices = indexBuffer->data.cast<vsg::ushortArray>();
+    geom->proxy_tileSize = pooled->proxy_tileSize;
+
+    return geom;
+}
+
+vsg::ref_ptr<vsg::BufferInfo>
+GeometryPool::shareIndices(vsg::ref_ptr<vsg::ushortArray> indices)
+{
+    auto hash = hashIndices(*indices);
+
+    std::scoped_lock lock(_mutex);
+
+    auto range = _sharedIndices.equal_range(hash);
+    for (auto i = range.first; i != range.second; ++i)
+    {
+        auto& data = static_cast<const vsg::ushortArray&>(*i->second->data);
+        if (data.size() == indices->size() &&
+            std::memcmp(data.dataPointer(), indices->dataPointer(), indices->dataSize()) == 0)
+        {
+            return i->second;
+        }
+    }
+
+    auto bufferInfo = vsg::BufferInfo::create(indices);
+    _sharedIndices.emplace(hash, bufferInfo);
+    return bufferInfo;
+}
+
 void
 GeometryPool::clear()
 {
     std::scoped_lock lock(_mutex);
     _sharedGeometries.clear();
+    _sharedIndices.clear();
 }
 
 void
@@ -408,4 +649,14 @@ GeometryPool::sweep(Runtime& runtime)
 
     }
     _sharedGeometries.swap(temp);
+
+    for (auto i = _sharedIndices.begin(); i != _sharedIndices.end(); )
+    {
+        if (i->second->referenceCount() == 1)
+        {
+            runtime.dispose(i->second);
+            i = _sharedIndices.erase(i);
+        }
+        else ++i;
+    }
 }
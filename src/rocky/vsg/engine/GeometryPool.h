@@ -12,15 +12,19 @@
 #include <rocky/vsg/engine/Runtime.h>
 #include <vsg/nodes/Geometry.h>
 #include <vsg/nodes/Group.h>
+#include <vsg/state/BufferInfo.h>
 
 #define VERTEX_VISIBLE       1 // draw it
 #define VERTEX_BOUNDARY      2 // vertex lies on a skirt boundary
 #define VERTEX_HAS_ELEVATION 4 // not subject to elevation texture
 #define VERTEX_SKIRT         8 // it's a skirt vertex (bitmask)
 #define VERTEX_CONSTRAINT   16 // part of a non-morphable constraint
+#define VERTEX_MORPH_U      32 // morphs toward the midpoint of its u-neighbors
+#define VERTEX_MORPH_V      64 // morphs toward the midpoint of its v-neighbors
 
 namespace ROCKY_NAMESPACE
 {
+    class Heightfield;
     class Map;
     class MeshEditor;
     class TerrainSettings;
@@ -36,6 +40,8 @@ namespace ROCKY_NAMESPACE
         }
 
         bool hasConstraints;
+        bool adaptive = false; // triangles decimated to fit one tile's heightfield
+        unsigned proxy_tileSize = 0u; // verts are a tileSize x tileSize grid, then skirts
         vsg::ref_ptr<vsg::vec3Array> proxy_verts;
         vsg::ref_ptr<vsg::vec3Array> proxy_normals;
         vsg::ref_ptr<vsg::vec3Array> proxy_uvs;
@@ -49,6 +55,7 @@ namespace ROCKY_NAMESPACE
             lod(-1),
             tileY(0),
             patch(false),
+            morph(false),
             size(0u)
         {
             //nop
@@ -58,6 +65,7 @@ namespace ROCKY_NAMESPACE
             lod(rhs.lod),
             tileY(rhs.tileY),
             patch(rhs.patch),
+            morph(rhs.morph),
             size(rhs.size)
         {
             //nop
@@ -72,6 +80,8 @@ namespace ROCKY_NAMESPACE
             if (size < rhs.size) return true;
             if (size > rhs.size) return false;
             if (patch == false && rhs.patch == true) return true;
+            if (patch == true && rhs.patch == false) return false;
+            if (morph == false && rhs.morph == true) return true;
             return false;
         }
 
@@ -81,7 +91,8 @@ namespace ROCKY_NAMESPACE
                 lod == rhs.lod &&
                 tileY == rhs.tileY &&
                 size == rhs.size &&
-                patch == rhs.patch;
+                patch == rhs.patch &&
+                morph == rhs.morph;
         }
 
         bool operator != (const GeometryKey& rhs) const
@@ -90,12 +101,14 @@ namespace ROCKY_NAMESPACE
                 lod != rhs.lod ||
                 tileY != rhs.tileY ||
                 size != rhs.size ||
-                patch != rhs.patch;
+                patch != rhs.patch ||
+                morph != rhs.morph;
         }
 
         int      lod;
         int      tileY;
         bool     patch;
+        bool     morph;
         unsigned size;
     };
 }
@@ -107,7 +120,7 @@ namespace std {
             return rocky::util::hash_value_unsigned(
                 (unsigned)key.lod,
                 (unsigned)key.tileY,
-                key.size, key.patch ? 1u : 0u);
+                key.size, (key.patch ? 1u : 0u) | (key.morph ? 2u : 0u));
         }
     };
 }
@@ -140,6 +153,9 @@ namespace ROCKY_NAMESPACE
         struct Settings {
             uint32_t tileSize = 17u;
             float skirtRatio = 0.0f;
+            //! Whether to generate the morph targets (in_vertex_neighbor and
+            //! in_normal_neighbor) the terrain shader uses to blend each vertex
+            //! into its parent tile's surface.
             bool morphing = false;
         };
 
@@ -150,6 +166,21 @@ namespace ROCKY_NAMESPACE
             const Settings& settings,
             Cancelable* state);
 
+        //! Builds a surface for one tile that has only as many triangles as it
+        //! takes to follow the tile's heightfield within maxError (meters): a
+        //! right-triangulated irregular network over the pooled vertex grid,
+        //! whose vertex buffers it shares. Tile edges keep every vertex so they
+        //! still line up with neighbors. Identical index sets (e.g. all the
+        //! flat tiles) share one index buffer. Safe to call from any thread.
+        //! @return Adaptive geometry, or nullptr if the tile size is not 2^N+1
+        vsg::ref_ptr<SharedGeometry> createAdaptiveGeometry(
+            const TileKey& tileKey,
+            const Settings& settings,
+            const Heightfield& heightfield,
+            const glm::dmat4& elevationMatrix,
+            float maxError,
+            Cancelable* state);
+
         //! The number of elements (incides) in the terrain skirt if applicable
         int getNumSkirtElements(const Settings& settings) const;
 
@@ -165,15 +196,16 @@ namespace ROCKY_NAMESPACE
     private:
 
         SRS _worldSRS;
-        mutable util::Gate<GeometryKey> _keygate;
+        mutable util::SingleFlight<GeometryKey, vsg::ref_ptr<SharedGeometry>> _keyFlights;
         mutable std::mutex _mutex;
         SharedGeometries _sharedGeometries;
+        std::unordered_multimap<std::size_t, vsg::ref_ptr<vsg::BufferInfo>> _sharedIndices;
         vsg::ref_ptr<vsg::ushortArray> _defaultIndices;
         Settings _defaultIndicesSettings;
 
         void createKeyForTileKey(
             const TileKey& tileKey,
-            unsigned size,
+            const Settings& settings,
             GeometryKey& out) const;
 
         vsg::ref_ptr<SharedGeometry> createGeometry(
@@ -185,6 +217,10 @@ namespace ROCKY_NAMESPACE
         vsg::ref_ptr<vsg::ushortArray> createIndices(
             const Settings& settings) const;
 
+        // returns a pooled index buffer with the same contents, or a new one
+        vsg::ref_ptr<vsg::BufferInfo> shareIndices(
+            vsg::ref_ptr<vsg::ushortArray> indices);
+
         bool _enabled = true;
         bool _debug = false;
     };
@@ -5,6 +5,7 @@
  */
 #include "Runtime.h"
 #include "Utils.h"
+#include <rocky/Tracing.h>
 #include <vsg/app/Viewer.h>
 #include <vsg/text/Font.h>
 #include <vsg/io/read.h>
@@ -160,13 +161,22 @@ Runtime::compile(vsg::ref_ptr<vsg::Object> compilable)
     ROCKY_HARD_ASSERT(viewer.valid(), "Developer: failure to set InstanceVSG->runtime().viewer");
     ROCKY_SOFT_ASSERT_AND_RETURN(compilable.valid(), void());
 
+    // a viewer without windows (headless) has no device to compile for
+    if (!viewer->compileManager)
+        return;
+
     if (asyncCompile)
     {
+        auto t0 = std::chrono::steady_clock::now();
+
         auto cr = viewer->compileManager->compile(compilable);
+
+        util::Trace::span("compile", "rocky.compile", t0, t0, std::chrono::steady_clock::now());
+
         if (cr && cr.requiresViewerUpdate())
         {
             std::scoped_lock lock(_compileMutex);
-            _compileResults.push_back(cr);
+            _compileResults.push_back({ cr, t0 });
         }
     }
     else
@@ -212,7 +222,8 @@ Runtime::update()
             for (auto& cr : _compileResults)
             {
                 // no need to check cr, we did that before pushing
-                vsg::updateViewer(*viewer, cr);
+                util::Trace::Scope trace("merge compile", "rocky.compile", cr.queued);
+                vsg::updateViewer(*viewer, cr.result);
                 updates_occurred = true;
             }
 
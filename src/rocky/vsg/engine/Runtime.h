@@ -101,7 +101,8 @@ namespace ROCKY_NAMESPACE
             std::function<void()> function);
 
         //! Compiles an object now.
-        //! Be careful to only call this from a safe thread
+        //! Be careful to only call this from a safe thread.
+        //! Does nothing when the viewer is headless (has no compile manager).
         void compile(vsg::ref_ptr<vsg::Object> object);
 
         //! Destroys a VSG object, eventually. 
@@ -146,7 +147,11 @@ namespace ROCKY_NAMESPACE
         // containers for compilation and integrating the results
         mutable std::shared_mutex _compileMutex;
         std::queue<vsg::ref_ptr<vsg::Object>> _toCompile;
-        std::vector<vsg::CompileResult> _compileResults;
+        struct CompileResult {
+            vsg::CompileResult result;
+            std::chrono::steady_clock::time_point queued;
+        };
+        std::vector<CompileResult> _compileResults;
 
         // deferred deletion container
         mutable std::shared_mutex _deferred_unref_mutex;
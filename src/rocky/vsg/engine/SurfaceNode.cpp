@@ -22,6 +22,51 @@ using namespace ROCKY_NAMESPACE;
 // uncomment to draw each tile's tight bounding box
 //#define RENDER_TILE_BBOX
 
+// number of grid cells (per side) in each intersection block
+#define PROXY_BLOCK_SIZE 4u
+
+namespace
+{
+    // slab test: does the segment (origin + t*dir, t in [t0, t1]) pass through the box?
+    template<class BOX>
+    inline bool segmentHitsBox(const vsg::dvec3& origin, const vsg::dvec3& inv_dir, double t0, double t1, const BOX& b)
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            double a = ((double)b.min[i] - origin[i]) * inv_dir[i];
+            double c = ((double)b.max[i] - origin[i]) * inv_dir[i];
+            if (a > c) std::swap(a, c);
+            t0 = std::max(t0, a);
+            t1 = std::min(t1, c);
+            if (t0 > t1)
+                return false;
+        }
+        return true;
+    }
+
+    // Moller-Trumbore; returns the ratio along the segment, or -1 for a miss.
+    inline double segmentHitsTriangle(const vsg::dvec3& origin, const vsg::dvec3& dir,
+        const vsg::vec3& fv0, const vsg::vec3& fv1, const vsg::vec3& fv2)
+    {
+        vsg::dvec3 v0(fv0), v1(fv1), v2(fv2);
+        vsg::dvec3 e1 = v1 - v0, e2 = v2 - v0;
+        vsg::dvec3 p = vsg::cross(dir, e2);
+        double det = vsg::dot(e1, p);
+        if (std::abs(det) < 1e-12)
+            return -1.0;
+        double inv_det = 1.0 / det;
+        vsg::dvec3 s = origin - v0;
+        double u = vsg::dot(s, p) * inv_det;
+        if (u < 0.0 || u > 1.0)
+            return -1.0;
+        vsg::dvec3 q = vsg::cross(s, e1);
+        double v = vsg::dot(dir, q) * inv_det;
+        if (v < 0.0 || u + v > 1.0)
+            return -1.0;
+        return vsg::dot(e2, q) * inv_det;
+    }
+}
+
 //..............................................................
 
 
@@ -36,6 +81,7 @@ SurfaceNode::SurfaceNode(const TileKey& tilekey, const SRS& worldSRS, Runtime& r
     glm::dmat4 local2world = worldSRS.localToWorldMatrix(glm::dvec3(centroid.x, centroid.y, centroid.z));
 
     this->matrix = to_vsg(local2world);
+    _worldToLocal = vsg::inverse(this->matrix);
 }
 
 void
@@ -73,8 +119,9 @@ SurfaceNode::recomputeBound()
     auto verts = geom->proxy_verts;
     auto normals = geom->proxy_normals;
     auto uvs = geom->proxy_uvs;
+    auto indices = geom->proxy_indices;
     
-    ROCKY_SOFT_ASSERT_AND_RETURN(verts && normals && uvs, void());
+    ROCKY_SOFT_ASSERT_AND_RETURN(verts && normals && uvs && indices, void());
 
     if (_proxyMesh.size() < verts->size())
     {
@@ -120,10 +167,48 @@ SurfaceNode::recomputeBound()
         std::copy(verts->begin(), verts->end(), _proxyMesh.begin());
     }
 
-    // build the bbox around the mesh.
-    for (auto& vert : _proxyMesh)
+    // build the bbox around the vertices the mesh actually uses
+    // (an adaptive mesh leaves some of the grid out).
+    std::vector<bool> used(_proxyMesh.size(), false);
+    for (auto i : *indices)
     {
-        localbbox.add(vert);
+        if (i < _proxyMesh.size() && !used[i])
+        {
+            used[i] = true;
+            localbbox.add(_proxyMesh[i]);
+        }
+    }
+
+    // sort the surface triangles (skirts excluded) into blocks of grid cells,
+    // and bound each block, for intersection testing.
+    _proxyTileSize = geom->proxy_tileSize;
+    _proxyIndices = indices;
+    _proxyBlocks.clear();
+    _proxyBlockTriangles.clear();
+    if (_proxyTileSize >= 2 && _proxyMesh.size() >= _proxyTileSize * _proxyTileSize)
+    {
+        const unsigned ts = _proxyTileSize;
+        const unsigned cells = ts - 1;
+        const unsigned blocks = (cells + PROXY_BLOCK_SIZE - 1) / PROXY_BLOCK_SIZE;
+        _proxyBlocks.resize(blocks * blocks);
+        _proxyBlockTriangles.resize(blocks * blocks);
+
+        for (unsigned t = 0; t + 2 < indices->size(); t += 3)
+        {
+            unsigned i0 = indices->at(t), i1 = indices->at(t + 1), i2 = indices->at(t + 2);
+            if (i0 >= ts * ts || i1 >= ts * ts || i2 >= ts * ts)
+                continue;
+
+            // block containing the triangle's centroid
+            unsigned col = ((i0 % ts) + (i1 % ts) + (i2 % ts)) / 3;
+            unsigned row = ((i0 / ts) + (i1 / ts) + (i2 / ts)) / 3;
+            unsigned b = std::min(row / PROXY_BLOCK_SIZE, blocks - 1) * blocks + std::min(col / PROXY_BLOCK_SIZE, blocks - 1);
+
+            _proxyBlocks[b].add(_proxyMesh[i0]);
+            _proxyBlocks[b].add(_proxyMesh[i1]);
+            _proxyBlocks[b].add(_proxyMesh[i2]);
+            _proxyBlockTriangles[b].push_back(t);
+        }
     }
 
     auto& m = this->matrix;
@@ -168,7 +253,9 @@ SurfaceNode::recomputeBound()
     // finally, calculate a horizon culling point for the tile.
     std::vector<glm::dvec3> world_mesh;
     world_mesh.reserve(_proxyMesh.size());
-    for (auto& v : _proxyMesh) {
+    for (unsigned i = 0; i < _proxyMesh.size(); ++i) {
+        if (!used[i]) continue;
+        auto& v = _proxyMesh[i];
         auto world = m * vsg::dvec4(v.x, v.y, v.z, 1.0);
         world_mesh.emplace_back(world.x, world.y, world.z);
     }
@@ -197,3 +284,42 @@ SurfaceNode::recomputeBound()
     }
 #endif
 }
+
+bool
+SurfaceNode::intersect(const vsg::dvec3& world_start, const vsg::dvec3& world_end, double& inout_ratio) const
+{
+    if (_proxyBlocks.empty())
+        return false;
+
+    // work in the tile's local frame; ratios along the segment are unchanged.
+    vsg::dvec3 origin = _worldToLocal * world_start;
+    vsg::dvec3 dir = (_worldToLocal * world_end) - origin;
+    vsg::dvec3 inv_dir(1.0 / dir.x, 1.0 / dir.y, 1.0 / dir.z);
+
+    if (!segmentHitsBox(origin, inv_dir, 0.0, inout_ratio, localbbox))
+        return false;
+
+    // same triangles the tile renders
+    auto& indices = *_proxyIndices;
+    bool hit = false;
+
+    for (unsigned b = 0; b < _proxyBlocks.size(); ++b)
+    {
+        if (_proxyBlockTriangles[b].empty() ||
+            !segmentHitsBox(origin, inv_dir, 0.0, inout_ratio, _proxyBlocks[b]))
+        {
+            continue;
+        }
+
+        for (auto t : _proxyBlockTriangles[b])
+        {
+            double r = segmentHitsTriangle(origin, dir,
+                _proxyMesh[indices[t]], _proxyMesh[indices[t + 1]], _proxyMesh[indices[t + 2]]);
+
+            if (r >= 0.0 && r < inout_ratio)
+                inout_ratio = r, hit = true;
+        }
+    }
+
+    return hit;
+}
@@ -14,6 +14,7 @@
 #include <vsg/nodes/MatrixTransform.h>
 #include <vsg/vk/State.h>
 #include <vsg/maths/vec3.h>
+#include <vsg/maths/box.h>
 
 namespace ROCKY_NAMESPACE
 {
@@ -51,9 +52,32 @@ namespace ROCKY_NAMESPACE
         //! and horizon checks)
         inline bool isVisible(vsg::State* state) const;
 
+        //! World-space visibility check against frustum planes (normals
+        //! pointing inward) and an optional horizon
+        inline bool isVisible(
+            const vsg::dplane* faces,
+            std::size_t numFaces,
+            const Horizon* horizon) const;
+
         //! Force a recompute of the bounding box and culling information
         void recomputeBound();
 
+        //! Flag the bounds for recompute, e.g. after the geometry changes
+        void dirtyBound() {
+            _boundsDirty = true;
+        }
+
+        //! Intersects a world-space line segment with this tile's surface.
+        //! @param start Start of the segment (world coordinates)
+        //! @param end End of the segment (world coordinates)
+        //! @param inout_ratio On input, the closest hit found so far as a ratio
+        //!   along the segment [0..1]; on output, the closer hit if one was found
+        //! @return True if this surface had a hit closer than inout_ratio
+        bool intersect(
+            const vsg::dvec3& start,
+            const vsg::dvec3& end,
+            double& inout_ratio) const;
+
         vsg::dsphere worldBoundingSphere;
         vsg::dbox localbbox;
 
@@ -67,6 +91,11 @@ namespace ROCKY_NAMESPACE
         bool _boundsDirty = true;
         Runtime& _runtime;
         std::vector<vsg::vec3> _proxyMesh;
+        unsigned _proxyTileSize = 0u;
+        vsg::ref_ptr<vsg::ushortArray> _proxyIndices;
+        std::vector<vsg::box> _proxyBlocks; // bounds of each block of grid cells
+        std::vector<std::vector<unsigned>> _proxyBlockTriangles; // first index of each triangle in each block
+        vsg::dmat4 _worldToLocal;
         vsg::dvec3 _horizonCullingPoint;
         bool _horizonCullingPoint_valid = false;
     };
@@ -74,25 +103,33 @@ namespace ROCKY_NAMESPACE
 
     inline bool SurfaceNode::isVisible(vsg::State* state) const
     {
-        // bounding box visibility check; this is much tighter than the bounding
-        // sphere. _frustumStack.top() contains the frustum in world coordinates.
+        // _frustumStack.top() contains the frustum in world coordinates.
         // https://github.com/vsg-dev/VulkanSceneGraph/blob/master/include/vsg/vk/State.h#L267
-        // The first 8 points in _worldPoints are the 8 corners of the bounding box
-        // in world coordinates.
         // Note: POLYTOPE_SIZE is defined in vsg plane.h
         auto& frustum = state->_frustumStack.top();
+
+        shared_ptr<Horizon> horizon;
+        state->getValue("horizon", horizon);
+
+        return isVisible(frustum.face, POLYTOPE_SIZE, horizon.get());
+    }
+
+    inline bool SurfaceNode::isVisible(const vsg::dplane* faces, std::size_t numFaces, const Horizon* horizon) const
+    {
+        // bounding box visibility check; this is much tighter than the bounding
+        // sphere. The first 8 points in _worldPoints are the 8 corners of the
+        // bounding box in world coordinates.
         int p;
-        for (int f = 0; f < POLYTOPE_SIZE; ++f) {
+        for (std::size_t f = 0; f < numFaces; ++f) {
             for (p = 0; p < 8; ++p)
-                if (vsg::distance(frustum.face[f], _worldPoints[p]) > 0.0) // visible?
+                if (vsg::distance(faces[f], _worldPoints[p]) > 0.0) // visible?
                     break;
             if (p == 8)
                 return false;
         }
 
         // still good? check against the horizon.
-        shared_ptr<Horizon> horizon;
-        if (state->getValue("horizon", horizon))
+        if (horizon)
         {
             if (_horizonCullingPoint_valid)
             {
@@ -0,0 +1,186 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#include "TerrainDrawBatch.h"
+#include "TerrainState.h"
+#include "TerrainTileNode.h"
+
+#include <vsg/commands/DrawIndexed.h>
+#include <vsg/nodes/Geometry.h>
+#include <vsg/vk/State.h>
+#include <algorithm>
+
+using namespace ROCKY_NAMESPACE;
+
+TerrainDrawBatch::TerrainDrawBatch(const TerrainState& state) :
+    _instanceBinding(state.instanceBinding),
+    _multiDraw(state.multiDraw)
+{
+    // a view can't see more tiles than the tile table holds
+    const auto capacity = TerrainState::tileTableSize;
+
+    for (auto& view : _views)
+    {
+        // both are written while recording, so VSG must transfer
+        // them to the GPU after recording instead of before.
+        view.instances = vsg::vec4Array::create(capacity);
+        view.instances->properties.dataVariance = vsg::DYNAMIC_DATA_TRANSFER_AFTER_RECORD;
+        view.bindInstances = vsg::BindVertexBuffers::create(_instanceBinding, vsg::DataList{ view.instances });
+
+        view.commands = vsg::ubyteArray::create(capacity * sizeof(VkDrawIndexedIndirectCommand));
+        view.commands->properties.dataVariance = vsg::DYNAMIC_DATA_TRANSFER_AFTER_RECORD;
+        view.drawIndirect = vsg::DrawIndexedIndirect::create(view.commands, 0, sizeof(VkDrawIndexedIndirectCommand));
+
+        // children only so that compiling the batch creates their buffers;
+        // accept() records them itself.
+        addChild(view.bindInstances);
+        addChild(view.drawIndirect);
+    }
+}
+
+bool
+TerrainDrawBatch::add(const TerrainTileNode* tile, vsg::RecordTraversal& rv) const
+{
+    // Always claim the tile, even when it can't draw; recording its own
+    // geometry would use the indirect pipeline without its descriptors.
+    auto& commandBuffer = *rv.getState()->_commandBuffer;
+    if (commandBuffer.viewID >= maxViews)
+        return true;
+
+    auto& tableIndex = tile->renderModel.descriptors.tableIndex;
+    if (!tableIndex)
+        return true;
+
+    auto geometry = tile->getGeometry()->cast<vsg::Geometry>();
+    if (!geometry || geometry->arrays.empty() || !geometry->indices || geometry->commands.empty())
+        return true;
+
+    auto drawIndexed = geometry->commands.front()->cast<vsg::DrawIndexed>();
+    auto& indices = geometry->indices;
+    if (!drawIndexed || !indices->buffer || !geometry->arrays.front()->buffer)
+        return true;
+
+    auto& view = _views[commandBuffer.viewID];
+    if (view.draws.size() >= TerrainState::tileTableSize)
+        return true;
+
+    // the batch binds the whole index buffer, so start the draw at this mesh's indices
+    std::uint32_t indexSize = geometry->indexType == VK_INDEX_TYPE_UINT16 ? 2 : 4;
+    auto& origin = tile->renderModel.origin;
+
+    view.draws.emplace_back(Draw{
+        geometry->arrays.front().get(),
+        geometry,
+        indices->buffer->vk(commandBuffer.deviceID),
+        (std::uint32_t)(indices->offset / indexSize) + drawIndexed->firstIndex,
+        drawIndexed->indexCount,
+        *tableIndex,
+        vsg::dvec3(origin.x, origin.y, origin.z) });
+
+    return true;
+}
+
+void
+TerrainDrawBatch::accept(vsg::RecordTraversal& rv) const
+{
+    auto* state = rv.getState();
+    auto& commandBuffer = *state->_commandBuffer;
+    if (commandBuffer.viewID >= maxViews)
+        return;
+
+    auto& view = _views[commandBuffer.viewID];
+    if (view.draws.empty())
+        return;
+
+    // group the tiles that share vertex and index buffers; each group is one draw call
+    std::sort(view.draws.begin(), view.draws.end(), [](const Draw& lhs, const Draw& rhs)
+        {
+            if (lhs.vertices != rhs.vertices) return lhs.vertices < rhs.vertices;
+            return lhs.indexBuffer < rhs.indexBuffer;
+        });
+
+    // Tile vertices are relative to the tile's origin. Passing each origin
+    // relative to the eye, and drawing in a frame centered on the eye,
+    // keeps the large world coordinates out of single precision.
+    auto modelview = state->modelviewMatrixStack.top();
+    auto eye = vsg::inverse(modelview) * vsg::dvec3(0, 0, 0);
+
+    auto* commands = static_cast<VkDrawIndexedIndirectCommand*>(view.commands->dataPointer());
+
+    for (std::uint32_t i = 0; i < view.draws.size(); ++i)
+    {
+        auto& draw = view.draws[i];
+        auto origin = draw.origin - eye;
+        view.instances->at(i) = vsg::vec4((float)origin.x, (float)origin.y, (float)origin.z, (float)draw.tableIndex);
+
+        // firstInstance selects the instance data for the draw
+        commands[i] = { draw.indexCount, 1, draw.firstIndex, 0, i };
+    }
+
+    view.instances->dirty();
+    view.commands->dirty();
+
+    state->modelviewMatrixStack.push(modelview * vsg::translate(eye));
+    state->dirty = true;
+    state->record();
+
+    VkCommandBuffer vk_commandBuffer = commandBuffer;
+    auto deviceID = commandBuffer.deviceID;
+
+    view.bindInstances->record(commandBuffer);
+
+    auto& indirect = view.drawIndirect->bufferInfo;
+    VkBuffer indirectBuffer = indirect->buffer->vk(deviceID);
+    const std::uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+
+    std::vector<VkBuffer> buffers;
+    std::vector<VkDeviceSize> offsets;
+
+    for (std::size_t first = 0; first < view.draws.size(); )
+    {
+        auto& draw = view.draws[first];
+
+        auto last = first + 1;
+        while (last < view.draws.size() &&
+            view.draws[last].vertices == draw.vertices &&
+            view.draws[last].indexBuffer == draw.indexBuffer)
+        {
+            ++last;
+        }
+
+        buffers.clear();
+        offsets.clear();
+        for (auto& array : draw.geometry->arrays)
+        {
+            buffers.push_back(array->buffer->vk(deviceID));
+            offsets.push_back(array->offset);
+        }
+
+        vkCmdBindVertexBuffers(vk_commandBuffer, 0, (std::uint32_t)buffers.size(), buffers.data(), offsets.data());
+        vkCmdBindIndexBuffer(vk_commandBuffer, draw.indexBuffer, 0, draw.geometry->indexType);
+
+        if (_multiDraw)
+        {
+            vkCmdDrawIndexedIndirect(vk_commandBuffer, indirectBuffer, indirect->offset + first * stride, (std::uint32_t)(last - first), stride);
+        }
+        else
+        {
+            // without the multiDrawIndirect and drawIndirectFirstInstance
+            // features, draw the same commands directly
+            for (auto i = first; i < last; ++i)
+            {
+                auto& c = commands[i];
+                vkCmdDrawIndexed(vk_commandBuffer, c.indexCount, c.instanceCount, c.firstIndex, c.vertexOffset, c.firstInstance);
+            }
+        }
+
+        first = last;
+    }
+
+    state->modelviewMatrixStack.pop();
+    state->dirty = true;
+
+    view.draws.clear();
+}
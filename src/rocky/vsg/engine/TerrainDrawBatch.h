@@ -0,0 +1,74 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#pragma once
+
+#include <rocky/vsg/Common.h>
+#include <vsg/nodes/Group.h>
+#include <vsg/core/Array.h>
+#include <vsg/commands/BindVertexBuffers.h>
+#include <vsg/commands/DrawIndexedIndirect.h>
+#include <vsg/app/RecordTraversal.h>
+#include <array>
+#include <vector>
+
+namespace ROCKY_NAMESPACE
+{
+    class TerrainState;
+    class TerrainTileNode;
+
+    /**
+     * Draws all the visible terrain tiles of a view at once.
+     *
+     * Drawing indirect (see TerrainSettings::multiDrawIndirect), tiles don't
+     * record anything themselves. Instead each visible tile adds itself to the
+     * batch, and the batch (which comes after the tiles in the scene graph)
+     * fills an indirect command buffer and draws them with one
+     * vkCmdDrawIndexedIndirect per shared mesh. Each draw's instance carries
+     * the tile's slot in the tile table (see TerrainState) and its origin
+     * relative to the eye, so vertices stay precise far from the world origin.
+     */
+    class ROCKY_VSG_INTERNAL TerrainDrawBatch : public vsg::Inherit<vsg::Group, TerrainDrawBatch>
+    {
+    public:
+        //! Construct a batch that draws through the state's tile table
+        TerrainDrawBatch(const TerrainState& state);
+
+        //! Adds a visible tile to the current view's batch. Call during record.
+        //! @return false if the tile can't be batched
+        bool add(const TerrainTileNode* tile, vsg::RecordTraversal& rv) const;
+
+        //! Records the batched draws and starts a new batch
+        void accept(vsg::RecordTraversal& rv) const override;
+
+        //! Number of views (vsg::CommandBuffer::viewID) a batch can serve
+        static constexpr unsigned maxViews = 16;
+
+    private:
+        struct Draw
+        {
+            const vsg::BufferInfo* vertices; // first vertex array; tiles sharing it share them all
+            const vsg::Geometry* geometry;
+            VkBuffer indexBuffer;
+            std::uint32_t firstIndex;
+            std::uint32_t indexCount;
+            std::uint32_t tableIndex;
+            vsg::dvec3 origin;
+        };
+
+        struct View
+        {
+            std::vector<Draw> draws;
+            vsg::ref_ptr<vsg::vec4Array> instances;
+            vsg::ref_ptr<vsg::ubyteArray> commands;
+            vsg::ref_ptr<vsg::BindVertexBuffers> bindInstances;
+            vsg::ref_ptr<vsg::DrawIndexedIndirect> drawIndirect;
+        };
+
+        mutable std::array<View, maxViews> _views;
+        std::uint32_t _instanceBinding = 0;
+        bool _multiDraw = false;
+    };
+}
@@ -26,8 +26,14 @@ TerrainEngine::TerrainEngine(
     runtime(new_runtime),
     settings(new_settings),
     geometryPool(worldSRS),
-    tiles(new_map->profile(), new_settings, new_runtime, host),
-    stateFactory(new_runtime)
+    tiles(new_map->profile(), new_worldSRS, new_settings, new_runtime, host),
+    stateFactory(new_runtime),
+    textureEncoder(new_settings)
 {
     jobs::get_pool(loadSchedulerName)->set_concurrency(settings.concurrency);
+
+    if (settings.networkConcurrency.value() > 0u)
+    {
+        URI::setMaxConcurrentReads(settings.networkConcurrency.value());
+    }
 }
@@ -12,6 +12,8 @@
 #include <rocky/vsg/engine/GeometryPool.h>
 #include <rocky/vsg/engine/TerrainState.h>
 #include <rocky/vsg/engine/TerrainTilePager.h>
+#include <rocky/vsg/engine/TerrainHeightQuery.h>
+#include <rocky/vsg/engine/TextureEncoder.h>
 
 namespace ROCKY_NAMESPACE
 {
@@ -52,6 +54,12 @@ namespace ROCKY_NAMESPACE
         //! Creates the state group objects for terrain rendering
         TerrainState stateFactory;
 
+        //! CPU height queries against resident elevation data
+        shared_ptr<TerrainHeightQuery> heightQuery;
+
+        //! Prepares color textures for upload on the loader threads
+        TextureEncoder textureEncoder;
+
         //! name of job arena used to load data
         std::string loadSchedulerName = "rocky.terrain.load";
     };
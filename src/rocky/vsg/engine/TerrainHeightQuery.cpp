@@ -0,0 +1,294 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#include "TerrainHeightQuery.h"
+#include <rocky/Heightfield.h>
+#include <rocky/ElevationLayer.h>
+#include <rocky/Map.h>
+#include <algorithm>
+#include <numeric>
+#include <map>
+
+using namespace ROCKY_NAMESPACE;
+
+#define LC "[TerrainHeightQuery] "
+
+namespace
+{
+    // Copy the xy of the input points into the profile's SRS.
+    std::vector<glm::dvec3> toProfileSRS(const glm::dvec3* points, std::size_t count, const SRS& srs, const SRS& profileSRS)
+    {
+        std::vector<glm::dvec3> local(count);
+        for (std::size_t i = 0; i < count; ++i)
+            local[i] = glm::dvec3(points[i].x, points[i].y, 0.0);
+
+        srs.to(profileSRS).transformArray(local.data(), local.size());
+        return local;
+    }
+
+    // Convert heights sampled in the profile's SRS into the vertical datum of the query SRS.
+    void fromProfileSRS(std::vector<glm::dvec3>& local, float* heights, const SRS& srs, const SRS& profileSRS)
+    {
+        if (srs.equivalentTo(profileSRS))
+            return;
+
+        for (std::size_t i = 0; i < local.size(); ++i)
+            local[i].z = heights[i] != NO_DATA_VALUE ? heights[i] : 0.0;
+
+        srs.to(profileSRS).inverseArray(local.data(), local.size());
+
+        for (std::size_t i = 0; i < local.size(); ++i)
+            if (heights[i] != NO_DATA_VALUE)
+                heights[i] = (float)local[i].z;
+    }
+
+    // Bilinearly sample a tile's elevation raster at a range of points.
+    template<class ITER>
+    std::size_t sampleRaster(const TileKey& key, const Image* raster, const glm::dmat4& matrix,
+        ITER first, ITER last, const std::vector<glm::dvec3>& local, float* out_heights)
+    {
+        auto hf = Heightfield::cast_from(raster);
+        auto ex = key.extent();
+        const double
+            xmin = ex.xmin(),
+            ymin = ex.ymin(),
+            width = ex.width(),
+            height = ex.height(),
+            scaleU = matrix[0][0],
+            scaleV = matrix[1][1],
+            biasU = matrix[3][0],
+            biasV = matrix[3][1];
+
+        std::size_t num_found = 0;
+        for (auto p = first; p != last; ++p)
+        {
+            auto& point = local[*p];
+            double u = (point.x - xmin) / width;
+            double v = (point.y - ymin) / height;
+
+            float h = hf->heightAtUV(u * scaleU + biasU, v * scaleV + biasV, Image::BILINEAR);
+            out_heights[*p] = h;
+            if (h != NO_DATA_VALUE)
+                ++num_found;
+        }
+        return num_found;
+    }
+}
+
+void
+TerrainHeightQuery::reset(shared_ptr<Map> map, unsigned maxLevelOfDetail)
+{
+    std::unique_lock lock(_mutex);
+
+    _index.clear();
+    _rootKeys.clear();
+    _map = map;
+    _profile = map ? map->profile() : Profile();
+    _maxLevelOfDetail = maxLevelOfDetail;
+
+    if (_profile.valid())
+    {
+        Profile::getRootKeys(_profile, _rootKeys);
+    }
+}
+
+void
+TerrainHeightQuery::insert(const TileKey& key, shared_ptr<Image> raster, const glm::dmat4& matrix)
+{
+    if (!raster || !Heightfield::cast_from(raster.get()))
+        return;
+
+    std::unique_lock lock(_mutex);
+    _index[key] = Entry{ key, raster, matrix };
+}
+
+void
+TerrainHeightQuery::remove(const TileKey& key)
+{
+    std::unique_lock lock(_mutex);
+    _index.erase(key);
+}
+
+std::size_t
+TerrainHeightQuery::size() const
+{
+    std::shared_lock lock(_mutex);
+    return _index.size();
+}
+
+void
+TerrainHeightQuery::sample(const TileKey& key, const Entry* best, Indices first, Indices last,
+    const std::vector<glm::dvec3>& local, float* out_heights, std::size_t& num_found) const
+{
+    auto i = _index.find(key);
+    if (i != _index.end())
+        best = &i->second;
+
+    if (best == nullptr)
+        return;
+
+    // Split the points among the quadrants of this key, and descend into any
+    // child that is resident. Quadrants are numbered NW, NE, SW, SE.
+    const TileKey children[4] = {
+        key.createChildKey(0), key.createChildKey(1), key.createChildKey(2), key.createChildKey(3) };
+
+    bool resident[4];
+    bool any_resident = false;
+    for (unsigned q = 0; q < 4; ++q)
+    {
+        resident[q] = _index.count(children[q]) > 0;
+        any_resident = any_resident || resident[q];
+    }
+
+    if (any_resident)
+    {
+        auto ex = key.extent();
+        double cx = 0.5 * (ex.xmin() + ex.xmax());
+        double cy = 0.5 * (ex.ymin() + ex.ymax());
+
+        auto south = std::partition(first, last, [&](std::uint32_t p) { return local[p].y >= cy; });
+        auto ne = std::partition(first, south, [&](std::uint32_t p) { return local[p].x < cx; });
+        auto se = std::partition(south, last, [&](std::uint32_t p) { return local[p].x < cx; });
+
+        const std::pair<Indices, Indices> ranges[4] = { {first, ne}, {ne, south}, {south, se}, {se, last} };
+
+        for (unsigned q = 0; q < 4; ++q)
+        {
+            if (ranges[q].first == ranges[q].second)
+                continue;
+
+            if (resident[q])
+                sample(children[q], best, ranges[q].first, ranges[q].second, local, out_heights, num_found);
+            else
+                num_found += sampleRaster(best->key, best->raster.get(), best->matrix, ranges[q].first, ranges[q].second, local, out_heights);
+        }
+        return;
+    }
+
+    // no resident children; sample the best raster for all the points.
+    num_found += sampleRaster(best->key, best->raster.get(), best->matrix, first, last, local, out_heights);
+}
+
+std::size_t
+TerrainHeightQuery::heightsAt(const glm::dvec3* points, std::size_t count, const SRS& srs, float* out_heights) const
+{
+    std::fill(out_heights, out_heights + count, NO_DATA_VALUE);
+
+    std::shared_lock lock(_mutex);
+
+    if (count == 0 || _index.empty() || !_profile.valid())
+        return 0;
+
+    auto local = toProfileSRS(points, count, srs, _profile.srs());
+
+    std::vector<std::uint32_t> indices(count);
+    std::iota(indices.begin(), indices.end(), 0);
+
+    std::size_t num_found = 0;
+    auto first = indices.begin();
+
+    for (auto& root : _rootKeys)
+    {
+        auto ex = root.extent();
+        auto last = std::partition(first, indices.end(), [&](std::uint32_t p)
+            {
+                return ex.contains(local[p].x, local[p].y);
+            });
+
+        if (first != last)
+        {
+            sample(root, nullptr, first, last, local, out_heights, num_found);
+            first = last;
+        }
+    }
+
+    if (num_found > 0)
+    {
+        fromProfileSRS(local, out_heights, srs, _profile.srs());
+    }
+
+    return num_found;
+}
+
+std::size_t
+TerrainHeightQuery::clamp(std::vector<glm::dvec3>& points, const SRS& srs) const
+{
+    std::vector<float> heights(points.size());
+    auto num_found = heightsAt(points.data(), points.size(), srs, heights.data());
+
+    for (std::size_t i = 0; i < points.size(); ++i)
+    {
+        if (heights[i] != NO_DATA_VALUE)
+            points[i].z = heights[i];
+    }
+    return num_found;
+}
+
+jobs::future<std::vector<float>>
+TerrainHeightQuery::heightsAtFullResolution(const std::vector<glm::dvec3>& points, const SRS& srs, const IOOptions& in_io) const
+{
+    std::shared_lock lock(_mutex);
+
+    auto map = _map;
+    auto profile = _profile;
+    auto lod = _maxLevelOfDetail;
+    const IOOptions io(in_io);
+
+    auto task = [map, profile, lod, points, srs, io](Cancelable& c)
+        {
+            std::vector<float> heights(points.size(), NO_DATA_VALUE);
+
+            // the terrain engine renders the first elevation layer, so match it.
+            auto layer = map ? map->layers().firstOfType<ElevationLayer>() : nullptr;
+            if (!layer || !layer->isOpen() || points.empty())
+                return heights;
+
+            auto local = toProfileSRS(points.data(), points.size(), srs, profile.srs());
+
+            // group the points by the best tile available in the layer:
+            auto& ex = profile.extent();
+            auto dims = profile.numTiles(lod);
+            double tile_width = ex.width() / (double)dims.first;
+            double tile_height = ex.height() / (double)dims.second;
+
+            std::map<TileKey, std::vector<std::uint32_t>> groups;
+            for (std::uint32_t p = 0; p < (std::uint32_t)local.size(); ++p)
+            {
+                auto& point = local[p];
+                if (!ex.contains(point.x, point.y))
+                    continue;
+
+                unsigned tx = (unsigned)std::clamp((int)((point.x - ex.xmin()) / tile_width), 0, (int)dims.first - 1);
+                unsigned ty = (unsigned)std::clamp((int)((ex.ymax() - point.y) / tile_height), 0, (int)dims.second - 1);
+
+                auto key = layer->bestAvailableTileKey(TileKey(lod, tx, ty, profile));
+                if (key.valid())
+                    groups[key].push_back(p);
+            }
+
+            for (auto& group : groups)
+            {
+                if (c.canceled())
+                    return heights;
+
+                auto result = layer->createHeightfield(group.first, IOOptions(io, c));
+                if (result.status.ok())
+                {
+                    for (auto p : group.second)
+                    {
+                        heights[p] = result.value.heightAtLocation(local[p].x, local[p].y, Image::BILINEAR);
+                    }
+                }
+            }
+
+            fromProfileSRS(local, heights.data(), srs, profile.srs());
+
+            return heights;
+        };
+
+    return jobs::dispatch(task, jobs::context{
+        "terrain height query",
+        jobs::get_pool("rocky.terrain.query") });
+}
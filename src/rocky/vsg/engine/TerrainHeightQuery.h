@@ -0,0 +1,116 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#pragma once
+
+#include <rocky/vsg/Common.h>
+#include <rocky/Threading.h>
+#include <rocky/TileKey.h>
+#include <rocky/Image.h>
+#include <rocky/IOTypes.h>
+#include <unordered_map>
+#include <shared_mutex>
+#include <vector>
+
+namespace ROCKY_NAMESPACE
+{
+    class Map;
+
+    /**
+     * Answers terrain height queries on the CPU.
+     *
+     * The terrain engine registers each tile's elevation raster here as it
+     * merges, and removes it when the tile pages out. Queries then sample the
+     * highest-resolution raster that is resident at each location, without
+     * touching the scene graph. All methods are thread-safe.
+     */
+    class ROCKY_EXPORT TerrainHeightQuery
+    {
+    public:
+        //! Construct an empty query service
+        TerrainHeightQuery() = default;
+
+        //! Heights of the terrain at a batch of locations, sampled from the
+        //! elevation data currently resident in the terrain engine.
+        //! @param points Locations to query (x, y in "srs"; z is ignored)
+        //! @param count Number of points
+        //! @param srs Spatial reference of the points
+        //! @param out_heights Receives one height per point (in the vertical
+        //!   datum of "srs"), or NO_DATA_VALUE where no terrain is resident
+        //! @return Number of points that received a height
+        std::size_t heightsAt(
+            const glm::dvec3* points,
+            std::size_t count,
+            const SRS& srs,
+            float* out_heights) const;
+
+        //! Clamps a batch of points to the resident terrain by setting
+        //! their z values. Points with no resident terrain are left alone.
+        //! @return Number of points that were clamped
+        std::size_t clamp(
+            std::vector<glm::dvec3>& points,
+            const SRS& srs) const;
+
+        //! Heights of the terrain at a batch of locations, read in the background
+        //! from the map's elevation layer at full resolution.
+        //! @param points Locations to query (x, y in "srs"; z is ignored)
+        //! @param srs Spatial reference of the points
+        //! @param io IO options
+        //! @return Future result with one height per point (NO_DATA_VALUE where
+        //!   the layer has no data)
+        jobs::future<std::vector<float>> heightsAtFullResolution(
+            const std::vector<glm::dvec3>& points,
+            const SRS& srs,
+            const IOOptions& io) const;
+
+        //! Number of tiles currently registered
+        std::size_t size() const;
+
+    public: // called by the terrain engine
+
+        //! Clears all registered tiles and sets the map to query.
+        //! @param map Map whose terrain is being rendered
+        //! @param maxLevelOfDetail Deepest LOD to consider for full-resolution queries
+        void reset(shared_ptr<Map> map, unsigned maxLevelOfDetail);
+
+        //! Registers (or replaces) the elevation raster for a tile.
+        //! @param key Tile key
+        //! @param raster Elevation raster (a Heightfield)
+        //! @param matrix Scale/bias matrix mapping the tile's UVs into the raster
+        void insert(
+            const TileKey& key,
+            shared_ptr<Image> raster,
+            const glm::dmat4& matrix);
+
+        //! Unregisters a tile.
+        void remove(const TileKey& key);
+
+    private:
+        struct Entry
+        {
+            TileKey key;
+            shared_ptr<Image> raster;
+            glm::dmat4 matrix{ 1 };
+        };
+
+        mutable std::shared_mutex _mutex;
+        std::unordered_map<TileKey, Entry> _index;
+        shared_ptr<Map> _map;
+        Profile _profile;
+        std::vector<TileKey> _rootKeys;
+        unsigned _maxLevelOfDetail = 19u;
+
+        using Indices = std::vector<std::uint32_t>::iterator;
+
+        void sample(
+            const TileKey& key,
+            const Entry* best,
+            Indices first,
+            Indices last,
+            const std::vector<glm::dvec3>& local,
+            float* out_heights,
+            std::size_t& num_found) const;
+    };
+}
@@ -6,6 +6,7 @@
 #include "TerrainNode.h"
 #include "TerrainTileNode.h"
 #include "TerrainEngine.h"
+#include "TerrainHeightQuery.h"
 
 #include <rocky/json.h>
 #include <rocky/IOTypes.h>
@@ -31,6 +32,8 @@ TerrainNode::construct()
     {
         concurrency = std::thread::hardware_concurrency() / 2;
     }
+
+    heightQuery = std::make_shared<TerrainHeightQuery>();
 }
 
 Status
@@ -50,13 +53,6 @@ TerrainNode::setMap(shared_ptr<Map> new_map, const SRS& new_worldSRS)
 {
     ROCKY_SOFT_ASSERT_AND_RETURN(new_map, status);
 
-    // remove old hooks:
-    if (map)
-    {
-        map->onLayerAdded.remove(std::uintptr_t(this));
-        map->onLayerRemoved.remove(std::uintptr_t(this));
-    }
-
     map = new_map;
 
     _worldSRS = new_worldSRS;
@@ -67,16 +63,17 @@ TerrainNode::setMap(shared_ptr<Map> new_map, const SRS& new_worldSRS)
             new_map->srs();
     }
 
-    if (map)
-    {
-        map->onLayerAdded([this](auto...) { reset(); });
-        map->onLayerRemoved([this](auto...) { reset(); });
-    }
+    // Note: no need to reset when layers are added, removed or changed;
+    // the tile pager detects that and refreshes the affected data in place.
 
     engine = nullptr;
 
+    heightQuery->reset(nullptr, maxLevelOfDetail);
+
     // erase everything so the map will reinitialize
     this->children.clear();
+    _tilesRoot = nullptr;
+    _drawBatch = nullptr;
     status = StatusOK;
     return status;
 }
@@ -90,9 +87,13 @@ TerrainNode::reset()
     }
 
     children.clear();
+    _tilesRoot = nullptr;
+    _drawBatch = nullptr;
 
     engine = nullptr;
 
+    heightQuery->reset(nullptr, maxLevelOfDetail);
+
     status = Status_OK;
 }
 
@@ -109,6 +110,10 @@ TerrainNode::createRootTiles(const IOOptions& io)
         *this,     // settings
         this);     // host
 
+    // start tracking elevation data for height queries
+    heightQuery->reset(map, maxLevelOfDetail);
+    engine->heightQuery = heightQuery;
+
     // check that everything initialized ok
     if (engine->stateFactory.status.failed())
     {
@@ -118,8 +123,16 @@ TerrainNode::createRootTiles(const IOOptions& io)
     _tilesRoot = vsg::Group::create();
 
     // create the graphics pipeline to render this map
-    auto stateGroup = engine->stateFactory.createTerrainStateGroup();
+    auto stateGroup = engine->stateFactory.createTerrainStateGroup(*this);
     stateGroup->addChild(_tilesRoot);
+
+    if (engine->stateFactory.indirect)
+    {
+        // visible tiles add themselves to the batch, which then draws them all
+        _drawBatch = TerrainDrawBatch::create(engine->stateFactory);
+        stateGroup->addChild(_drawBatch);
+    }
+
     this->addChild(stateGroup);
 
     // once the pipeline exists, we can start creating tiles.
@@ -163,8 +176,15 @@ TerrainNode::update(const vsg::FrameStamp* fs, const IOOptions& io)
         {
             ROCKY_HARD_ASSERT(engine);
 
+            _cameraPredictor.update(fs->time, prefetchTime.value());
+
+            engine->stateFactory.updateTerrainUniforms(*this);
+
             if (engine->tiles.update(fs, io, engine))
                 changes = true;
+
+            if (engine->stateFactory.indirect)
+                engine->stateFactory.updateTileTable(engine->runtime);
             
             engine->geometryPool.sweep(engine->runtime);
         }
@@ -173,8 +193,58 @@ TerrainNode::update(const vsg::FrameStamp* fs, const IOOptions& io)
     return changes;
 }
 
+void
+TerrainNode::setCameraDestination(const vsg::dvec3& eye, std::chrono::duration<float> eta)
+{
+    auto delay = std::chrono::duration_cast<vsg::clock::duration>(eta);
+    _cameraPredictor.setDestination(eye, vsg::clock::now() + delay);
+}
+
+void
+TerrainNode::accept(vsg::RecordTraversal& rv) const
+{
+    if (prefetchTime.value() > 0.0f)
+    {
+        auto eye = vsg::inverse(rv.getState()->modelviewMatrixStack.top()) * vsg::dvec3(0, 0, 0);
+        auto* fs = rv.getFrameStamp();
+        _cameraPredictor.sample(eye, fs->frameCount, fs->time);
+    }
+
+    Inherit::accept(rv);
+}
+
+bool
+TerrainNode::intersect(const vsg::dvec3& start, const vsg::dvec3& end, vsg::dvec3& out_world) const
+{
+    if (!_tilesRoot)
+        return false;
+
+    double ratio = 1.0;
+    bool hit = false;
+
+    for (auto& child : _tilesRoot->children)
+    {
+        auto tile = child->cast<TerrainTileNode>();
+        if (tile && tile->intersect(start, end, ratio))
+            hit = true;
+    }
+
+    if (hit)
+    {
+        out_world = start + (end - start) * ratio;
+    }
+
+    return hit;
+}
+
 void
 TerrainNode::ping(TerrainTileNode* tile, const TerrainTileNode* parent, vsg::RecordTraversal& nv)
 {
     engine->tiles.ping(tile, parent, nv);
 }
+
+bool
+TerrainNode::draw(const TerrainTileNode* tile, vsg::RecordTraversal& rv)
+{
+    return _drawBatch && _drawBatch->add(tile, rv);
+}
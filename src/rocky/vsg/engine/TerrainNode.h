@@ -8,9 +8,12 @@
 #include <rocky/vsg/Common.h>
 #include <rocky/vsg/TerrainSettings.h>
 #include <rocky/vsg/engine/TerrainTileHost.h>
+#include <rocky/vsg/engine/CameraPredictor.h>
+#include <rocky/vsg/engine/TerrainDrawBatch.h>
 #include <rocky/Status.h>
 #include <rocky/SRS.h>
 #include <vsg/nodes/Group.h>
+#include <vsg/maths/vec3.h>
 
 namespace ROCKY_NAMESPACE
 {
@@ -19,6 +22,7 @@ namespace ROCKY_NAMESPACE
     class SRS;
     class Runtime;
     class TerrainEngine;
+    class TerrainHeightQuery;
 
     /**
      * Root node of the terrain geometry
@@ -44,10 +48,31 @@ namespace ROCKY_NAMESPACE
         //! Serialize to JSON
         std::string to_json() const;
 
+        //! Intersects a world-space line segment with the resident terrain tiles.
+        //! This only tests the terrain surface and is much faster than a general
+        //! scene graph intersection. Call from the same thread that updates the terrain.
+        //! @param start Start of the segment (world coordinates)
+        //! @param end End of the segment (world coordinates)
+        //! @param out_world Closest intersection with the terrain (world coordinates)
+        //! @return True if the segment intersects the terrain
+        bool intersect(
+            const vsg::dvec3& start,
+            const vsg::dvec3& end,
+            vsg::dvec3& out_world) const;
+
         //! Updates the terrain periodically at a safe time.
         //! @return true if any updates were applied
         bool update(const vsg::FrameStamp*, const IOOptions& io);
 
+        //! Tells the terrain that the camera will arrive at a world position
+        //! after a delay (e.g. at the end of a viewpoint transition) so it can
+        //! prefetch tiles for the destination.
+        //! @param eye Eye position at the destination (world coordinates)
+        //! @param eta Time until the camera arrives
+        void setCameraDestination(const vsg::dvec3& eye, std::chrono::duration<float> eta);
+
+        void accept(vsg::RecordTraversal&) const override;
+
         //! Status of this node; check that's it OK before using
         Status status;
 
@@ -57,6 +82,10 @@ namespace ROCKY_NAMESPACE
         //! Engine that renders the terrain
         std::shared_ptr<TerrainEngine> engine;
 
+        //! CPU height queries against the resident terrain; stays valid
+        //! across calls to reset() and setMap()
+        std::shared_ptr<TerrainHeightQuery> heightQuery;
+
     protected:
 
         //! TerrainTileHost interface
@@ -65,11 +94,21 @@ namespace ROCKY_NAMESPACE
             const TerrainTileNode* parent,
             vsg::RecordTraversal&) override;
 
+        //! TerrainTileHost interface
+        bool draw(
+            const TerrainTileNode* tile,
+            vsg::RecordTraversal&) override;
+
         //! Terrain settings
         const TerrainSettings& settings() override {
             return *this;
         }
 
+        //! TerrainTileHost interface
+        bool predictedEye(vsg::dvec3& out) const override {
+            return _cameraPredictor.predict(out);
+        }
+
     private:
 
         void construct();
@@ -78,6 +117,10 @@ namespace ROCKY_NAMESPACE
 
         Runtime& _runtime;
         vsg::ref_ptr<vsg::Group> _tilesRoot;
+        vsg::ref_ptr<TerrainDrawBatch> _drawBatch;
         SRS _worldSRS;
+        mutable CameraPredictor _cameraPredictor;
+
+        friend class TerrainReplay;
     };
 }
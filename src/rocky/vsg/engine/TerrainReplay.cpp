@@ -0,0 +1,387 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#include "TerrainReplay.h"
+#include "TerrainEngine.h"
+#include "TerrainTileNode.h"
+#include "SurfaceNode.h"
+#include "Utils.h"
+
+#include <rocky/vsg/MapNode.h>
+#include <rocky/vsg/TerrainNode.h>
+#include <rocky/Horizon.h>
+#include <rocky/Math.h>
+#include <rocky/json.h>
+
+#include <vsg/app/Viewer.h>
+#include <vsg/ui/FrameStamp.h>
+
+#include <array>
+#include <cfloat>
+#include <functional>
+#include <thread>
+
+using namespace ROCKY_NAMESPACE;
+
+#define LC "[TerrainReplay] "
+
+namespace
+{
+    // wrap an angle difference (degrees) into [-180, 180)
+    inline double wrap180(double a)
+    {
+        a = std::fmod(a + 180.0, 360.0);
+        return (a < 0.0 ? a + 360.0 : a) - 180.0;
+    }
+
+    //! The camera as the terrain sees it during record: world-space frustum
+    //! planes, the LOD metric, and the horizon.
+    struct View
+    {
+        vsg::dvec3 eye;
+        vsg::dvec3 look;                     // unit view direction
+        std::array<vsg::dplane, 5> faces;    // near and sides, normals pointing inward
+        double lodScale = 1.0;               // view depth / lodScale = LOD distance (see vsg::State)
+        double minScreenHeightRatio = 0.0;
+        unsigned maxLevel = 0u;
+        const Horizon* horizon = nullptr;
+
+        // same as vsg::State::lodDistance: -1 if the sphere is outside the frustum
+        double lodDistance(const vsg::dsphere& bs) const
+        {
+            for (auto& face : faces)
+                if (vsg::distance(face, bs.center) < -bs.radius)
+                    return -1.0;
+            return std::abs(vsg::dot(bs.center - eye, look)) / lodScale;
+        }
+    };
+
+    vsg::dplane inwardPlane(const vsg::dvec3& normal, const vsg::dvec3& point)
+    {
+        auto n = vsg::normalize(normal);
+        return vsg::dplane(n.x, n.y, n.z, -vsg::dot(n, point));
+    }
+}
+
+double
+CameraPath::duration() const
+{
+    return keyframes.empty() ? 0.0 : keyframes.back().time;
+}
+
+CameraPath::Keyframe
+CameraPath::at(double time) const
+{
+    if (keyframes.empty())
+        return {};
+
+    if (time <= keyframes.front().time)
+        return keyframes.front();
+
+    if (time >= keyframes.back().time)
+        return keyframes.back();
+
+    unsigned i = 1;
+    while (keyframes[i].time < time)
+        ++i;
+
+    auto& a = keyframes[i - 1];
+    auto& b = keyframes[i];
+    double t = b.time > a.time ? (time - a.time) / (b.time - a.time) : 1.0;
+
+    // ease in and out so the camera doesn't jerk at each keyframe
+    t = util::smoothstep(0.0, 1.0, t);
+
+    Keyframe out;
+    out.time = time;
+    out.point = GeoPoint(a.point.srs,
+        a.point.x + wrap180(b.point.x - a.point.x) * t,
+        a.point.y + (b.point.y - a.point.y) * t,
+        a.point.z + (b.point.z - a.point.z) * t);
+    out.heading = a.heading + wrap180(b.heading - a.heading) * t;
+    out.pitch = a.pitch + (b.pitch - a.pitch) * t;
+    out.range = std::exp(std::log(std::max(a.range, 1.0)) * (1.0 - t) + std::log(std::max(b.range, 1.0)) * t);
+    return out;
+}
+
+Status
+CameraPath::from_json(const std::string& input)
+{
+    auto j = parse_json(input);
+    if (j.status.failed())
+        return j.status;
+
+    get_to(j, "field_of_view", fieldOfView);
+
+    if (j.contains("viewport"))
+    {
+        auto j_viewport = j.at("viewport");
+        if (j_viewport.is_array() && j_viewport.size() == 2)
+        {
+            viewportWidth = j_viewport[0].get<unsigned>();
+            viewportHeight = j_viewport[1].get<unsigned>();
+        }
+    }
+
+    keyframes.clear();
+
+    if (j.contains("keyframes"))
+    {
+        auto j_keyframes = j.at("keyframes");
+        if (j_keyframes.is_array())
+        {
+            for (auto& j_key : j_keyframes)
+            {
+                Keyframe key;
+                double lon = 0.0, lat = 0.0, alt = 0.0;
+                get_to(j_key, "time", key.time);
+                get_to(j_key, "long", lon);
+                get_to(j_key, "lat", lat);
+                get_to(j_key, "alt", alt);
+                get_to(j_key, "heading", key.heading);
+                get_to(j_key, "pitch", key.pitch);
+                get_to(j_key, "range", key.range);
+                key.point = GeoPoint(SRS::WGS84, lon, lat, alt);
+                keyframes.emplace_back(std::move(key));
+            }
+        }
+    }
+
+    if (keyframes.empty())
+        return Status(Status::ConfigurationError, "Camera path has no keyframes");
+
+    for (unsigned i = 1; i < keyframes.size(); ++i)
+    {
+        if (keyframes[i].time < keyframes[i - 1].time)
+            return Status(Status::ConfigurationError, "Camera path keyframes are out of order");
+    }
+
+    if (fieldOfView <= 0.0 || fieldOfView >= 180.0 || viewportWidth == 0 || viewportHeight == 0)
+        return Status(Status::ConfigurationError, "Camera path has an invalid field of view or viewport");
+
+    return Status_OK;
+}
+
+std::string
+TerrainReplay::Report::to_json() const
+{
+    auto rate = [this](std::uint64_t count) { return duration > 0.0 ? (double)count / duration : 0.0; };
+
+    auto j = json::object();
+    set(j, "duration", duration);
+    set(j, "frames", frames);
+    set(j, "created", created);
+    set(j, "loaded", loaded);
+    set(j, "merged", merged);
+    set(j, "expired", expired);
+    set(j, "canceled", canceled);
+    set(j, "created_per_second", rate(created));
+    set(j, "loaded_per_second", rate(loaded));
+    set(j, "merged_per_second", rate(merged));
+    set(j, "expired_per_second", rate(expired));
+    set(j, "time_to_full_resolution", timeToFullResolution);
+    set(j, "peak_resident_tiles", peakResidentTiles);
+    return j.dump(4);
+}
+
+TerrainReplay::TerrainReplay(vsg::ref_ptr<MapNode> mapNode) :
+    _mapNode(mapNode)
+{
+    //nop
+}
+
+Result<TerrainReplay::Report>
+TerrainReplay::run(const CameraPath& path)
+{
+    ROCKY_SOFT_ASSERT_AND_RETURN(_mapNode && _mapNode->terrainNode, Status(Status::AssertionFailure));
+    ROCKY_SOFT_ASSERT_AND_RETURN(settings.frameRate > 0.0, Status(Status::ConfigurationError));
+
+    if (path.keyframes.empty())
+        return Status(Status::ConfigurationError, "Camera path has no keyframes");
+
+    auto& runtime = _mapNode->instance.runtime();
+    if (!runtime.viewer)
+        return Status(Status::ConfigurationError, "Runtime has no viewer");
+
+    auto& terrain = *_mapNode->terrainNode;
+    auto& worldSRS = _mapNode->worldSRS();
+
+    Horizon horizon(worldSRS.ellipsoid());
+    bool useHorizon = worldSRS.isGeocentric();
+
+    View view;
+    view.minScreenHeightRatio = (terrain.tilePixelSize.value() + terrain.screenSpaceError.value()) / (double)path.viewportHeight;
+    view.maxLevel = terrain.maxLevelOfDetail.value();
+    view.horizon = useHorizon ? &horizon : nullptr;
+
+    double tanY = std::tan(util::deg2rad(path.fieldOfView) * 0.5);
+    double tanX = tanY * (double)path.viewportWidth / (double)path.viewportHeight;
+
+    // vsg::State's LOD scale for a perspective camera with an unscaled view matrix
+    view.lodScale = (1.0 / tanY) * 0.5 * std::sqrt(2.0);
+
+    // place the camera at a keyframe
+    auto setCamera = [&](const CameraPath::Keyframe& key)
+        {
+            glm::dvec3 focus;
+            key.point.transform(worldSRS, focus);
+            auto enu = worldSRS.localToWorldMatrix(focus);
+            auto east = glm::normalize(glm::dvec3(enu[0]));
+            auto north = glm::normalize(glm::dvec3(enu[1]));
+            auto up = glm::normalize(glm::dvec3(enu[2]));
+
+            double h = util::deg2rad(key.heading), p = util::deg2rad(key.pitch);
+            auto look = east * (sin(h) * cos(p)) + north * (cos(h) * cos(p)) + up * sin(p);
+            auto right = east * cos(h) - north * sin(h);
+            auto camUp = glm::cross(right, look);
+
+            view.eye = to_vsg(focus - look * key.range);
+            view.look = to_vsg(look);
+
+            auto f = to_vsg(look), r = to_vsg(right), u = to_vsg(camUp);
+            view.faces[0] = inwardPlane(f, view.eye + f * 1.0);
+            view.faces[1] = inwardPlane(r + f * tanX, view.eye);
+            view.faces[2] = inwardPlane(-r + f * tanX, view.eye);
+            view.faces[3] = inwardPlane(u + f * tanY, view.eye);
+            view.faces[4] = inwardPlane(-u + f * tanY, view.eye);
+
+            if (useHorizon)
+                horizon.setEye(to_glm(view.eye));
+        };
+
+    auto& engine = terrain.engine;
+    std::uint64_t frame = 0u;
+    vsg::time_point frameTime;
+    bool complete = false;
+
+    // what the record traversal does in TerrainTileNode::accept, minus the drawing
+    // and prefetching.
+    // Returns false if any tile it would draw isn't yet at full resolution.
+    vsg::RecordTraversal rv;
+    std::function<bool(TerrainTileNode*)> visit;
+    visit = [&](TerrainTileNode* tile) -> bool
+        {
+            bool resolved = true;
+
+            auto new_frame = tile->lastTraversalFrame.exchange(frame) != frame;
+            auto range = (float)vsg::length(tile->bound.center - view.eye);
+            tile->lastTraversalRange.exchange(std::min(new_frame ? FLT_MAX : (float)tile->lastTraversalRange, range));
+            tile->lastTraversalTime.exchange(frameTime);
+
+            if (tile->subtilesExist())
+                tile->_needsSubtiles = false;
+
+            if (tile->surface->isVisible(view.faces.data(), view.faces.size(), view.horizon))
+            {
+                auto d = view.lodDistance(tile->bound);
+                bool subtilesInRange = d >= 0.0 && tile->shouldSubDivide(d, view.lodScale, view.minScreenHeightRatio);
+
+                if (subtilesInRange && tile->subtilesExist())
+                {
+                    for (unsigned q = 0; q < 4; ++q)
+                        resolved = visit(tile->subTile(q)) && resolved;
+
+                    for (unsigned q = 0; q < 4; ++q)
+                        engine->tiles.ping(tile->subTile(q), tile, rv);
+                }
+                else
+                {
+                    resolved =
+                        tile->dataMerger.available() &&
+                        !tile->refreshColor && !tile->refreshElevation &&
+                        !(subtilesInRange && tile->key.levelOfDetail() < view.maxLevel);
+
+                    if (subtilesInRange && tile->subtilesLoader.empty())
+                        tile->_needsSubtiles = true;
+                }
+            }
+
+            if (tile->doNotExpire)
+                engine->tiles.ping(tile, nullptr, rv);
+
+            return resolved;
+        };
+
+    // counts from before the replay (if the terrain already exists)
+    std::array<std::uint64_t, 5> base = { 0u, 0u, 0u, 0u, 0u };
+    const TerrainEngine* baseEngine = engine.get();
+    if (baseEngine)
+    {
+        auto& c = baseEngine->tiles.counters;
+        base = { c.created, c.loaded, c.merged, c.expired, c.canceled };
+    }
+
+    Report report;
+    auto frameInterval = std::chrono::duration_cast<vsg::clock::duration>(
+        std::chrono::duration<double>(1.0 / settings.frameRate));
+    auto start = vsg::clock::now();
+    auto next = start;
+    double elapsed = 0.0;
+
+    while (!complete && elapsed < path.duration() + settings.settleTimeout)
+    {
+        // hold the frame rate; the pager works in real time
+        std::this_thread::sleep_until(next);
+        next += frameInterval;
+
+        frameTime = vsg::clock::now();
+        elapsed = std::chrono::duration<double>(frameTime - start).count();
+        auto fs = vsg::FrameStamp::create(frameTime, ++frame);
+
+        // the update pass of a render loop
+        _mapNode->update(fs);
+        runtime.update();
+        runtime.viewer->updateOperations->run();
+
+        if (terrain.status.failed())
+            return terrain.status;
+
+        if (!engine || !terrain._tilesRoot)
+            continue;
+
+        // the record pass
+        setCamera(path.at(elapsed));
+
+        bool resolved = true;
+        for (auto& child : terrain._tilesRoot->children)
+        {
+            auto tile = child->cast<TerrainTileNode>();
+            if (tile)
+                resolved = visit(tile) && resolved;
+        }
+
+        report.peakResidentTiles = std::max(report.peakResidentTiles, engine->tiles.size());
+
+        if (resolved && elapsed >= path.duration())
+        {
+            report.timeToFullResolution = elapsed - path.duration();
+            complete = true;
+        }
+    }
+
+    report.duration = elapsed;
+    report.frames = frame;
+
+    if (engine)
+    {
+        // the terrain may have been rebuilt during the replay
+        if (engine.get() != baseEngine)
+            base = { 0u, 0u, 0u, 0u, 0u };
+
+        auto& c = engine->tiles.counters;
+        report.created = c.created - base[0];
+        report.loaded = c.loaded - base[1];
+        report.merged = c.merged - base[2];
+        report.expired = c.expired - base[3];
+        report.canceled = c.canceled - base[4];
+    }
+
+    if (!complete)
+    {
+        Log()->info(LC "View did not reach full resolution within " + std::to_string(settings.settleTimeout) + "s of the end of the path");
+    }
+
+    return report;
+}
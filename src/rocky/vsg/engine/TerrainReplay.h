@@ -0,0 +1,107 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#pragma once
+
+#include <rocky/vsg/Common.h>
+#include <rocky/GeoPoint.h>
+#include <rocky/Status.h>
+#include <vector>
+
+namespace ROCKY_NAMESPACE
+{
+    class MapNode;
+
+    /**
+     * A camera flight described by keyframes. The camera looks at each
+     * keyframe's point from the given heading, pitch and range, and moves
+     * smoothly between keyframes.
+     */
+    struct ROCKY_EXPORT CameraPath
+    {
+        struct Keyframe
+        {
+            double time = 0.0;      // seconds from the start of the path
+            GeoPoint point;         // focal point
+            double heading = 0.0;   // degrees clockwise from north
+            double pitch = -90.0;   // degrees; -90 looks straight down
+            double range = 1e7;     // distance from the eye to the focal point (meters)
+        };
+
+        std::vector<Keyframe> keyframes;
+
+        //! Vertical field of view (degrees)
+        double fieldOfView = 30.0;
+
+        //! Size of the (virtual) viewport in pixels
+        unsigned viewportWidth = 1920;
+        unsigned viewportHeight = 1080;
+
+        //! Time of the last keyframe
+        double duration() const;
+
+        //! Camera at a time along the path. Longitude and heading take the
+        //! short way around; range interpolates logarithmically.
+        Keyframe at(double time) const;
+
+        //! Deserialize from JSON, e.g.
+        //! { "field_of_view": 30, "viewport": [1920, 1080],
+        //!   "keyframes": [ { "time": 0, "long": -77, "lat": 39, "heading": 0, "pitch": -90, "range": 1e7 }, ... ] }
+        Status from_json(const std::string& JSON);
+    };
+
+    /**
+     * Replays a camera path against a MapNode's terrain without a window
+     * or GPU, and measures how well the terrain pager keeps up.
+     *
+     * Each frame it updates the map node and runs the viewer's update
+     * operations just like a render loop would, then walks the tile tree
+     * from the camera's point of view (with the same visibility and LOD
+     * tests the record traversal uses) and pings the pager with the tiles
+     * it would have drawn. Frames run in real time so load latency counts.
+     */
+    class ROCKY_EXPORT TerrainReplay
+    {
+    public:
+        struct Settings
+        {
+            //! Frames per second to simulate
+            double frameRate = 60.0;
+
+            //! Seconds to keep running after the path ends while
+            //! waiting for the view to reach full resolution
+            double settleTimeout = 60.0;
+        };
+
+        struct Report
+        {
+            double duration = 0.0;              // seconds of replay, including settling
+            std::uint64_t frames = 0u;
+            std::uint64_t created = 0u;         // tiles created
+            std::uint64_t loaded = 0u;          // tile data loads completed
+            std::uint64_t merged = 0u;          // tile data merges applied
+            std::uint64_t expired = 0u;         // tiles evicted
+            std::uint64_t canceled = 0u;        // data loads abandoned
+            double timeToFullResolution = -1.0; // seconds after the path ends; -1 = never
+            std::size_t peakResidentTiles = 0u;
+
+            //! Serialize, including per-second rates
+            std::string to_json() const;
+        };
+
+    public:
+        //! Construct a replay for a map node. The map node's runtime
+        //! must have a viewer (it may be one without windows).
+        TerrainReplay(vsg::ref_ptr<MapNode> mapNode);
+
+        Settings settings;
+
+        //! Fly the camera path and report the pager's throughput.
+        Result<Report> run(const CameraPath& path);
+
+    private:
+        vsg::ref_ptr<MapNode> _mapNode;
+    };
+}
@@ -9,12 +9,14 @@
 #include "Utils.h"
 #include "PipelineState.h"
 
+#include <rocky/vsg/TerrainSettings.h>
 #include <rocky/Color.h>
 #include <rocky/Heightfield.h>
 #include <rocky/Image.h>
 
 #include <vsg/state/BindDescriptorSet.h>
 #include <vsg/state/ViewDependentState.h>
+#include <vsg/app/Viewer.h>
 
 #define TERRAIN_VERT_SHADER "shaders/rocky.terrain.vert"
 #define TERRAIN_FRAG_SHADER "shaders/rocky.terrain.frag"
@@ -31,11 +33,24 @@
 #define TILE_BUFFER_NAME "tile"
 #define TILE_BUFFER_BINDING 13
 
+#define TERRAIN_BUFFER_NAME "terrain"
+#define TERRAIN_BUFFER_BINDING 14
+
+#define TILE_TABLE_NAME "tile_table"
+#define TILE_TABLE_BINDING 15
+
+#define COLOR_TEX_ARRAY_NAME "color_tex_array"
+#define COLOR_TEX_ARRAY_BINDING 16
+
+#define ELEVATION_TEX_ARRAY_NAME "elevation_tex_array"
+#define ELEVATION_TEX_ARRAY_BINDING 17
+
 #define ATTR_VERTEX "in_vertex"
 #define ATTR_NORMAL "in_normal"
 #define ATTR_UV "in_uvw"
 #define ATTR_VERTEX_NEIGHBOR "in_vertex_neighbor"
 #define ATTR_NORMAL_NEIGHBOR "in_normal_neighbor"
+#define ATTR_TILE "in_tile"
 
 using namespace ROCKY_NAMESPACE;
 
@@ -67,11 +82,11 @@ TerrainState::createDefaultDescriptors()
 
     // color channel
     // TODO: more than one - make this an array?
-    // TODO: activate mipmapping
+    // Tiles encoded on the loader threads carry their own mipmaps (see TextureEncoder).
     texturedefs.color = { COLOR_TEX_NAME, COLOR_TEX_BINDING, vsg::Sampler::create(), {} };
     texturedefs.color.sampler->minFilter = VK_FILTER_LINEAR;
     texturedefs.color.sampler->magFilter = VK_FILTER_LINEAR;
-    texturedefs.color.sampler->maxLod = 5;
+    texturedefs.color.sampler->maxLod = 16;
     texturedefs.color.sampler->mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
     texturedefs.color.sampler->addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
     texturedefs.color.sampler->addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
@@ -133,6 +148,28 @@ TerrainState::createDefaultDescriptors()
         texturedefs.normal.uniform_binding,
         0, // array element
         VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+
+    // Terrain-wide uniforms; one buffer shared by every tile's descriptor set.
+    _terrainData = vsg::ubyteArray::create(sizeof(TerrainUniforms));
+
+    // tells VSG that the contents can change, and if they do, the data should be
+    // transfered to the GPU before or during recording.
+    _terrainData->properties.dataVariance = vsg::DYNAMIC_DATA;
+    memset(_terrainData->dataPointer(), 0, sizeof(TerrainUniforms));
+    this->terrainUniforms = vsg::DescriptorBuffer::create(_terrainData, TERRAIN_BUFFER_BINDING);
+}
+
+void
+TerrainState::updateTerrainUniforms(const TerrainSettings& settings)
+{
+    auto& uniforms = *static_cast<TerrainUniforms*>(_terrainData->dataPointer());
+
+    float pixels = settings.tilePixelSize.value() + settings.screenSpaceError.value();
+    if (uniforms.lod_pixels != pixels)
+    {
+        uniforms.lod_pixels = pixels;
+        _terrainData->dirty();
+    }
 }
 
 vsg::ref_ptr<vsg::ShaderSet>
@@ -178,14 +215,21 @@ TerrainState::createShaderSet() const
     shaderSet->addAttributeBinding(ATTR_VERTEX, "", 0, VK_FORMAT_R32G32B32_SFLOAT, vsg::vec3Array::create(1));
     shaderSet->addAttributeBinding(ATTR_NORMAL, "", 1, VK_FORMAT_R32G32B32_SFLOAT, vsg::vec3Array::create(1));
     shaderSet->addAttributeBinding(ATTR_UV, "", 2, VK_FORMAT_R32G32B32_SFLOAT, vsg::vec3Array::create(1));
-    //shaderSet->addAttributeBinding(ATTR_VERTEX_NEIGHBOR, "", 3, VK_FORMAT_R32G32B32A32_SFLOAT, vsg::vec3Array::create(1));
-    //shaderSet->addAttributeBinding(ATTR_NORMAL_NEIGHBOR, "", 4, VK_FORMAT_R32G32B32A32_SFLOAT, vsg::vec3Array::create(1));
+    shaderSet->addAttributeBinding(ATTR_VERTEX_NEIGHBOR, "ROCKY_MORPHING", 3, VK_FORMAT_R32G32B32_SFLOAT, vsg::vec3Array::create(1));
+    shaderSet->addAttributeBinding(ATTR_NORMAL_NEIGHBOR, "ROCKY_MORPHING", 4, VK_FORMAT_R32G32B32_SFLOAT, vsg::vec3Array::create(1));
 
     // "binding" (4th param) must match "layout(location=X) uniform" in the shader
     shaderSet->addDescriptorBinding(texturedefs.elevation.name, "", 0, texturedefs.elevation.uniform_binding, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_VERTEX_BIT, {});
     shaderSet->addDescriptorBinding(texturedefs.color.name, "", 0, texturedefs.color.uniform_binding, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, {});
     shaderSet->addDescriptorBinding(texturedefs.normal.name, "", 0, texturedefs.normal.uniform_binding, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, {});
     shaderSet->addDescriptorBinding(TILE_BUFFER_NAME, "", 0, TILE_BUFFER_BINDING, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, {});
+    shaderSet->addDescriptorBinding(TERRAIN_BUFFER_NAME, "", 0, TERRAIN_BUFFER_BINDING, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, {});
+
+    // drawing indirect, tiles index into arrays instead (see TerrainDrawBatch)
+    shaderSet->addAttributeBinding(ATTR_TILE, "ROCKY_INDIRECT", 5, VK_FORMAT_R32G32B32A32_SFLOAT, vsg::vec4Array::create(1));
+    shaderSet->addDescriptorBinding(TILE_TABLE_NAME, "ROCKY_INDIRECT", 0, TILE_TABLE_BINDING, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, {});
+    shaderSet->addDescriptorBinding(COLOR_TEX_ARRAY_NAME, "ROCKY_INDIRECT", 0, COLOR_TEX_ARRAY_BINDING, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, tileTableSize, VK_SHADER_STAGE_FRAGMENT_BIT, {});
+    shaderSet->addDescriptorBinding(ELEVATION_TEX_ARRAY_NAME, "ROCKY_INDIRECT", 0, ELEVATION_TEX_ARRAY_BINDING, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, tileTableSize, VK_SHADER_STAGE_VERTEX_BIT, {});
     
     PipelineUtils::addViewDependentData(shaderSet, VK_SHADER_STAGE_FRAGMENT_BIT);
 
@@ -198,7 +242,7 @@ TerrainState::createShaderSet() const
 
 
 vsg::ref_ptr<vsg::GraphicsPipelineConfig>
-TerrainState::createPipelineConfig() const
+TerrainState::createPipelineConfig(const TerrainSettings& settings) const
 {
     ROCKY_SOFT_ASSERT_AND_RETURN(status.ok(), {});
 
@@ -214,20 +258,42 @@ TerrainState::createPipelineConfig() const
     config->enableArray(ATTR_NORMAL, VK_VERTEX_INPUT_RATE_VERTEX, 12);
     config->enableArray(ATTR_UV, VK_VERTEX_INPUT_RATE_VERTEX, 12);
 
-    // Temporary decriptors that we will use to set up the PipelineConfig.
-    // Note, we only use these for setup, and then throw them away!
-    // The ACTUAL descriptors we will make on a tile-by-tile basis.
+    // morph targets (see GeometryPool); enabling them defines ROCKY_MORPHING
+    if (settings.morphTerrain == true && (settings.tileSize.value() & 0x1) == 1)
+    {
+        config->enableArray(ATTR_VERTEX_NEIGHBOR, VK_VERTEX_INPUT_RATE_VERTEX, 12);
+        config->enableArray(ATTR_NORMAL_NEIGHBOR, VK_VERTEX_INPUT_RATE_VERTEX, 12);
+    }
+
+    if (indirect)
+    {
+        // tile origin and tile table slot, one per draw; enabling it
+        // (and the tables) defines ROCKY_INDIRECT. Keep this array last.
+        config->enableArray(ATTR_TILE, VK_VERTEX_INPUT_RATE_INSTANCE, 16);
+
+        config->enableDescriptor(TILE_TABLE_NAME);
+        config->enableTexture(COLOR_TEX_ARRAY_NAME);
+        config->enableTexture(ELEVATION_TEX_ARRAY_NAME);
+    }
+    else
+    {
+        // Temporary decriptors that we will use to set up the PipelineConfig.
+        // Note, we only use these for setup, and then throw them away!
+        // The ACTUAL descriptors we will make on a tile-by-tile basis.
 #if 0
-    config->assignTexture(textures.elevation.name, textures.elevation.defaultData, textures.elevation.sampler);
-    config->assignTexture(textures.color.name, textures.color.defaultData, textures.color.sampler);
-    config->assignTexture(textures.normal.name, textures.normal.defaultData, textures.normal.sampler);
+        config->assignTexture(textures.elevation.name, textures.elevation.defaultData, textures.elevation.sampler);
+        config->assignTexture(textures.color.name, textures.color.defaultData, textures.color.sampler);
+        config->assignTexture(textures.normal.name, textures.normal.defaultData, textures.normal.sampler);
 #else
-    config->enableTexture(texturedefs.elevation.name);
-    config->enableTexture(texturedefs.color.name);
-    config->enableTexture(texturedefs.normal.name);
+        config->enableTexture(texturedefs.elevation.name);
+        config->enableTexture(texturedefs.color.name);
+        config->enableTexture(texturedefs.normal.name);
 #endif
 
-    config->enableDescriptor(TILE_BUFFER_NAME);
+        config->enableDescriptor(TILE_BUFFER_NAME);
+    }
+
+    config->enableDescriptor(TERRAIN_BUFFER_NAME);
 
     PipelineUtils::enableViewDependentData(config);
 
@@ -241,12 +307,24 @@ TerrainState::createPipelineConfig() const
 }
 
 vsg::ref_ptr<vsg::StateGroup>
-TerrainState::createTerrainStateGroup()
+TerrainState::createTerrainStateGroup(const TerrainSettings& settings)
 {
     ROCKY_SOFT_ASSERT_AND_RETURN(status.ok(), { });
 
+    updateTerrainUniforms(settings);
+
+    indirect = false;
+    if (settings.multiDrawIndirect == true)
+    {
+        indirect = supportsIndirect();
+        if (!indirect)
+        {
+            Log()->warn("Terrain: GPU cannot index {} textures per shader; drawing tiles individually", tileTableSize);
+        }
+    }
+
     // create the configurator object:
-    pipelineConfig = createPipelineConfig();
+    pipelineConfig = createPipelineConfig(settings);
 
     ROCKY_SOFT_ASSERT_AND_RETURN(pipelineConfig, { });
 
@@ -257,12 +335,195 @@ TerrainState::createTerrainStateGroup()
     stateGroup->add(pipelineConfig->bindGraphicsPipeline);
     stateGroup->add(PipelineUtils::createViewDependentBindCommand(pipelineConfig));
 
+    if (indirect)
+    {
+        // the instance array is the last one enabled
+        instanceBinding = (std::uint32_t)pipelineConfig->vertexInputState->vertexBindingDescriptions.size() - 1;
+
+        _tileTable = std::make_shared<TileTable>();
+        _tileTable->defaultColor = defaultTileDescriptors.color->imageInfoList.front();
+        _tileTable->defaultElevation = defaultTileDescriptors.elevation->imageInfoList.front();
+        _tileTable->color.assign(tileTableSize, _tileTable->defaultColor);
+        _tileTable->elevation.assign(tileTableSize, _tileTable->defaultElevation);
+
+        // hand out low slots first
+        for (std::uint32_t i = 0; i < tileTableSize; ++i)
+            _tileTable->freeList.push_back(tileTableSize - 1 - i);
+
+        auto size = tileTableSize * sizeof(TerrainTileDescriptors::Uniforms);
+        _tileTable->uniforms = vsg::ubyteArray::create(size);
+        _tileTable->uniforms->properties.dataVariance = vsg::DYNAMIC_DATA;
+        memset(_tileTable->uniforms->dataPointer(), 0, size);
+
+        _tileTableUniforms = vsg::DescriptorBuffer::create(
+            _tileTable->uniforms, TILE_TABLE_BINDING, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+
+        // With every tile's descriptors in one set, the set binds here and
+        // not on each tile.
+        _tileTableBind = createTileTableBind(_tileTable->color, _tileTable->elevation);
+        stateGroup->add(_tileTableBind);
+    }
+
+    _stateGroup = stateGroup;
+
     return stateGroup;
 }
 
+bool
+TerrainState::supportsIndirect()
+{
+    if (!_runtime.viewer || _runtime.viewer->windows().empty())
+        return false;
+
+    auto device = _runtime.viewer->windows().front()->getOrCreateDevice();
+    if (!device)
+        return false;
+
+    auto physicalDevice = device->getPhysicalDevice();
+
+    VkPhysicalDeviceFeatures features;
+    vkGetPhysicalDeviceFeatures(physicalDevice->vk(), &features);
+
+    // each stage indexes one array of tile textures (colors in the fragment
+    // shader, elevations in the vertex shader), plus a few other samplers.
+    const auto& limits = physicalDevice->getProperties().limits;
+    const std::uint32_t samplers = tileTableSize + 16;
+
+    if (!features.shaderSampledImageArrayDynamicIndexing ||
+        limits.maxPerStageDescriptorSamplers < samplers ||
+        limits.maxPerStageDescriptorSampledImages < samplers ||
+        limits.maxDescriptorSetSamplers < 2 * samplers ||
+        limits.maxDescriptorSetSampledImages < 2 * samplers)
+    {
+        return false;
+    }
+
+    // DisplayManager enables these features when the device has them
+    multiDraw = features.multiDrawIndirect && features.drawIndirectFirstInstance;
+
+    return true;
+}
+
+vsg::ref_ptr<vsg::BindDescriptorSet>
+TerrainState::createTileTableBind(const vsg::ImageInfoList& color, const vsg::ImageInfoList& elevation) const
+{
+    auto colors = vsg::DescriptorImage::create(
+        color, COLOR_TEX_ARRAY_BINDING, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+
+    auto elevations = vsg::DescriptorImage::create(
+        elevation, ELEVATION_TEX_ARRAY_BINDING, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+
+    auto descriptorSet = vsg::DescriptorSet::create(
+        pipelineConfig->layout->setLayouts.front(),
+        vsg::Descriptors{ _tileTableUniforms, colors, elevations, terrainUniforms });
+
+    return vsg::BindDescriptorSet::create(
+        VK_PIPELINE_BIND_POINT_GRAPHICS,
+        pipelineConfig->layout,
+        0, // first set
+        descriptorSet);
+}
+
+std::shared_ptr<const std::uint32_t>
+TerrainState::allocateTileIndex()
+{
+    ROCKY_SOFT_ASSERT_AND_RETURN(indirect && _tileTable, {});
+
+    std::scoped_lock lock(_tileTable->mutex);
+
+    if (_tileTable->freeList.empty())
+    {
+        if (!_tileTable->warnedFull)
+        {
+            Log()->warn("Terrain tile table is full ({} tiles); some tiles will not draw", tileTableSize);
+            _tileTable->warnedFull = true;
+        }
+        return {};
+    }
+
+    auto index = _tileTable->freeList.back();
+    _tileTable->freeList.pop_back();
+
+    std::weak_ptr<TileTable> table_weak = _tileTable;
+
+    return std::shared_ptr<const std::uint32_t>(
+        new std::uint32_t(index),
+        [table_weak](const std::uint32_t* p)
+        {
+            auto table = table_weak.lock();
+            if (table)
+                table->release(*p);
+            delete p;
+        });
+}
+
+std::uint32_t
+TerrainState::freeTileIndices() const
+{
+    if (!_tileTable)
+        return 0;
+
+    std::scoped_lock lock(_tileTable->mutex);
+    return (std::uint32_t)_tileTable->freeList.size();
+}
+
+void
+TerrainState::TileTable::release(std::uint32_t index)
+{
+    std::scoped_lock lock(mutex);
+
+    // let go of the textures; the bound descriptor set keeps them alive
+    // until the next update replaces it
+    color[index] = defaultColor;
+    elevation[index] = defaultElevation;
+    texturesChanged = true;
+
+    freeList.push_back(index);
+}
+
+void
+TerrainState::updateTileTable(Runtime& runtime)
+{
+    ROCKY_SOFT_ASSERT_AND_RETURN(indirect && _tileTable && _stateGroup, void());
+
+    vsg::ImageInfoList color, elevation;
+    {
+        std::scoped_lock lock(_tileTable->mutex);
+
+        if (_tileTable->uniformsChanged)
+        {
+            _tileTable->uniforms->dirty();
+            _tileTable->uniformsChanged = false;
+        }
+
+        if (!_tileTable->texturesChanged)
+            return;
+
+        color = _tileTable->color;
+        elevation = _tileTable->elevation;
+        _tileTable->texturesChanged = false;
+    }
+
+    // Descriptor sets in flight are immutable, so a change to any tile's
+    // textures means a new set. Compiling it uploads the new textures.
+    auto bind = createTileTableBind(color, elevation);
+    runtime.compile(bind);
+
+    for (auto& command : _stateGroup->stateCommands)
+    {
+        if (command == _tileTableBind)
+        {
+            runtime.dispose(command);
+            command = bind;
+        }
+    }
+
+    _tileTableBind = bind;
+}
+
 void
 TerrainState::updateTerrainTileDescriptors(
-    const TerrainTileRenderModel& renderModel,
+    TerrainTileRenderModel& renderModel,
     vsg::ref_ptr<vsg::StateGroup> stategroup,
     Runtime& runtime) const
 {
@@ -276,15 +537,24 @@ TerrainState::updateTerrainTileDescriptors(
     // copy the existing one:
     TerrainTileDescriptors dm = renderModel.descriptors;
 
-    if (renderModel.color.image)
+    if (renderModel.color.encodedTexture && !renderModel.color.encoded)
+    {
+        // the encoded texture is already on the GPU (perhaps via the parent),
+        // and its CPU copy is gone, so share it rather than uploading again
+        dm.color = renderModel.color.encodedTexture;
+    }
+    else if (renderModel.color.image)
     {
-        auto data = util::moveImageToVSG(renderModel.color.image->clone());
+        // use the pre-encoded texture if the loader made one
+        auto data = renderModel.color.encoded ?
+            renderModel.color.encoded :
+            util::shareImageWithVSG(renderModel.color.image);
         if (data)
         {
             // queue the old data for safe disposal
             runtime.dispose(dm.color);
 
-            // tell vsg to remove the image from CPU memory after sending it to the GPU
+            // tell vsg to release its reference to the image after sending it to the GPU
             data->properties.dataVariance = vsg::STATIC_DATA_UNREF_AFTER_TRANSFER;
 
             dm.color = vsg::DescriptorImage::create(
@@ -295,18 +565,25 @@ TerrainState::updateTerrainTileDescriptors(
                 VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
 
             dm.color->setValue("name", renderModel.color.name);
+
+            // keep the uploaded texture and let the CPU copy go after transfer
+            if (renderModel.color.encoded)
+            {
+                renderModel.color.encodedTexture = dm.color;
+                renderModel.color.encoded = nullptr;
+            }
         }
     }
 
     if (renderModel.elevation.image)
     {
-        auto data = util::moveImageToVSG(renderModel.elevation.image->clone());
+        auto data = util::shareImageWithVSG(renderModel.elevation.image);
         if (data)
         {
             // queue the old data for safe disposal
             runtime.dispose(dm.elevation);
 
-            // tell vsg to remove the image from CPU memory after sending it to the GPU
+            // tell vsg to release its reference to the image after sending it to the GPU
             data->properties.dataVariance = vsg::STATIC_DATA_UNREF_AFTER_TRANSFER;
 
             dm.elevation = vsg::DescriptorImage::create(
@@ -322,13 +599,13 @@ TerrainState::updateTerrainTileDescriptors(
 
     if (renderModel.normal.image)
     {
-        auto data = util::moveImageToVSG(renderModel.normal.image->clone());
+        auto data = util::shareImageWithVSG(renderModel.normal.image);
         if (data)
         {
             // queue the old data for safe disposal
             runtime.dispose(dm.normal);
 
-            // tell vsg to remove the image from CPU memory after sending it to the GPU
+            // tell vsg to release its reference to the image after sending it to the GPU
             data->properties.dataVariance = vsg::STATIC_DATA_UNREF_AFTER_TRANSFER;
 
             dm.normal = vsg::DescriptorImage::create(
@@ -347,7 +624,38 @@ TerrainState::updateTerrainTileDescriptors(
     uniforms.elevation_matrix = renderModel.elevation.matrix;
     uniforms.color_matrix = renderModel.color.matrix;
     uniforms.normal_matrix = renderModel.normal.matrix;
-    uniforms.model_matrix = renderModel.modelMatrix;    
+    uniforms.model_matrix = renderModel.modelMatrix;
+    uniforms.morph = renderModel.morph;
+
+    // a quantized heightfield uploads as R16_UNORM; the shader rescales
+    // the normalized texel back to meters.
+    auto hf = Heightfield::cast_from(renderModel.elevation.image.get());
+    if (hf && hf->quantized())
+    {
+        uniforms.elevation_decode = {
+            hf->quantizationScale() * (float)std::numeric_limits<std::uint16_t>::max(),
+            hf->quantizationOffset(), 0.0f, 0.0f };
+    }
+
+    if (indirect)
+    {
+        // Drawing indirect, the tile's entry in the tile table stands in for
+        // its own descriptor set; updateTileTable() pushes it to the GPU.
+        if (renderModel.descriptors.tableIndex)
+        {
+            auto index = *renderModel.descriptors.tableIndex;
+
+            std::scoped_lock lock(_tileTable->mutex);
+            _tileTable->color[index] = dm.color->imageInfoList.front();
+            _tileTable->elevation[index] = dm.elevation->imageInfoList.front();
+            _tileTable->texturesChanged = true;
+
+            auto* ptr = _tileTable->uniforms->dataPointer(index * sizeof(uniforms));
+            memcpy(ptr, &uniforms, sizeof(uniforms));
+            _tileTable->uniformsChanged = true;
+        }
+        return;
+    }
 
     vsg::ref_ptr<vsg::ubyteArray> data = vsg::ubyteArray::create(sizeof(uniforms));
     memcpy(data->dataPointer(), &uniforms, sizeof(uniforms));
@@ -358,7 +666,7 @@ TerrainState::updateTerrainTileDescriptors(
 
     auto descriptorSet = vsg::DescriptorSet::create(
         descriptorSetLayout,
-        vsg::Descriptors{ dm.elevation, dm.color, dm.normal, dm.uniforms }
+        vsg::Descriptors{ dm.elevation, dm.color, dm.normal, dm.uniforms, terrainUniforms }
     );
     //if (sharedObjects) sharedObjects->share(descriptorSet);
 
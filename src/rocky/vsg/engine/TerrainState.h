@@ -13,10 +13,13 @@
 #include <vsg/utils/ShaderSet.h>
 #include <vsg/utils/SharedObjects.h>
 #include <vsg/nodes/StateGroup.h>
+#include <vsg/state/BindDescriptorSet.h>
+#include <mutex>
 
 namespace ROCKY_NAMESPACE
 {
     class Runtime;
+    class TerrainSettings;
     class TerrainTileNode;
     class TerrainTileRenderModel;
 
@@ -37,11 +40,30 @@ namespace ROCKY_NAMESPACE
         TerrainState(Runtime&);
 
         //! Creates a state group for rendering terrain
-        vsg::ref_ptr<vsg::StateGroup> createTerrainStateGroup();
+        vsg::ref_ptr<vsg::StateGroup> createTerrainStateGroup(
+            const TerrainSettings& settings);
+
+        //! Pushes settings that affect all tiles to the GPU, if they changed.
+        //! Call once per frame.
+        void updateTerrainUniforms(
+            const TerrainSettings& settings);
+
+        //! Pushes changes to the tile table to the GPU, if any.
+        //! Call once per frame when drawing indirect.
+        void updateTileTable(
+            Runtime& runtime);
+
+        //! Reserves a slot in the tile table. The slot frees itself
+        //! when the last copy of the handle goes away.
+        //! @return Slot handle, or nullptr if the table is full
+        std::shared_ptr<const std::uint32_t> allocateTileIndex();
+
+        //! Number of unused slots in the tile table
+        std::uint32_t freeTileIndices() const;
 
         //! Creates a state group for rendering a specific terrain tile
         void updateTerrainTileDescriptors(
-            const TerrainTileRenderModel& renderModel,
+            TerrainTileRenderModel& renderModel,
             vsg::ref_ptr<vsg::StateGroup> stategroup,
             Runtime& runtime) const;
 
@@ -63,6 +85,32 @@ namespace ROCKY_NAMESPACE
         //! Terrain tiles copy and use this until new data becomes available.
         TerrainTileDescriptors defaultTileDescriptors;
 
+        //! Terrain-wide uniforms, shared by the descriptor sets of all tiles
+        struct TerrainUniforms
+        {
+            float lod_pixels;  // tile pixel size + screen space error
+            float padding[3];
+        };
+
+        //! Buffer holding the TerrainUniforms
+        vsg::ref_ptr<vsg::DescriptorBuffer> terrainUniforms;
+
+        //! Whether tiles draw indirect, through the tile table, instead of
+        //! binding their own descriptors (see TerrainSettings::multiDrawIndirect).
+        //! Set by createTerrainStateGroup.
+        bool indirect = false;
+
+        //! Whether the device can draw many tiles with one indirect call;
+        //! if not, indirect tiles draw one at a time
+        bool multiDraw = false;
+
+        //! Vertex binding of the per-draw instance array when drawing indirect
+        std::uint32_t instanceBinding = 0;
+
+        //! Number of tiles the tile table holds.
+        //! Must match TILE_TABLE_SIZE in the terrain shaders.
+        static constexpr std::uint32_t tileTableSize = 2048;
+
     protected:
 
         //! Creates all the default texture information,
@@ -77,7 +125,8 @@ namespace ROCKY_NAMESPACE
         //! The configurator does not contain any ACTUAL decriptors (like
         //! textures and uniforms) but rather just prepares the ShaderSet
         //! to work with the specific decriptors you PLAN to provide.
-        vsg::ref_ptr<vsg::GraphicsPipelineConfig> createPipelineConfig() const;
+        vsg::ref_ptr<vsg::GraphicsPipelineConfig> createPipelineConfig(
+            const TerrainSettings& settings) const;
 
         //! Defines a single texutre and its (possible shared) sampler
         struct TextureDef
@@ -105,6 +154,37 @@ namespace ROCKY_NAMESPACE
         }
         texturedefs;
 
+        //! Whether the device supports drawing through the tile table
+        bool supportsIndirect();
+
+        //! Builds the descriptor set that binds the whole tile table
+        vsg::ref_ptr<vsg::BindDescriptorSet> createTileTableBind(
+            const vsg::ImageInfoList& color,
+            const vsg::ImageInfoList& elevation) const;
+
+        //! Textures and uniforms of every tile, indexed by tile table slot.
+        //! Shared with the slot handles, which return their slots on release.
+        struct TileTable
+        {
+            mutable std::mutex mutex;
+            std::vector<std::uint32_t> freeList;
+            vsg::ImageInfoList color;
+            vsg::ImageInfoList elevation;
+            vsg::ref_ptr<vsg::ImageInfo> defaultColor;
+            vsg::ref_ptr<vsg::ImageInfo> defaultElevation;
+            vsg::ref_ptr<vsg::ubyteArray> uniforms;
+            bool texturesChanged = false;
+            bool uniformsChanged = false;
+            bool warnedFull = false;
+
+            void release(std::uint32_t index);
+        };
+        std::shared_ptr<TileTable> _tileTable;
+        vsg::ref_ptr<vsg::DescriptorBuffer> _tileTableUniforms;
+        vsg::ref_ptr<vsg::BindDescriptorSet> _tileTableBind;
+        vsg::ref_ptr<vsg::StateGroup> _stateGroup;
+
         Runtime& _runtime;
+        vsg::ref_ptr<vsg::ubyteArray> _terrainData;
     };
 }
@@ -25,7 +25,23 @@ namespace ROCKY_NAMESPACE
             const TerrainTileNode* parent,
             vsg::RecordTraversal& t) = 0;
 
+        //! Lets the host draw a visible tile itself, for example in a batch
+        //! with the others.
+        //! @return false to draw the tile normally
+        virtual bool draw(
+            const TerrainTileNode* tile,
+            vsg::RecordTraversal& t) {
+            return false;
+        }
+
         //! Access terrain settings.
         virtual const TerrainSettings& settings() = 0;
+
+        //! Where the camera is expected to be shortly (world coordinates),
+        //! so tiles can prefetch what they will need.
+        //! @return false if there's no prediction
+        virtual bool predictedEye(vsg::dvec3& out) const {
+            return false;
+        }
     };
 }
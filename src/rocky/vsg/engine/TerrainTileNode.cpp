@@ -40,6 +40,16 @@ namespace
         glm::dmat4(0.5,0,0,0, 0,0.5,0,0, 0,0,1.0,0, 0.0,0.0,0,1.0),
         glm::dmat4(0.5,0,0,0, 0,0.5,0,0, 0,0,1.0,0, 0.5,0.0,0,1.0)
     }; 
+
+    template<class MODEL>
+    auto& textureData(MODEL& model, TextureType type)
+    {
+        return
+            type == COLOR ? model.color :
+            type == COLOR_PARENT ? model.colorParent :
+            type == ELEVATION ? model.elevation :
+            model.normal;
+    }
 }
 
 TerrainTileNode::TerrainTileNode(
@@ -110,13 +120,51 @@ TerrainTileNode::setElevation(shared_ptr<Image> image, const glm::dmat4& matrix)
     }
 }
 
+vsg::ref_ptr<vsg::Node>
+TerrainTileNode::setGeometry(vsg::ref_ptr<vsg::Node> geometry)
+{
+    ROCKY_SOFT_ASSERT_AND_RETURN(geometry && stategroup && !stategroup->children.empty(), {});
+
+    auto old = stategroup->children.front();
+    stategroup->children.front() = geometry;
+
+    if (surface)
+    {
+        surface->dirtyBound();
+        recomputeBound();
+    }
+
+    return old;
+}
+
 bool
-TerrainTileNode::shouldSubDivide(vsg::State* state) const
+TerrainTileNode::shouldSubDivide(vsg::State* state, const vsg::dvec3* eye) const
 {
     auto& vp = state->_commandBuffer->viewDependentState->viewportData->at(0);
     auto min_screen_height_ratio = (_host->settings().tilePixelSize + _host->settings().screenSpaceError) / vp[3];
     auto d = state->lodDistance(bound);
-    return (d > 0.0) && (bound.r > (d * min_screen_height_ratio));
+    if (d < 0.0)
+        return false;
+
+    // from another eye position, scale the LOD distance by the change in range
+    if (eye)
+    {
+        d *= vsg::length(bound.center - *eye) / std::max((double)distanceTo(bound.center, state), 1.0);
+    }
+
+    // VSG's LOD distance is the view depth divided by this scale (see vsg::State).
+    // Measure from the nearest point of the tile, and use a range shared by all tiles
+    // at this LOD: the terrain vertex shader morphs each vertex with the same metric,
+    // so a tile has fully morphed into its parent by the time the parent stops
+    // subdividing, and a tile bordering a coarser neighbor has fully morphed along
+    // the shared edge.
+    auto& proj = state->projectionMatrixStack.top();
+    auto& mv = state->modelviewMatrixStack.top();
+    double scale = std::abs(proj[1][1]) * 0.5 * std::sqrt(
+        mv[0][0] * mv[0][0] + mv[1][0] * mv[1][0] + mv[2][0] * mv[2][0] +
+        mv[0][1] * mv[0][1] + mv[1][1] * mv[1][1] + mv[2][1] * mv[2][1]);
+
+    return shouldSubDivide(d, scale, min_screen_height_ratio);
 
     // TODO: someday, when we support orthographic cameras, look at this approach 
     // that would theoritically keep the same LOD across the visible scene:
@@ -124,6 +172,15 @@ TerrainTileNode::shouldSubDivide(vsg::State* state) const
     //return (d > 0.0) && (tile_height > (d * min_screen_height_ratio));
 }
 
+bool
+TerrainTileNode::shouldSubDivide(double lodDistance, double lodScale, double minScreenHeightRatio) const
+{
+    auto d_near = lodDistance - bound.r / std::max(lodScale, 1e-9);
+    double range = lodRange > 0.0f ? (double)lodRange : bound.r;
+
+    return range > (d_near * minScreenHeightRatio);
+}
+
 void
 TerrainTileNode::accept(vsg::RecordTraversal& rv) const
 {
@@ -167,12 +224,34 @@ TerrainTileNode::accept(vsg::RecordTraversal& rv) const
         else
         {
             // children do not exist or are out of range; use this tile's geometry
-            children[0]->accept(rv);
+            if (!host->draw(this, rv))
+                children[0]->accept(rv);
 
             if (subtilesInRange && subtilesLoader.empty())
             {
                 _needsSubtiles = true;
             }
+
+            // prefetch: if we will need the subtiles soon, create them now and
+            // ping them so they load (at low priority, since they are not in view)
+            else if (!subtilesInRange)
+            {
+                vsg::dvec3 eye;
+                if (host->predictedEye(eye) && shouldSubDivide(rv.getState(), &eye))
+                {
+                    if (subtilesExist())
+                    {
+                        host->ping(subTile(0), this, rv);
+                        host->ping(subTile(1), this, rv);
+                        host->ping(subTile(2), this, rv);
+                        host->ping(subTile(3), this, rv);
+                    }
+                    else if (subtilesLoader.empty())
+                    {
+                        _needsSubtiles = true;
+                    }
+                }
+            }
         }
     }
 
@@ -195,6 +274,44 @@ TerrainTileNode::accept(vsg::RecordTraversal& rv) const
     }
 }
 
+bool
+TerrainTileNode::intersect(const vsg::dvec3& start, const vsg::dvec3& end, double& inout_ratio) const
+{
+    if (!surface)
+        return false;
+
+    // reject if the segment misses the bounding sphere, or only reaches it
+    // beyond the closest hit so far.
+    auto& bs = surface->worldBoundingSphere;
+    vsg::dvec3 d = end - start;
+    vsg::dvec3 m = start - bs.center;
+    double a = vsg::dot(d, d);
+    double b = vsg::dot(m, d);
+    double c = vsg::dot(m, m) - bs.radius * bs.radius;
+    double disc = b * b - a * c;
+    if (a <= 0.0 || disc < 0.0)
+        return false;
+
+    double sqrt_disc = sqrt(disc);
+    double t_enter = (-b - sqrt_disc) / a;
+    double t_exit = (-b + sqrt_disc) / a;
+    if (t_exit < 0.0 || t_enter > inout_ratio)
+        return false;
+
+    if (subtilesExist())
+    {
+        bool hit = false;
+        for (unsigned q = 0; q < 4; ++q)
+        {
+            if (subTile(q)->intersect(start, end, inout_ratio))
+                hit = true;
+        }
+        return hit;
+    }
+
+    return surface->intersect(start, end, inout_ratio);
+}
+
 void
 TerrainTileNode::unloadSubtiles(Runtime& runtime)
 {
@@ -224,3 +341,25 @@ TerrainTileNode::inheritFrom(vsg::ref_ptr<TerrainTileNode> parent)
         setElevation(renderModel.elevation.image, renderModel.elevation.matrix);
     }
 }
+
+void
+TerrainTileNode::inheritTexture(TextureType type, const TerrainTileNode* parent)
+{
+    auto& texture = textureData(renderModel, type);
+
+    if (parent)
+    {
+        texture = textureData(parent->renderModel, type);
+        if (texture.image)
+            texture.matrix *= scaleBias[key.getQuadrant()];
+    }
+    else
+    {
+        texture = { };
+    }
+
+    if (type == ELEVATION)
+    {
+        setElevation(renderModel.elevation.image, renderModel.elevation.matrix);
+    }
+}
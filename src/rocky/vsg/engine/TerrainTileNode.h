@@ -35,6 +35,21 @@ namespace ROCKY_NAMESPACE
         std::string name;
         shared_ptr<Image> image;
         glm::dmat4 matrix{ 1 };
+        vsg::ref_ptr<vsg::Data> encoded; // GPU-ready copy of image (mipmapped/compressed), released once uploaded
+        vsg::ref_ptr<vsg::DescriptorImage> encodedTexture; // the uploaded encoded copy, shared with inheriting tiles
+        std::size_t encodedBytes = 0; // GPU size of the encoded copy
+    };
+
+    //! Data loaded in the background for a tile, ready to merge
+    struct TerrainTileData
+    {
+        TerrainTileModel model;
+        mutable vsg::ref_ptr<vsg::Data> encodedColor; // handed off to the render model at merge
+        vsg::ref_ptr<vsg::Node> geometry; // adaptive mesh fit to the elevation, optional
+        CreateTileManifest manifest; // layers (and their revisions) the data came from
+        bool color = true;           // whether the load covers the color layers
+        bool elevation = true;       // whether the load covers the elevation layers
+        bool refresh = false;        // whether the load replaces data the tile already had
     };
 
     enum TextureType
@@ -54,18 +69,26 @@ namespace ROCKY_NAMESPACE
             glm::fmat4 color_matrix;
             glm::fmat4 normal_matrix;
             glm::fmat4 model_matrix;
+            glm::fvec4 morph; // start range, end range, uv step, unused
+            glm::fvec4 elevation_decode{ 1, 0, 0, 0 }; // texel scale, offset, unused, unused
         };
         vsg::ref_ptr<vsg::DescriptorImage> color;
         vsg::ref_ptr<vsg::DescriptorImage> colorParent;
         vsg::ref_ptr<vsg::DescriptorImage> elevation;
         vsg::ref_ptr<vsg::DescriptorImage> normal;
         vsg::ref_ptr<vsg::DescriptorBuffer> uniforms;
+
+        //! Slot in the tile table when drawing indirect (see TerrainState);
+        //! frees itself when released
+        std::shared_ptr<const std::uint32_t> tableIndex;
     };
 
     class TerrainTileRenderModel
     {
     public:
         glm::fmat4 modelMatrix;
+        glm::dvec3 origin{ 0.0 }; // translation of modelMatrix at full precision
+        glm::fvec4 morph{ 0.0f }; // see TerrainTileDescriptors::Uniforms
         TextureData color;
         TextureData elevation;
         TextureData normal;
@@ -99,12 +122,24 @@ namespace ROCKY_NAMESPACE
         Revision revision;
         unsigned numLODs;
         TerrainTileRenderModel renderModel;
+
+        //! Layers changed since this tile's data loaded; reload them
+        bool refreshColor = false;
+        bool refreshElevation = false;
+
+        //! Size that decides when this tile subdivides, the same for every tile
+        //! at this LOD (see TerrainTilePager::getRange); 0 = use the bound radius.
+        float lodRange = 0.0f;
+
+        //! Handle of this tile's slot in the pager (0 = not registered).
+        //! Written during update, read during record.
+        std::uint64_t pagerHandle = 0;
         
         vsg::ref_ptr<SurfaceNode> surface;
         vsg::ref_ptr<vsg::StateGroup> stategroup;
         
         mutable jobs::future<bool> subtilesLoader;
-        mutable jobs::future<TerrainTileModel> dataLoader;
+        mutable jobs::future<TerrainTileData> dataLoader;
         mutable jobs::future<bool> dataMerger;
         mutable std::atomic<uint64_t> lastTraversalFrame;
         mutable std::atomic<vsg::time_point> lastTraversalTime;
@@ -128,6 +163,16 @@ namespace ROCKY_NAMESPACE
             shared_ptr<Image> image,
             const glm::dmat4& matrix);
 
+        //! Surface geometry this tile renders
+        vsg::ref_ptr<vsg::Node> getGeometry() const {
+            return stategroup->children.front();
+        }
+
+        //! Replace the surface geometry (and recompute the bounds to match).
+        //! @return The geometry it replaced
+        vsg::ref_ptr<vsg::Node> setGeometry(
+            vsg::ref_ptr<vsg::Node> geometry);
+
         //! This node's elevation raster image
         shared_ptr<Image> getElevationRaster() const {
             return surface->getElevationRaster();
@@ -138,14 +183,38 @@ namespace ROCKY_NAMESPACE
             return surface->getElevationMatrix();
         }
 
+        //! Replace one of this tile's textures with the parent's, scaled and
+        //! biased to this tile's quadrant. Clears it if there is no parent.
+        void inheritTexture(TextureType type, const TerrainTileNode* parent);
+
         //! Remove this tile's children and reset the child
         //! loader future.
         void unloadSubtiles(Runtime&);
 
+        //! Intersects a world-space line segment with the resident terrain
+        //! under this tile, testing the highest-resolution tiles available.
+        //! @param start Start of the segment (world coordinates)
+        //! @param end End of the segment (world coordinates)
+        //! @param inout_ratio Closest hit so far as a ratio along the segment;
+        //!   updated if a closer hit is found
+        //! @return True if a closer hit was found
+        bool intersect(
+            const vsg::dvec3& start,
+            const vsg::dvec3& end,
+            double& inout_ratio) const;
+
         //! Update this node (placeholder).
         //! @return true if any changes occur.
         bool update(const vsg::FrameStamp*, const IOOptions&) { return false; }
 
+        //! Whether this tile should subdivide, given the LOD distance to its
+        //! bound (the view depth divided by lodScale; see vsg::State::lodDistance)
+        //! and the smallest fraction of the screen height a tile may cover.
+        bool shouldSubDivide(
+            double lodDistance,
+            double lodScale,
+            double minScreenHeightRatio) const;
+
     public:
 
         //! Customized cull traversal
@@ -164,7 +233,9 @@ namespace ROCKY_NAMESPACE
 
     private:
 
-        bool shouldSubDivide(vsg::State* state) const;
+        //! Whether this tile should subdivide, as seen from the current eye
+        //! or from another eye position (world coordinates)
+        bool shouldSubDivide(vsg::State* state, const vsg::dvec3* eye = nullptr) const;
 
         //! Calculate the culling extent
         void recomputeBound();
@@ -182,5 +253,6 @@ namespace ROCKY_NAMESPACE
         }
 
         friend class TerrainTilePager;
+        friend class TerrainReplay;
     };
 }
@@ -14,10 +14,13 @@
 #include <rocky/ImageLayer.h>
 #include <rocky/Map.h>
 #include <rocky/TerrainTileModelFactory.h>
+#include <rocky/Tracing.h>
 
 #include <vsg/nodes/QuadGroup.h>
 #include <vsg/ui/FrameStamp.h>
 
+#include <algorithm>
+
 using namespace ROCKY_NAMESPACE;
 
 #define LC "[TerrainTilePager] "
@@ -26,10 +29,135 @@ using namespace ROCKY_NAMESPACE;
 
 #define RP_DEBUG if(false) Log()->info
 
+namespace
+{
+    constexpr std::uint32_t NIL = ~0u;
+
+    // small, stable index for the calling thread, used to pick a ping buffer
+    inline unsigned recordThreadIndex()
+    {
+        static std::atomic_uint s_count = { 0u };
+        thread_local unsigned index = s_count++;
+        return index;
+    }
+
+    // Memory a tile's textures hold of their own, i.e. not shared with the
+    // parent. Geometry comes from the shared GeometryPool, so a tile only
+    // adds its uniform buffer to that.
+    void residentBytes(const TerrainTileRenderModel& model, const TerrainTileNode* parent, std::size_t& cpu, std::size_t& gpu)
+    {
+        cpu = 0;
+        gpu = sizeof(TerrainTileDescriptors::Uniforms);
+
+        auto add = [&](const TextureData& texture, const TextureData* inherited)
+            {
+                if (!texture.image || (inherited && inherited->image == texture.image))
+                    return;
+
+                // the encoded copy only lives on the GPU once uploaded
+                std::size_t bytes = texture.image->sizeInBytes();
+                cpu += bytes;
+                gpu += texture.encodedBytes > 0 ? texture.encodedBytes : bytes;
+            };
+
+        add(model.color, parent ? &parent->renderModel.color : nullptr);
+        add(model.elevation, parent ? &parent->renderModel.elevation : nullptr);
+        add(model.normal, parent ? &parent->renderModel.normal : nullptr);
+    }
+
+    // how to build tile geometry for these settings
+    GeometryPool::Settings geometrySettings(const TerrainSettings& settings)
+    {
+        return {
+            settings.tileSize.value(),
+            settings.skirtRatio.value(),
+            settings.morphTerrain.value()
+        };
+    }
+
+    inline bool isColorLayer(const shared_ptr<Layer>& layer)
+    {
+        return
+            layer->isOpen() &&
+            layer->renderType() == Layer::RenderType::TERRAIN_SURFACE &&
+            ImageLayer::cast(layer) != nullptr;
+    }
+
+    inline bool isElevationLayer(const shared_ptr<Layer>& layer)
+    {
+        return
+            layer->isOpen() &&
+            ElevationLayer::cast(layer) != nullptr;
+    }
+
+    // Reads the URIs on the network I/O stage (URI::readAsync), then dispatches
+    // the task to resolve the promise once they have all arrived. No thread
+    // waits on the network in between. Canceling the promise cancels the reads.
+    template<typename T, typename F>
+    void readThenDispatch(const std::vector<URI>& uris, const IOOptions& io, F task, jobs::future<T> promise, const jobs::context& context)
+    {
+        struct State
+        {
+            std::atomic_int remaining = { 0 };
+            std::chrono::steady_clock::time_point started;
+            jobs::future<T> promise;
+            std::vector<jobs::future<IOResult<Content>>> reads;
+        };
+
+        auto state = std::make_shared<State>();
+        state->started = std::chrono::steady_clock::now();
+        state->remaining = (int)uris.size();
+        state->promise = promise;
+
+        IOOptions readIO(io, state->promise);
+
+        for (auto& uri : uris)
+        {
+            state->reads.emplace_back(uri.readAsync(readIO));
+        }
+
+        // the reads have already stored their content in the content cache,
+        // where the task will find it.
+        std::function<void(const IOResult<Content>&)> arrived = [state, task, context](const IOResult<Content>&)
+            {
+                if (--state->remaining > 0)
+                    return;
+
+                if (util::Trace::active())
+                    util::Trace::span("fetch " + context.name, "rocky.network", state->started, state->started, std::chrono::steady_clock::now());
+
+                // all done; break the reference cycle through the callbacks
+                state->reads.clear();
+
+                // nobody wants the result any more
+                if (state->promise.canceled())
+                    return;
+
+                auto promise = std::move(state->promise);
+
+                auto run = [task](jobs::future<T>& p)
+                    {
+                        p.resolve(task(p));
+                    };
+
+                (void)jobs::dispatch(run, promise, context);
+            };
+
+        // attach these last; the first reads may already be done. Walk a copy,
+        // since the last callback may clear state->reads while we're looping.
+        auto reads = state->reads;
+        for (auto& read : reads)
+        {
+            read.then_dispatch(arrived, context);
+        }
+    }
+}
+
 //----------------------------------------------------------------------------
 
 TerrainTilePager::TerrainTilePager(
     const Profile& profile,
+    const SRS& worldSRS,
     const TerrainSettings& settings,
     Runtime& runtime,
     TerrainTileHost* in_host) :
@@ -39,6 +167,30 @@ TerrainTilePager::TerrainTilePager(
     _runtime(runtime)
 {
     _firstLOD = settings.minLevelOfDetail;
+
+    // One selection range per LOD: the radius of the tile containing the center
+    // of the profile (on the equator of a geodetic map), measured corner to corner.
+    _ranges.fill(0.0f);
+    if (profile.valid() && worldSRS.valid())
+    {
+        auto center = profile.extent().centroid();
+        for (unsigned lod = 0; lod < _ranges.size(); ++lod)
+        {
+            auto key = TileKey::createTileKeyContainingPoint(center.x, center.y, lod, profile);
+            if (!key.valid())
+                break;
+
+            auto& ex = key.extent();
+            glm::dvec3 c[4];
+            GeoPoint(ex.srs(), ex.xmin(), ex.ymin(), 0.0).transform(worldSRS, c[0]);
+            GeoPoint(ex.srs(), ex.xmax(), ex.ymax(), 0.0).transform(worldSRS, c[1]);
+            GeoPoint(ex.srs(), ex.xmax(), ex.ymin(), 0.0).transform(worldSRS, c[2]);
+            GeoPoint(ex.srs(), ex.xmin(), ex.ymax(), 0.0).transform(worldSRS, c[3]);
+
+            _ranges[lod] = 0.5f * (float)std::max(
+                glm::distance(c[0], c[1]), glm::distance(c[2], c[3]));
+        }
+    }
 }
 
 TerrainTilePager::~TerrainTilePager()
@@ -51,55 +203,125 @@ TerrainTilePager::releaseAll()
 {
     std::scoped_lock lock(_mutex);
 
-    _tiles.clear();
-    _tracker.reset();
+    for (auto& slot : _slots)
+    {
+        if (slot.tile)
+            slot.tile->pagerHandle = 0;
+    }
+
+    _slots.clear();
+    _freeSlots.clear();
+    _lruHead = _lruTail = NIL;
+    _cpuBytes = 0;
+    _gpuBytes = 0;
+
+    for (auto& buffer : _pingBuffers)
+        buffer.pings.clear();
+    _sharedPingBuffer.pings.clear();
+
     _loadSubtiles.clear();
     _loadElevation.clear();
     _mergeElevation.clear();
     _loadData.clear();
     _mergeData.clear();
     _updateData.clear();
+    _refreshData.clear();
+    _loading.clear();
 }
 
-void
-TerrainTilePager::ping(TerrainTileNode* tile, const TerrainTileNode* parent, vsg::RecordTraversal& rv)
+std::uint32_t
+TerrainTilePager::slotIndex(Handle handle) const
 {
-    if (_settings.supportMultiThreadedRecord)
-        _mutex.lock();
-
-    // first, update the tracker to keep this tile alive.
-    TileTable::iterator i = _tiles.find(tile->key);
+    auto index = (std::uint32_t)(handle & 0xffffffff);
+    return
+        handle != 0 && index < _slots.size() && _slots[index].handle == handle ?
+        index : NIL;
+}
 
-    if (i == _tiles.end())
+std::uint32_t
+TerrainTilePager::insert(vsg::ref_ptr<TerrainTileNode> tile, Handle parent)
+{
+    std::uint32_t index;
+    if (!_freeSlots.empty())
     {
-        // new entry:
-        auto& entry = _tiles[tile->key];
-        entry._tile = tile;
-        entry._trackerToken = _tracker.use(tile, nullptr);
+        index = _freeSlots.back();
+        _freeSlots.pop_back();
     }
     else
     {
-        _tracker.use(tile, i->second._trackerToken);
+        index = (std::uint32_t)_slots.size();
+        _slots.emplace_back();
     }
 
+    if (_nextGeneration == 0)
+        _nextGeneration = 1;
+
+    auto& slot = _slots[index];
+    slot.tile = tile;
+    slot.handle = ((Handle)_nextGeneration++ << 32) | index;
+    slot.parent = parent;
+    slot.prev = slot.next = NIL;
+    slot.queued = 0;
+    tile->pagerHandle = slot.handle;
+
+    return index;
+}
+
+void
+TerrainTilePager::erase(std::uint32_t index)
+{
+    auto& slot = _slots[index];
+
+    if (slot.prev != NIL) _slots[slot.prev].next = slot.next;
+    else _lruHead = slot.next;
+
+    if (slot.next != NIL) _slots[slot.next].prev = slot.prev;
+    else _lruTail = slot.prev;
+
+    if (slot.tile && slot.tile->pagerHandle == slot.handle)
+        slot.tile->pagerHandle = 0;
+
+    _cpuBytes -= slot.cpuBytes;
+    _gpuBytes -= slot.gpuBytes;
+
+    slot = Slot();
+    _freeSlots.push_back(index);
+}
+
+void
+TerrainTilePager::touch(std::uint32_t index)
+{
+    auto& slot = _slots[index];
+    slot.lastUsed = _cycle;
+
+    if (_lruHead == index)
+        return;
+
+    // unlink (a brand new slot has no links yet)
+    if (slot.prev != NIL) _slots[slot.prev].next = slot.next;
+    if (slot.next != NIL) _slots[slot.next].prev = slot.prev;
+    if (_lruTail == index) _lruTail = slot.prev;
+
+    // push to the front
+    slot.prev = NIL;
+    slot.next = _lruHead;
+    if (_lruHead != NIL) _slots[_lruHead].prev = index;
+    _lruHead = index;
+    if (_lruTail == NIL) _lruTail = index;
+}
+
+void
+TerrainTilePager::ping(TerrainTileNode* tile, const TerrainTileNode* parent, vsg::RecordTraversal& rv)
+{
     // next, see if the tile needs anything.
     // 
     // "progressive" means do not load LOD N+1 until LOD N is complete.
     const bool progressive = true;
 
+    std::uint32_t requests = 0;
+
     if (progressive)
     {
-
-#if 0
-        auto tileHasData = tile->dataMerger.available();
-
-        if (tileHasData && tile->_needsChildren)
-            _loadChildren.push_back(tile->key);
-
-        if (parentHasData && tile->dataLoader.empty())
-            _loadData.push_back(tile->key);
-#else
-
         auto tileHasData = tile->dataMerger.available();
 
 #ifdef LOAD_ELEVATION_SEPARATELY
@@ -109,45 +331,120 @@ TerrainTilePager::ping(TerrainTileNode* tile, const TerrainTileNode* parent, vsg
 #endif
         
         if (tileHasData && tileHasElevation && tile->_needsSubtiles)
-            _loadSubtiles.push_back(tile->key);
+            requests |= LOAD_SUBTILES;
 
 #ifdef LOAD_ELEVATION_SEPARATELY
         bool parentHasElevation = (parent == nullptr || parent->elevationMerger.available());
         if (parentHasElevation && tile->elevationLoader.empty())
-            _loadElevation.push_back(tile->key);
+            requests |= LOAD_ELEVATION;
 #endif
 
         bool parentHasData = (parent == nullptr || parent->dataMerger.available());
         if (parentHasData && tile->dataLoader.empty())
-            _loadData.push_back(tile->key);
-#endif
-
-    }
-    else
-    {
-        //// free for all
-        //if (tile->_needsChildren)
-        //    _needsChildren.push_back(tile->key);
-
-        //if (tile->dataLoader.empty())
-        //    _needsLoad.push_back(tile->key);
+            requests |= LOAD_DATA;
     }
 
 #ifdef LOAD_ELEVATION_SEPARATELY
     if (tile->elevationLoader.available() && tile->elevationMerger.empty())
-        _mergeElevation.push_back(tile->key);
+        requests |= MERGE_ELEVATION;
 #endif
 
     // This will only queue one merge per frame, to prevent overloading
     // the (synchronous) update cycle in VSG.
     if (tile->dataLoader.available() && tile->dataMerger.empty())
-        _mergeData.push_back(tile->key);
+        requests |= MERGE_DATA;
 
     if (tile->_needsUpdate)
-        _updateData.push_back(tile->key);
+        requests |= UPDATE;
+
+    // reload layers that changed, parents first so that a tile without data
+    // of its own can inherit its parent's new textures.
+    if ((tile->refreshColor || tile->refreshElevation) && tile->dataMerger.available())
+    {
+        bool parentReady = (parent == nullptr ||
+            (!parent->refreshColor && !parent->refreshElevation && parent->dataMerger.available()));
 
-    if (_settings.supportMultiThreadedRecord)
-        _mutex.unlock();
+        if (parentReady)
+            requests |= REFRESH_DATA;
+    }
+
+    // Record the ping. Record and update never overlap, so each record thread
+    // can append to its own buffer without locking; update() drains them.
+    Ping ping;
+    ping.handle = tile->pagerHandle;
+    ping.requests = requests;
+    if (ping.handle == 0)
+    {
+        // new tile; hold a reference until update() gives it a slot
+        ping.tile = tile;
+        ping.parent = parent ? parent->pagerHandle : 0;
+    }
+
+    if (!_settings.supportMultiThreadedRecord)
+    {
+        _pingBuffers[0].pings.emplace_back(std::move(ping));
+    }
+    else
+    {
+        auto thread = recordThreadIndex();
+        if (thread < maxRecordThreads)
+        {
+            _pingBuffers[thread].pings.emplace_back(std::move(ping));
+        }
+        else
+        {
+            std::scoped_lock lock(_sharedPingMutex);
+            _sharedPingBuffer.pings.emplace_back(std::move(ping));
+        }
+    }
+}
+
+void
+TerrainTilePager::drainPings()
+{
+    const auto queue = [this](std::uint32_t index, std::uint32_t requests)
+        {
+            auto& slot = _slots[index];
+            auto fresh = requests & ~slot.queued;
+            slot.queued |= requests;
+
+            if (fresh & UPDATE) _updateData.push_back(index);
+            if (fresh & LOAD_SUBTILES) _loadSubtiles.push_back(index);
+            if (fresh & LOAD_ELEVATION) _loadElevation.push_back(index);
+            if (fresh & MERGE_ELEVATION) _mergeElevation.push_back(index);
+            if (fresh & LOAD_DATA) _loadData.push_back(index);
+            if (fresh & MERGE_DATA) _mergeData.push_back(index);
+            if (fresh & REFRESH_DATA) _refreshData.push_back(index);
+        };
+
+    const auto drain = [&](PingBuffer& buffer)
+        {
+            for (auto& ping : buffer.pings)
+            {
+                auto index = slotIndex(ping.handle);
+
+                if (index == NIL && ping.tile)
+                {
+                    // a tile pinged from several threads may already have a slot
+                    index = slotIndex(ping.tile->pagerHandle);
+                    if (index == NIL)
+                        index = insert(ping.tile, ping.parent);
+                }
+
+                if (index != NIL)
+                {
+                    touch(index);
+                    queue(index, ping.requests);
+                }
+            }
+            buffer.pings.clear();
+        };
+
+    for (auto& buffer : _pingBuffers)
+        drain(buffer);
+
+    std::scoped_lock lock(_sharedPingMutex);
+    drain(_sharedPingBuffer);
 }
 
 bool
@@ -157,123 +454,99 @@ TerrainTilePager::update(const vsg::FrameStamp* fs, const IOOptions& io, shared_
 
     bool changes = false;
 
+    // collect everything the tiles asked for during the last record
+    drainPings();
+
+    // check for layers that were added, removed, or changed
+    syncLayers(terrain);
+
     //Log::info()
     //    << "Frame " << fs->frameCount << ": "
-    //    << "tiles=" << _tracker._list.size()-1 << " "
+    //    << "tiles=" << size() << " "
     //    << "needsSubtiles=" << _loadSubtiles.size() << " "
     //    << "needsLoad=" << _loadData.size() << " "
     //    << "needsMerge=" << _mergeData.size() << std::endl;
 
     // update any tiles that asked for it
-    for (auto& key : _updateData)
+    for (auto index : _updateData)
     {
-        auto iter = _tiles.find(key);
-        if (iter != _tiles.end())
-        {
-            if (iter->second._tile->update(fs, io))
-                changes = true;
-        }
+        if (_slots[index].tile->update(fs, io))
+            changes = true;
     }
-    _updateData.clear();
 
     // launch any "new subtiles" requests
-    for (auto& key : _loadSubtiles)
+    for (auto index : _loadSubtiles)
     {
-        auto iter = _tiles.find(key);
-        if (iter != _tiles.end())
-        {
-            requestLoadSubtiles(
-                iter->second._tile, // parent
-                terrain);  // context
+        auto& tile = _slots[index].tile;
 
-            iter->second._tile->_needsSubtiles = false;
-        }
+        requestLoadSubtiles(
+            tile,     // parent
+            terrain); // context
+
+        tile->_needsSubtiles = false;
 
         changes = true;
     }
-    _loadSubtiles.clear();
 
 #ifdef LOAD_ELEVATION_SEPARATELY
     // launch any data loading requests
-    for (auto& key : _loadElevation)
+    for (auto index : _loadElevation)
     {
-        auto iter = _tiles.find(key);
-        if (iter != _tiles.end())
-        {
-            requestLoadElevation(iter->second._tile, io, terrain);
-        }
-
+        requestLoadElevation(_slots[index].tile, io, terrain);
         changes = true;
     }
-    _loadElevation.clear();
 
     // schedule any data merging requests
-    for (auto& key : _mergeElevation)
+    for (auto index : _mergeElevation)
     {
-        auto iter = _tiles.find(key);
-        if (iter != _tiles.end())
-        {
-            requestMergeElevation(iter->second._tile, io, terrain);
-        }
-
+        requestMergeElevation(_slots[index].tile, io, terrain);
         changes = true;
     }
-    _mergeElevation.clear();
 #endif
 
     // launch any data loading requests
-    for (auto& key : _loadData)
+    for (auto index : _loadData)
     {
-        auto iter = _tiles.find(key);
-        if (iter != _tiles.end())
-        {
-            requestLoadData(iter->second._tile, io, terrain);
-        }
+        auto& tile = _slots[index].tile;
+        requestLoadData(tile, io, terrain);
+
+        if (tile->dataLoader.working() && tile->dataMerger.empty())
+            _loading.push_back(_slots[index].handle);
 
         changes = true;
     }
-    _loadData.clear();
 
     // schedule any data merging requests
-    for (auto& key : _mergeData)
+    for (auto index : _mergeData)
     {
-        auto iter = _tiles.find(key);
-        if (iter != _tiles.end())
-        {
-            requestMergeData(iter->second._tile, io, terrain);
-        }
+        requestMergeData(_slots[index].tile, io, terrain);
+        changes = true;
+    }
 
+    // launch any requests to refresh data after a layer change
+    for (auto index : _refreshData)
+    {
+        requestRefreshData(_slots[index].tile, io, terrain);
         changes = true;
     }
-    _mergeData.clear();
 
-    // Flush unused tiles (i.e., tiles that failed to ping) out of the system.
+    // reset the queues; every queued slot appears in at least one of them
+    for (auto* list : { &_updateData, &_loadSubtiles, &_loadElevation, &_mergeElevation, &_loadData, &_mergeData, &_refreshData })
+    {
+        for (auto index : *list)
+            _slots[index].queued = 0;
+        list->clear();
+    }
+
+    // Expire unused tiles (i.e., tiles that failed to ping) as memory requires.
     // Tiles ping their children all at once; this should in theory prevent
     // a child from expiring without its siblings.
     // Only do this is the frame advanced - otherwise just leave it be.
     if (fs->frameCount > _lastUpdate)
     {
-        const auto dispose = [&](TerrainTileNode* tile)
-            {
-                if (!tile->doNotExpire)
-                {
-                    auto key = tile->key;
-                    auto parent_iter = _tiles.find(key.createParentKey());
-                    if (parent_iter != _tiles.end())
-                    {
-                        auto parent = parent_iter->second._tile;
-                        if (parent.valid())
-                        {
-                            parent->unloadSubtiles(terrain->runtime);
-                        }
-                    }
-                    _tiles.erase(key);
-                    return true;
-                }
-                return false;
-            };
-
-        _tracker.flush(~0, dispose);
+        cancelUnusedLoads();
+        expire(terrain);
+        ++_cycle;
     }
 
     // synchronize
@@ -282,15 +555,193 @@ TerrainTilePager::update(const vsg::FrameStamp* fs, const IOOptions& io, shared_
     return changes;
 }
 
+void
+TerrainTilePager::cancelUnusedLoads()
+{
+    // A tile that leaves the view before its first data arrives (for example,
+    // one prefetched for a camera path that changed course) doesn't need that
+    // data any more. Abandoning the future cancels the job; if the tile comes
+    // back, its next ping will request the data again.
+    auto cancel = [this](Handle handle)
+        {
+            auto index = slotIndex(handle);
+            if (index == NIL)
+                return true;
+
+            auto& slot = _slots[index];
+            if (!slot.tile->dataLoader.working())
+                return true;
+
+            if (slot.lastUsed != _cycle && slot.tile->dataMerger.empty())
+            {
+                slot.tile->dataLoader.reset();
+                ++counters.canceled;
+                return true;
+            }
+
+            return false;
+        };
+
+    _loading.erase(std::remove_if(_loading.begin(), _loading.end(), cancel), _loading.end());
+}
+
+void
+TerrainTilePager::expire(shared_ptr<TerrainEngine> terrain)
+{
+    const std::size_t MB = 1024 * 1024;
+    const std::size_t cpuBudget = (std::size_t)_settings.cpuMemoryBudget.value() * MB;
+    const std::size_t gpuBudget = (std::size_t)_settings.gpuMemoryBudget.value() * MB;
+    const bool caching = cpuBudget > 0 && gpuBudget > 0;
+
+    // drawing indirect, every resident tile also needs a slot in the tile table
+    auto& state = terrain->stateFactory;
+    const std::uint32_t tableReserve = TerrainState::tileTableSize / 8;
+
+    const auto withinBudget = [&]()
+        {
+            return
+                caching && _cpuBytes <= cpuBudget && _gpuBytes <= gpuBudget &&
+                (!state.indirect || state.freeTileIndices() >= tableReserve);
+        };
+
+    if (withinBudget())
+        return;
+
+    // Pinged tiles sit at the front of the LRU, so the ones that weren't
+    // pinged this cycle (the cache) are all at the back. Rank them by how
+    // large they were on screen when last seen.
+    _evictionCandidates.clear();
+
+    for (auto index = _lruTail; index != NIL && _slots[index].lastUsed != _cycle; index = _slots[index].prev)
+    {
+        auto& tile = _slots[index].tile;
+        if (!tile->doNotExpire)
+        {
+            float importance = tile->bound.r / std::max((float)tile->lastTraversalRange, 1.0f);
+            _evictionCandidates.emplace_back(importance, _slots[index].handle);
+        }
+    }
+
+    std::sort(_evictionCandidates.begin(), _evictionCandidates.end(),
+        [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+
+    for (auto& candidate : _evictionCandidates)
+    {
+        if (withinBudget())
+            break;
+
+        // stale if a sibling or ancestor was already evicted
+        auto index = slotIndex(candidate.second);
+        if (index == NIL)
+            continue;
+
+        // siblings come and go together, so evict the whole quad
+        auto parent = slotIndex(_slots[index].parent);
+        if (parent != NIL)
+            evictSubtiles(parent, terrain);
+        else
+            eraseTree(_slots[index].tile.get(), terrain);
+    }
+}
+
+void
+TerrainTilePager::evictSubtiles(std::uint32_t parent, shared_ptr<TerrainEngine> terrain)
+{
+    auto tile = _slots[parent].tile;
+
+    if (tile->subtilesExist())
+    {
+        for (unsigned q = 0; q < 4; ++q)
+            eraseTree(tile->subTile(q), terrain);
+    }
+
+    tile->unloadSubtiles(terrain->runtime);
+}
+
+void
+TerrainTilePager::eraseTree(TerrainTileNode* tile, shared_ptr<TerrainEngine> terrain)
+{
+    if (tile->subtilesExist())
+    {
+        for (unsigned q = 0; q < 4; ++q)
+            eraseTree(tile->subTile(q), terrain);
+    }
+
+    auto index = slotIndex(tile->pagerHandle);
+    if (index != NIL)
+    {
+        if (terrain->heightQuery)
+            terrain->heightQuery->remove(tile->key);
+
+        // free the tile table slot now; the tile itself may linger in the disposer
+        tile->renderModel.descriptors.tableIndex = nullptr;
+
+        // releasing the tile cancels a load still in flight
+        if (tile->dataLoader.working())
+            ++counters.canceled;
+
+        ++counters.expired;
+
+        erase(index);
+    }
+}
+
+void
+TerrainTilePager::setResidentBytes(const TerrainTileNode* tile, std::size_t cpu, std::size_t gpu)
+{
+    std::scoped_lock lock(_mutex);
+
+    auto index = slotIndex(tile->pagerHandle);
+    if (index != NIL)
+    {
+        auto& slot = _slots[index];
+        _cpuBytes += cpu - slot.cpuBytes;
+        _gpuBytes += gpu - slot.gpuBytes;
+        slot.cpuBytes = cpu;
+        slot.gpuBytes = gpu;
+    }
+}
+
+void
+TerrainTilePager::syncLayers(shared_ptr<TerrainEngine> terrain)
+{
+    LayerRevisions color, elevation;
+
+    for (auto& layer : terrain->map->layers().all())
+    {
+        if (isColorLayer(layer))
+            color.emplace_back(layer->uid(), layer->revision());
+        else if (isElevationLayer(layer))
+            elevation.emplace_back(layer->uid(), layer->revision());
+    }
+
+    bool colorChanged = (color != _colorLayers);
+    bool elevationChanged = (elevation != _elevationLayers);
+
+    if (colorChanged || elevationChanged)
+    {
+        // Color layers are composited into one texture, so any change to one
+        // means reloading them all; elevation is independent. Tiles that have
+        // not started loading will pick up the new layers on their own.
+        for (auto& slot : _slots)
+        {
+            auto& tile = slot.tile;
+            if (tile && !tile->dataLoader.empty())
+            {
+                tile->refreshColor = tile->refreshColor || colorChanged;
+                tile->refreshElevation = tile->refreshElevation || elevationChanged;
+            }
+        }
+
+        _colorLayers = std::move(color);
+        _elevationLayers = std::move(elevation);
+    }
+}
+
 vsg::ref_ptr<TerrainTileNode>
 TerrainTilePager::createTile(const TileKey& key, vsg::ref_ptr<TerrainTileNode> parent, shared_ptr<TerrainEngine> terrain)
 {
-    GeometryPool::Settings geomSettings
-    {
-        terrain->settings.tileSize,
-        terrain->settings.skirtRatio,
-        false // morphing
-    };
+    auto geomSettings = geometrySettings(terrain->settings);
 
     // Get a shared geometry from the pool that corresponds to this tile key:
     auto geometry = terrain->geometryPool.getPooledGeometry(key, geomSettings, nullptr);
@@ -309,6 +760,29 @@ TerrainTilePager::createTile(const TileKey& key, vsg::ref_ptr<TerrainTileNode> p
     if (parent)
         tile->inheritFrom(parent);
 
+    // LOD selection and morphing ranges
+    float start = 0.0f, end = 0.0f;
+    getRanges(key, tile->lodRange, start, end);
+    if (terrain->settings.morphTerrain == true && geometry->arrays.size() > 3)
+    {
+        tile->renderModel.morph = { start, end, 1.0f / (float)(geomSettings.tileSize - 1), 0.0f };
+    }
+    else
+    {
+        tile->renderModel.morph = { 0.0f, 0.0f, 0.0f, 0.0f };
+    }
+
+    // the inherited model matrix is the parent's
+    auto& m = tile->surface->matrix;
+    tile->renderModel.modelMatrix = to_glm(m);
+    tile->renderModel.origin = { m[3][0], m[3][1], m[3][2] };
+
+    // a slot of its own in the tile table (not the parent's)
+    if (terrain->stateFactory.indirect)
+    {
+        tile->renderModel.descriptors.tableIndex = terrain->stateFactory.allocateTileIndex();
+    }
+
     // update the bounding sphere for culling
     tile->recomputeBound();
 
@@ -318,16 +792,53 @@ TerrainTilePager::createTile(const TileKey& key, vsg::ref_ptr<TerrainTileNode> p
         tile->stategroup,
         terrain->runtime);
 
+    ++counters.created;
+
     return tile;
 }
 
+void
+TerrainTilePager::getRanges(
+    const TileKey& key,
+    float& out_range,
+    float& out_startMorphRange,
+    float& out_endMorphRange) const
+{
+    out_range = getRange(key);
+
+    // a tile morphs into its parent as it nears the range at which the parent
+    // stops subdividing, and has finished morphing when it gets there.
+    out_endMorphRange = key.levelOfDetail() > _firstLOD ? getRange(key.createParentKey()) : 0.0f;
+    out_startMorphRange = out_endMorphRange * _morphStart;
+}
+
+float
+TerrainTilePager::getRange(const TileKey& key) const
+{
+    auto lod = std::min(key.levelOfDetail(), (unsigned)_ranges.size() - 1);
+    return _ranges[lod];
+}
+
 vsg::ref_ptr<TerrainTileNode>
 TerrainTilePager::getTile(const TileKey& key) const
 {
     std::scoped_lock lock(_mutex);
-    auto iter = _tiles.find(key);
+    for (auto& slot : _slots)
+    {
+        if (slot.tile && slot.tile->key == key)
+            return slot.tile;
+    }
+    return {};
+}
+
+vsg::ref_ptr<TerrainTileNode>
+TerrainTilePager::getParent(const TerrainTileNode* tile) const
+{
+    std::scoped_lock lock(_mutex);
+    auto index = slotIndex(tile->pagerHandle);
+    auto parent = index != NIL ? slotIndex(_slots[index].parent) : NIL;
     return
-        iter != _tiles.end() ? iter->second._tile :
+        parent != NIL ? _slots[parent].tile :
         vsg::ref_ptr<TerrainTileNode>(nullptr);
 }
 void
@@ -401,7 +912,7 @@ TerrainTilePager::requestLoadSubtiles(
 void
 TerrainTilePager::requestLoadData(
     vsg::ref_ptr<TerrainTileNode> tile,
-    const IOOptions& in_io,
+    const IOOptions& io,
     shared_ptr<TerrainEngine> engine) const
 {
     ROCKY_SOFT_ASSERT_AND_RETURN(tile, void());
@@ -412,20 +923,83 @@ TerrainTilePager::requestLoadData(
         return;
     }
 
+#ifdef LOAD_ELEVATION_SEPARATELY
+    loadData(tile, true, false, false, io, engine);
+#else
+    loadData(tile, true, true, false, io, engine);
+#endif
+}
+
+void
+TerrainTilePager::requestRefreshData(
+    vsg::ref_ptr<TerrainTileNode> tile,
+    const IOOptions& io,
+    shared_ptr<TerrainEngine> engine) const
+{
+    ROCKY_SOFT_ASSERT_AND_RETURN(tile, void());
+
+    // only refresh a tile whose current data is merged and idle
+    if (tile->dataLoader.working() || !tile->dataMerger.available())
+    {
+        return;
+    }
+
+    bool color = tile->refreshColor;
+    bool elevation = tile->refreshElevation;
+
+    // clear the flags now; if a layer changes again while this load is
+    // in flight, syncLayers() will set them again.
+    tile->refreshColor = false;
+    tile->refreshElevation = false;
+
+    // The tile keeps rendering its current textures until the new data merges.
+    tile->dataMerger.reset();
+
+    loadData(tile, color, elevation, true, io, engine);
+}
+
+void
+TerrainTilePager::loadData(
+    vsg::ref_ptr<TerrainTileNode> tile,
+    bool color,
+    bool elevation,
+    bool refresh,
+    const IOOptions& in_io,
+    shared_ptr<TerrainEngine> engine) const
+{
     auto key = tile->key;
 
     //RP_DEBUG("requestLoadData -> {}", key.str());
 
+    // record the layers (and their revisions) that this load covers:
     CreateTileManifest manifest;
 
-#ifdef LOAD_ELEVATION_SEPARATELY
-    for (auto& layer : engine->map->layers().ofType<ImageLayer>())
-        manifest.insert(layer);
-#endif
+    // remote data the load will read, to fetch on the network I/O stage first.
+    // The layers only see that data through the content cache, so without one
+    // the read-ahead would just fetch everything twice.
+    std::vector<URI> uris;
+    bool readAhead =
+        engine->settings.networkConcurrency.value() > 0u &&
+        in_io.services.contentCache != nullptr;
+
+    for (auto& layer : engine->map->layers().all())
+    {
+        if ((color && isColorLayer(layer)) || (elevation && isElevationLayer(layer)))
+        {
+            manifest.insert(layer);
+
+            auto tileLayer = TileLayer::cast(layer);
+            if (readAhead && tileLayer && tileLayer->isKeyInLegalRange(key) && tileLayer->intersects(key) && tileLayer->mayHaveData(key))
+            {
+                for (auto& uri : tileLayer->tileURIs(key))
+                    uris.emplace_back(uri);
+            }
+        }
+    }
 
     const IOOptions io(in_io);
 
-    auto load = [key, manifest, engine, io](Cancelable& p) -> TerrainTileModel
+    auto load = [key, manifest, color, elevation, refresh, engine, io](Cancelable& p) -> TerrainTileData
     {
         if (p.canceled())
         {
@@ -433,19 +1007,52 @@ TerrainTilePager::requestLoadData(
             return { };
         }
 
-        TerrainTileModelFactory factory;
+        TerrainTileData data;
+        data.manifest = manifest;
+        data.color = color;
+        data.elevation = elevation;
+        data.refresh = refresh;
 
-        factory.compositeColorLayers = true;
+        // an empty manifest means "all layers" to the factory
+        if (!manifest.empty() || (color && elevation))
+        {
+            TerrainTileModelFactory factory;
 
-        auto model = factory.createTileModel(
-            engine->map.get(),
-            key,
-            manifest,
-            IOOptions(io, p));
+            factory.compositeColorLayers = true;
+
+            data.model = factory.createTileModel(
+                engine->map.get(),
+                key,
+                manifest,
+                IOOptions(io, p));
+        }
+
+        // mipmap and compress the color texture here, off the update thread:
+        auto& colorLayers = data.model.colorLayers;
+        if (engine->textureEncoder.enabled() && !colorLayers.empty() && colorLayers[0].image.valid() && !p.canceled())
+        {
+            data.encodedColor = engine->textureEncoder.encode(*colorLayers[0].image.image());
+        }
+
+        // fit a mesh to the tile's own elevation, also off the update thread:
+        auto& elevation = data.model.elevation;
+        if (engine->settings.adaptiveMeshError > 0.0f && elevation.heightfield.valid() && !p.canceled())
+        {
+            data.geometry = engine->geometryPool.createAdaptiveGeometry(
+                key,
+                geometrySettings(engine->settings),
+                *elevation.heightfield.heightfield(),
+                glm::dmat4(elevation.matrix),
+                engine->settings.adaptiveMeshError.value(),
+                &p);
+        }
+
+        if (!p.canceled())
+            ++engine->tiles.counters.loaded;
 
         engine->runtime.requestFrame();
 
-        return model;
+        return data;
     };
 
     // a callback that will return the loading priority of a tile
@@ -457,14 +1064,24 @@ TerrainTilePager::requestLoadData(
         return tile ? -(sqrt(tile->lastTraversalRange) * tile->key.levelOfDetail()) : 0.0f;
     };
 
-    tile->dataLoader = jobs::dispatch(
-        load, 
-        jobs::context {
-            "load data " + key.str(),
-            jobs::get_pool(engine->loadSchedulerName),
-            priority_func,
-            nullptr
-        } );
+    auto context = jobs::context {
+        (refresh ? "refresh data " : "load data ") + key.str(),
+        jobs::get_pool(engine->loadSchedulerName),
+        priority_func,
+        nullptr
+    };
+
+    if (uris.empty())
+    {
+        tile->dataLoader = jobs::dispatch(load, context);
+    }
+    else
+    {
+        // the loader threads only decode and composite what the network stage fetched
+        jobs::future<TerrainTileData> promise;
+        tile->dataLoader = promise;
+        readThenDispatch(uris, io, load, promise, context);
+    }
 }
 
 void
@@ -486,7 +1103,11 @@ TerrainTilePager::requestMergeData(
 
     //RP_DEBUG("requestMergeData -> {}", key.str());
 
-    auto merge = [key, engine](Cancelable& p) -> bool
+    vsg::observer_ptr<TerrainTileNode> tile_weak(tile);
+
+    auto queued = std::chrono::steady_clock::now();
+
+    auto merge = [key, tile_weak, engine, queued](Cancelable& p) -> bool
     {
         if (p.canceled())
         {
@@ -494,57 +1115,137 @@ TerrainTilePager::requestMergeData(
             return false;
         }
 
-        auto tile = engine->tiles.getTile(key);
-        if (!tile)
+        util::Trace::Scope trace("merge data " + key.str(), "rocky.update", queued);
+
+        auto tile = tile_weak.ref_ptr();
+        if (!tile || tile->pagerHandle == 0)
         {
             //Log()->info("  merge tile lost -> {}", key.str());
             return false;
         }
 
-        auto model = tile->dataLoader.value();
+        auto& data = tile->dataLoader.value();
+        auto& model = data.model;
+
+        // A layer changed while this data was loading. syncLayers() only flags
+        // the kind of layer that changed, so flag everything this load covered
+        // and keep what the tile has until the reloaded data arrives.
+        if (!data.manifest.inSyncWith(engine->map.get()))
+        {
+            tile->refreshColor = tile->refreshColor || data.color;
+            tile->refreshElevation = tile->refreshElevation || data.elevation;
+            RP_DEBUG("  merge stale -> {}", key.str());
+            return false;
+        }
 
         auto& renderModel = tile->renderModel;
 
+        // A tile with no data of its own shows its parent's. Inherit again in
+        // case the parent's data changed since this tile inherited it.
+        auto parent = engine->tiles.getParent(tile.get());
+
+        auto parentChanged = [&](TextureType type)
+            {
+                if (!parent)
+                    return false;
+                auto& texture = type == COLOR ? renderModel.color : renderModel.elevation;
+                auto& parentTexture = type == COLOR ? parent->renderModel.color : parent->renderModel.elevation;
+                return parentTexture.image != texture.image;
+            };
+
+        // swaps in new surface geometry, retiring the old
+        auto setGeometry = [&](vsg::ref_ptr<vsg::Node> geometry)
+            {
+                engine->runtime.compile(geometry);
+                engine->runtime.dispose(tile->setGeometry(geometry));
+            };
+
         bool updated = false;
 
-        if (model.colorLayers.size() > 0)
+        if (data.color)
         {
-            auto& layer = model.colorLayers[0];
-            if (layer.image.valid())
+            if (model.colorLayers.size() > 0)
             {
-                renderModel.color.name = "color " + layer.key.str();
-                renderModel.color.image = layer.image.image();
-                renderModel.color.matrix = layer.matrix;
+                auto& layer = model.colorLayers[0];
+                if (layer.image.valid())
+                {
+                    renderModel.color.name = "color " + layer.key.str();
+                    renderModel.color.image = layer.image.image();
+                    renderModel.color.encodedBytes = data.encodedColor ?
+                        data.encodedColor->computeValueCountIncludingMipmaps() * data.encodedColor->valueSize() : 0;
+                    renderModel.color.encoded = std::move(data.encodedColor);
+                    renderModel.color.encodedTexture = nullptr;
+                    renderModel.color.matrix = layer.matrix;
+                }
+                updated = true;
+            }
+            else if (data.refresh || parentChanged(COLOR))
+            {
+                tile->inheritTexture(COLOR, parent.get());
+                updated = true;
             }
-            updated = true;
         }
 
-#ifndef LOAD_ELEVATION_SEPARATELY
-        if (model.elevation.heightfield.valid())
+        if (data.elevation)
         {
-            renderModel.elevation.name = "elevation " + model.elevation.key.str();
-            renderModel.elevation.image = model.elevation.heightfield.heightfield();
-            renderModel.elevation.matrix = model.elevation.matrix;
+            if (model.elevation.heightfield.valid())
+            {
+                renderModel.elevation.name = "elevation " + model.elevation.key.str();
+                renderModel.elevation.image = model.elevation.heightfield.heightfield();
+                renderModel.elevation.matrix = model.elevation.matrix;
 
-            // prompt the tile can update its bounds
-            tile->setElevation(
-                renderModel.elevation.image,
-                renderModel.elevation.matrix);
+                // prompt the tile can update its bounds
+                tile->setElevation(
+                    renderModel.elevation.image,
+                    renderModel.elevation.matrix);
 
-            updated = true;
-        }
+                // render the mesh fit to this elevation, if there is one
+                if (data.geometry)
+                {
+                    setGeometry(data.geometry);
+                }
 
-        if (model.normalMap.image.valid())
-        {
-            renderModel.elevation.name = "normal " + model.normalMap.key.str();
-            renderModel.normal.image = model.normalMap.image.image();
-            renderModel.normal.matrix = model.normalMap.matrix;
+                // make the new data available to height queries
+                if (engine->heightQuery)
+                {
+                    engine->heightQuery->insert(
+                        key,
+                        renderModel.elevation.image,
+                        renderModel.elevation.matrix);
+                }
+
+                updated = true;
+            }
+            else if (data.refresh || parentChanged(ELEVATION))
+            {
+                tile->inheritTexture(ELEVATION, parent.get());
+
+                // a mesh fit to the old elevation no longer applies
+                auto current = tile->getGeometry()->cast<SharedGeometry>();
+                if (current && current->adaptive)
+                {
+                    setGeometry(engine->geometryPool.getPooledGeometry(
+                        key, geometrySettings(engine->settings), nullptr));
+                }
+
+                if (engine->heightQuery)
+                    engine->heightQuery->remove(key);
 
-            updated = true;
+                updated = true;
+            }
+
+            if (model.normalMap.image.valid())
+            {
+                renderModel.elevation.name = "normal " + model.normalMap.key.str();
+                renderModel.normal.image = model.normalMap.image.image();
+                renderModel.normal.matrix = model.normalMap.matrix;
+
+                updated = true;
+            }
         }
-#endif
 
         renderModel.modelMatrix = to_glm(tile->surface->matrix);
+        renderModel.origin = { tile->surface->matrix[3][0], tile->surface->matrix[3][1], tile->surface->matrix[3][2] };
 
         if (updated)
         {
@@ -553,6 +1254,10 @@ TerrainTilePager::requestMergeData(
                 tile->stategroup,
                 engine->runtime);
 
+            std::size_t cpu, gpu;
+            residentBytes(renderModel, parent.get(), cpu, gpu);
+            engine->tiles.setResidentBytes(tile.get(), cpu, gpu);
+
             RP_DEBUG("  merge ok -> {}", key.str());
         }
         else
@@ -560,6 +1265,8 @@ TerrainTilePager::requestMergeData(
             RP_DEBUG("  merge empty -> {}", key.str());
         }
 
+        ++engine->tiles.counters.merged;
+
         engine->runtime.requestFrame();
 
         return true;
@@ -569,7 +1276,6 @@ TerrainTilePager::requestMergeData(
 
     tile->dataMerger = merge_op->future();
 
-    vsg::observer_ptr<TerrainTileNode> tile_weak(tile);
     auto priority_func = [tile_weak]() -> float
     {
         vsg::ref_ptr<TerrainTileNode> tile = tile_weak.ref_ptr();
@@ -684,6 +1390,17 @@ TerrainTilePager::requestMergeElevation(
                     renderModel.elevation.image,
                     renderModel.elevation.matrix);
 
+                // Note: adaptive meshes are only built by the combined loader
+                // (requestLoadData), so this tile keeps its pooled grid.
+
+                if (engine->heightQuery)
+                {
+                    engine->heightQuery->insert(
+                        key,
+                        renderModel.elevation.image,
+                        renderModel.elevation.matrix);
+                }
+
                 updated = true;
             }
 
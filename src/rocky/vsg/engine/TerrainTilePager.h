@@ -7,8 +7,9 @@
 
 #include <rocky/vsg/Common.h>
 #include <rocky/vsg/engine/TerrainTileNode.h>
-#include <rocky/SentryTracker.h>
+#include <array>
 #include <chrono>
+#include <mutex>
 
 namespace ROCKY_NAMESPACE
 {
@@ -17,30 +18,91 @@ namespace ROCKY_NAMESPACE
 
     /**
      * Keeps track of all the tiles resident in the terrain engine.
+     *
+     * Resident tiles live in a flat slot table and each tile carries a
+     * stable handle to its slot, so no key lookups happen per frame.
+     * During record, ping() only appends a small request record to the
+     * calling thread's ping buffer (no locks); update() drains those
+     * buffers, moves pinged tiles to the front of an intrusive LRU list,
+     * and expires whatever falls behind.
+     *
+     * Tiles that leave the view stay resident (cached) until the memory
+     * they hold exceeds the budgets in TerrainSettings. Then the pager
+     * evicts cached tiles, least important (smallest on screen when last
+     * seen) first, until usage is back within budget.
      */
     class TerrainTilePager
     {
     public:
         using Ptr = std::shared_ptr<TerrainTilePager>;
 
-        using Tracker = util::SentryTracker<TerrainTileNode*>;
+        //! Stable reference to a slot: generation (high 32 bits) and index (low 32 bits).
+        //! Zero is never a valid handle.
+        using Handle = std::uint64_t;
 
-        struct TableEntry
+        //! Things a tile may ask for when it pings
+        enum Request : std::uint32_t
+        {
+            LOAD_SUBTILES = 1 << 0,
+            LOAD_ELEVATION = 1 << 1,
+            MERGE_ELEVATION = 1 << 2,
+            LOAD_DATA = 1 << 3,
+            MERGE_DATA = 1 << 4,
+            UPDATE = 1 << 5,
+            REFRESH_DATA = 1 << 6
+        };
+
+        struct Slot
         {
             // this needs to be a ref ptr because it's possible for the unloader
             // to remove a Tile's ancestor from the scene graph, which will turn
             // this Tile into an orphan. As an orphan it will expire and eventually
             // be removed anyway, but we need to keep it alive in the meantime...
-            vsg::ref_ptr<TerrainTileNode> _tile;
-            void* _trackerToken = nullptr;
+            vsg::ref_ptr<TerrainTileNode> tile;
+            Handle handle = 0;          // 0 when the slot is free
+            Handle parent = 0;          // slot of the parent tile, if any
+            std::uint32_t prev = ~0u;   // LRU links (toward most recently used)
+            std::uint32_t next = ~0u;   // LRU links (toward least recently used)
+            std::uint64_t lastUsed = 0; // expiration cycle of the last ping
+            std::uint32_t queued = 0;   // requests already queued this update
+            std::size_t cpuBytes = 0;   // system memory the tile holds of its own
+            std::size_t gpuBytes = 0;   // GPU memory the tile holds of its own
+        };
+
+        struct Ping
+        {
+            Handle handle = 0;                  // the tile's slot, if it has one
+            Handle parent = 0;                  // the parent's slot, for new tiles
+            std::uint32_t requests = 0;         // mask of Request values
+            vsg::ref_ptr<TerrainTileNode> tile; // set only for tiles without a slot
         };
 
-        using TileTable = std::unordered_map<TileKey, TableEntry>;
+        //! Pings recorded by one thread; padded to avoid false sharing
+        struct alignas(64) PingBuffer
+        {
+            std::vector<Ping> pings;
+        };
+
+        //! Threads that get their own ping buffer; any others share a locked one
+        static constexpr unsigned maxRecordThreads = 16;
+
+        using LayerRevisions = std::vector<std::pair<UID, Revision>>;
+
+        //! Running totals of the pager's work, for profiling
+        struct Counters
+        {
+            std::atomic<std::uint64_t> created = { 0u };  // tiles created
+            std::atomic<std::uint64_t> loaded = { 0u };   // data loads completed
+            std::atomic<std::uint64_t> merged = { 0u };   // data merges applied
+            std::atomic<std::uint64_t> expired = { 0u };  // tiles evicted
+            std::atomic<std::uint64_t> canceled = { 0u }; // data loads abandoned before they merged
+        };
 
     public:
         //! Consturct the tile manager.
         TerrainTilePager(
             const Profile& profile,
+            const SRS& worldSRS,
             const TerrainSettings& settings,
             Runtime& runtime,
             TerrainTileHost* host);
@@ -56,7 +118,20 @@ namespace ROCKY_NAMESPACE
             vsg::RecordTraversal&);
 
         //! Number of tiles in the registry.
-        std::size_t size() const { return _tiles.size(); }
+        std::size_t size() const { return _slots.size() - _freeSlots.size(); }
+
+        //! System memory held by resident tiles, in bytes
+        std::size_t cpuBytes() const { return _cpuBytes; }
+
+        //! GPU memory held by resident tiles, in bytes
+        std::size_t gpuBytes() const { return _gpuBytes; }
+
+        //! Running totals of tiles created, loaded, merged, expired and canceled
+        Counters counters;
+
+        //! Records the memory a resident tile holds of its own (i.e., not
+        //! inherited from its parent). Call after merging new data into it.
+        void setResidentBytes(const TerrainTileNode* tile, std::size_t cpu, std::size_t gpu);
 
         //! Empty the registry, releasing all tiles.
         void releaseAll();
@@ -79,10 +154,24 @@ namespace ROCKY_NAMESPACE
         //! @return The tile, if it exists
         vsg::ref_ptr<TerrainTileNode> getTile(const TileKey& key) const;
 
+        //! Fetches the parent of a resident tile.
+        //! @return The parent, if it is resident
+        vsg::ref_ptr<TerrainTileNode> getParent(const TerrainTileNode* tile) const;
+
     //protected:
 
-        TileTable _tiles;
-        Tracker _tracker;
+        std::vector<Slot> _slots;
+        std::vector<std::uint32_t> _freeSlots;
+        std::uint32_t _lruHead = ~0u;
+        std::uint32_t _lruTail = ~0u;
+        std::uint32_t _nextGeneration = 1;
+        std::uint64_t _cycle = 1;
+        std::atomic<std::size_t> _cpuBytes = { 0 };
+        std::atomic<std::size_t> _gpuBytes = { 0 };
+        std::vector<std::pair<float, Handle>> _evictionCandidates;
+        std::array<PingBuffer, maxRecordThreads> _pingBuffers;
+        PingBuffer _sharedPingBuffer;
+        std::mutex _sharedPingMutex;
         std::uint64_t _lastUpdate = 0;
         mutable std::mutex _mutex;
         TerrainTileHost* _host;
@@ -90,17 +179,60 @@ namespace ROCKY_NAMESPACE
         Runtime& _runtime;
         bool _updateViewerRequired = false;
 
-        std::vector<TileKey> _loadSubtiles;
-        std::vector<TileKey> _loadElevation;
-        std::vector<TileKey> _mergeElevation;
-        std::vector<TileKey> _loadData;
-        std::vector<TileKey> _mergeData; 
-        std::vector<TileKey> _updateData;
+        // slots with pending requests, by request type
+        std::vector<std::uint32_t> _loadSubtiles;
+        std::vector<std::uint32_t> _loadElevation;
+        std::vector<std::uint32_t> _mergeElevation;
+        std::vector<std::uint32_t> _loadData;
+        std::vector<std::uint32_t> _mergeData;
+        std::vector<std::uint32_t> _updateData;
+        std::vector<std::uint32_t> _refreshData;
+
+        // tiles with an initial data load in flight
+        std::vector<Handle> _loading;
+
+        // terrain layers (in map order) that resident tiles were built from
+        LayerRevisions _colorLayers;
+        LayerRevisions _elevationLayers;
 
         unsigned _firstLOD = 0u;
 
+        // LOD selection range for each level (see getRange)
+        std::array<float, 31> _ranges;
+
+        // fraction of the end range at which a tile starts morphing into its parent
+        static constexpr float _morphStart = 0.85f;
+
     private:
 
+        //! Slot index for a handle, or ~0u if the handle is stale
+        std::uint32_t slotIndex(Handle handle) const;
+
+        //! Register a tile in a new slot
+        std::uint32_t insert(vsg::ref_ptr<TerrainTileNode> tile, Handle parent);
+
+        //! Release a slot and unlink it from the LRU
+        void erase(std::uint32_t index);
+
+        //! Move a slot to the front of the LRU and mark it used this cycle
+        void touch(std::uint32_t index);
+
+        //! Collect the pings from all ping buffers into the request queues
+        void drainPings();
+
+        //! Cancel initial loads for tiles that are no longer pinged
+        void cancelUnusedLoads();
+
+        //! Evict tiles that weren't pinged this cycle while over budget
+        void expire(shared_ptr<TerrainEngine> terrain);
+
+        //! Remove a parent's subtiles (and their subtiles) from the registry
+        //! and the scene graph
+        void evictSubtiles(std::uint32_t parent, shared_ptr<TerrainEngine> terrain);
+
+        //! Release the slots of a tile and its subtiles
+        void eraseTree(TerrainTileNode* tile, shared_ptr<TerrainEngine> terrain);
+
         void requestLoadSubtiles(
             vsg::ref_ptr<TerrainTileNode> parent,
             shared_ptr<TerrainEngine> terrain) const;
@@ -120,17 +252,39 @@ namespace ROCKY_NAMESPACE
             const IOOptions& io,
             shared_ptr<TerrainEngine> terrain) const;
 
+        void requestRefreshData(
+            vsg::ref_ptr<TerrainTileNode> tile,
+            const IOOptions& io,
+            shared_ptr<TerrainEngine> terrain) const;
+
+        void loadData(
+            vsg::ref_ptr<TerrainTileNode> tile,
+            bool color,
+            bool elevation,
+            bool refresh,
+            const IOOptions& io,
+            shared_ptr<TerrainEngine> terrain) const;
+
+        //! Flags resident tiles for refresh when terrain layers change
+        void syncLayers(shared_ptr<TerrainEngine> terrain);
+
         void requestMergeData(
             vsg::ref_ptr<TerrainTileNode> tile,
             const IOOptions& io,
             shared_ptr<TerrainEngine> terrain) const;
 
+        //! LOD selection range of a tile, and the ranges over which it morphs
+        //! into its parent (0 if it has no parent). Ranges are in units of the
+        //! selection metric: distance scaled by the screen height ratio.
         void getRanges(
             const TileKey& key,
             float& out_range,
             float& out_startMorphRange,
             float& out_endMorphRange) const;
 
+        //! A tile subdivides when the nearest point of its bound comes within
+        //! this range. All tiles at a LOD share the same range (that of a tile
+        //! in the middle of the profile) so neighbors decide consistently.
         float getRange(const TileKey& key) const;
     };
 }
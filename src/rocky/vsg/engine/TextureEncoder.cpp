@@ -0,0 +1,385 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#include "TextureEncoder.h"
+#include <rocky/vsg/TerrainSettings.h>
+#include <rocky/Utils.h>
+#include <vsg/core/Array2D.h>
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace ROCKY_NAMESPACE;
+
+#define LC "[TextureEncoder] "
+
+namespace
+{
+    using RGBA = vsg::ubvec4;
+
+    inline unsigned half(unsigned x) {
+        return std::max(1u, x / 2u);
+    }
+
+    inline bool isPowerOfTwo(unsigned x) {
+        return x > 0 && (x & (x - 1)) == 0;
+    }
+
+    // Copies an 8-bit RGB or RGBA image into a tightly packed RGBA buffer,
+    // bottom row first (the row order the terrain uploads to VSG).
+    void toRGBA(const Image& image, RGBA* out)
+    {
+        const unsigned w = image.width(), h = image.height();
+        const bool rgba = image.pixelFormat() == Image::R8G8B8A8_UNORM;
+
+        for (unsigned t = 0; t < h; ++t)
+        {
+            unsigned row = image.origin() == Image::BOTTOM_LEFT ? t : h - 1 - t;
+            auto* src = image.data<std::uint8_t>() + row * image.rowSizeInBytes();
+            auto* dst = out + t * w;
+
+            if (rgba)
+            {
+                std::memcpy(dst, src, w * sizeof(RGBA));
+            }
+            else
+            {
+                for (unsigned s = 0; s < w; ++s, src += 3)
+                    dst[s].set(src[0], src[1], src[2], 255);
+            }
+        }
+    }
+
+    // Box-filters a level into the next one. Like VSG, each dimension
+    // halves (rounding down) until it reaches 1.
+    void downsample(const RGBA* src, unsigned w, unsigned h, RGBA* dst)
+    {
+        const unsigned dw = half(w), dh = half(h);
+
+        for (unsigned t = 0; t < dh; ++t)
+        {
+            const RGBA* r0 = src + std::min(2 * t, h - 1) * w;
+            const RGBA* r1 = src + std::min(2 * t + 1, h - 1) * w;
+
+            for (unsigned s = 0; s < dw; ++s)
+            {
+                unsigned s0 = std::min(2 * s, w - 1), s1 = std::min(2 * s + 1, w - 1);
+                for (unsigned c = 0; c < 4; ++c)
+                    dst[t * dw + s][c] = (std::uint8_t)((r0[s0][c] + r0[s1][c] + r1[s0][c] + r1[s1][c] + 2) >> 2);
+            }
+        }
+    }
+
+    inline std::uint16_t to565(const int* rgb)
+    {
+        return (std::uint16_t)(
+            (((rgb[0] * 31 + 127) / 255) << 11) |
+            (((rgb[1] * 63 + 127) / 255) << 5) |
+            ((rgb[2] * 31 + 127) / 255));
+    }
+
+    inline void from565(std::uint16_t c, int* rgb)
+    {
+        int r = (c >> 11) & 31, g = (c >> 5) & 63, b = c & 31;
+        rgb[0] = (r << 3) | (r >> 2);
+        rgb[1] = (g << 2) | (g >> 4);
+        rgb[2] = (b << 3) | (b >> 2);
+    }
+
+    inline void store(std::uint8_t* out, std::uint64_t value, unsigned bytes)
+    {
+        for (unsigned i = 0; i < bytes; ++i)
+            out[i] = (std::uint8_t)(value >> (8 * i));
+    }
+
+    // Encodes the color of a 4x4 block into 8 bytes, using the corners of the
+    // colors' bounding box as endpoints. With punch_through (BC1), pixels with
+    // alpha < 128 use the transparent index of the 3-color mode. BC3 decodes
+    // every color block in 4-color mode.
+    void encodeColorBlock(const RGBA* block, bool punch_through, bool bc3, std::uint8_t* out)
+    {
+        bool transparent[16];
+        bool any_transparent = false;
+        int lo[3] = { 255, 255, 255 }, hi[3] = { 0, 0, 0 }, sum[3] = { 0, 0, 0 };
+        int opaque = 0;
+
+        for (unsigned i = 0; i < 16; ++i)
+        {
+            transparent[i] = punch_through && block[i].a < 128;
+            any_transparent = any_transparent || transparent[i];
+            if (transparent[i])
+                continue;
+
+            for (unsigned c = 0; c < 3; ++c)
+            {
+                lo[c] = std::min(lo[c], (int)block[i][c]);
+                hi[c] = std::max(hi[c], (int)block[i][c]);
+                sum[c] += block[i][c];
+            }
+            ++opaque;
+        }
+
+        if (opaque == 0)
+        {
+            // fully transparent: 3-color mode with every index pointing at black
+            store(out, 0u, 4);
+            store(out + 4, 0xFFFFFFFFu, 4);
+            return;
+        }
+
+        // The box's main diagonal only fits colors that vary together. Flip a
+        // channel's endpoints when it varies against the widest channel.
+        unsigned ref = 0;
+        for (unsigned c = 1; c < 3; ++c)
+            if (hi[c] - lo[c] > hi[ref] - lo[ref])
+                ref = c;
+
+        int cov[3] = { 0, 0, 0 };
+        for (unsigned i = 0; i < 16; ++i)
+        {
+            if (transparent[i])
+                continue;
+            int d = (int)block[i][ref] * opaque - sum[ref];
+            for (unsigned c = 0; c < 3; ++c)
+                cov[c] += d * ((int)block[i][c] * opaque - sum[c]);
+        }
+
+        int e0[3], e1[3];
+        for (unsigned c = 0; c < 3; ++c)
+        {
+            // inset the box slightly to reduce the error of the extreme colors
+            int inset = (hi[c] - lo[c]) >> 4;
+            e0[c] = hi[c] - inset;
+            e1[c] = lo[c] + inset;
+            if (cov[c] < 0)
+                std::swap(e0[c], e1[c]);
+        }
+
+        std::uint16_t c0 = to565(e0), c1 = to565(e1);
+
+        // BC1 picks the mode from the endpoint order: c0 > c1 is 4-color.
+        if (any_transparent ? c0 > c1 : c0 < c1)
+            std::swap(c0, c1);
+
+        const bool four_color = bc3 || c0 > c1;
+
+        int palette[4][3];
+        from565(c0, palette[0]);
+        from565(c1, palette[1]);
+        for (unsigned c = 0; c < 3; ++c)
+        {
+            if (four_color)
+            {
+                palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+            }
+            else
+            {
+                palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+            }
+        }
+        const unsigned num_colors = four_color ? 4 : 3;
+
+        std::uint32_t indices = 0;
+        for (unsigned i = 0; i < 16; ++i)
+        {
+            unsigned best = 3;
+            if (!transparent[i])
+            {
+                int best_error = INT_MAX;
+                for (unsigned p = 0; p < num_colors; ++p)
+                {
+                    int dr = block[i].r - palette[p][0], dg = block[i].g - palette[p][1], db = block[i].b - palette[p][2];
+                    int error = dr * dr + dg * dg + db * db;
+                    if (error < best_error)
+                        best_error = error, best = p;
+                }
+            }
+            indices |= best << (2 * i);
+        }
+
+        store(out, c0, 2);
+        store(out + 2, c1, 2);
+        store(out + 4, indices, 4);
+    }
+
+    // Encodes the alpha of a 4x4 block into 8 bytes (BC3), interpolating
+    // 8 values between the block's min and max alpha.
+    void encodeAlphaBlock(const RGBA* block, std::uint8_t* out)
+    {
+        int lo = 255, hi = 0;
+        for (unsigned i = 0; i < 16; ++i)
+        {
+            lo = std::min(lo, (int)block[i].a);
+            hi = std::max(hi, (int)block[i].a);
+        }
+
+        out[0] = (std::uint8_t)hi;
+        out[1] = (std::uint8_t)lo;
+
+        if (hi == lo)
+        {
+            store(out + 2, 0u, 6);
+            return;
+        }
+
+        int palette[8] = { hi, lo };
+        for (int i = 1; i <= 6; ++i)
+            palette[i + 1] = ((7 - i) * hi + i * lo) / 7;
+
+        std::uint64_t indices = 0;
+        for (unsigned i = 0; i < 16; ++i)
+        {
+            unsigned best = 0;
+            int best_error = INT_MAX;
+            for (unsigned p = 0; p < 8; ++p)
+            {
+                int error = std::abs((int)block[i].a - palette[p]);
+                if (error < best_error)
+                    best_error = error, best = p;
+            }
+            indices |= (std::uint64_t)best << (3 * i);
+        }
+
+        store(out + 2, indices, 6);
+    }
+
+    // Encodes a whole level, clamping the blocks that overhang the edges.
+    void encodeLevel(const RGBA* pixels, unsigned w, unsigned h, bool bc3, std::uint8_t* out)
+    {
+        RGBA block[16];
+
+        for (unsigned by = 0; by < h; by += 4)
+        {
+            for (unsigned bx = 0; bx < w; bx += 4)
+            {
+                for (unsigned y = 0; y < 4; ++y)
+                    for (unsigned x = 0; x < 4; ++x)
+                        block[y * 4 + x] = pixels[std::min(by + y, h - 1) * w + std::min(bx + x, w - 1)];
+
+                if (bc3)
+                {
+                    encodeAlphaBlock(block, out);
+                    encodeColorBlock(block, false, true, out + 8);
+                    out += 16;
+                }
+                else
+                {
+                    encodeColorBlock(block, true, false, out);
+                    out += 8;
+                }
+            }
+        }
+    }
+
+    template<class BLOCK>
+    vsg::ref_ptr<vsg::Data> compress(const Image& image, unsigned num_levels, bool bc3, vsg::Data::Properties props)
+    {
+        unsigned w = image.width(), h = image.height();
+        const unsigned bw = (w + 3) / 4, bh = (h + 3) / 4;
+
+        // VSG locates each level by halving the block dimensions.
+        std::size_t num_blocks = 0;
+        for (unsigned i = 0, x = bw, y = bh; i < num_levels; ++i, x = half(x), y = half(y))
+            num_blocks += x * y;
+
+        auto* blocks = new BLOCK[num_blocks];
+        auto* out = reinterpret_cast<std::uint8_t*>(blocks);
+
+        std::vector<RGBA> level(w * h), next;
+        toRGBA(image, level.data());
+
+        for (unsigned i = 0; i < num_levels; ++i)
+        {
+            encodeLevel(level.data(), w, h, bc3, out);
+            out += ((w + 3) / 4) * ((h + 3) / 4) * sizeof(BLOCK);
+
+            if (i + 1 < num_levels)
+            {
+                next.resize(half(w) * half(h));
+                downsample(level.data(), w, h, next.data());
+                level.swap(next);
+                w = half(w), h = half(h);
+            }
+        }
+
+        props.format = bc3 ? VK_FORMAT_BC3_UNORM_BLOCK : VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+        props.blockWidth = 4;
+        props.blockHeight = 4;
+
+        return vsg::Array2D<BLOCK>::create(bw, bh, blocks, props);
+    }
+}
+
+TextureEncoder::TextureEncoder(const TerrainSettings& settings)
+{
+    mipmaps = settings.mipmapColor;
+
+    auto value = util::toLower(settings.colorCompression);
+    if (value == "bc1")
+        compression = Compression::BC1;
+    else if (value == "bc3")
+        compression = Compression::BC3;
+    else if (value != "none" && !value.empty())
+        Log()->warn(LC "Unsupported color compression \"" + value + "\"; using none");
+}
+
+vsg::ref_ptr<vsg::Data>
+TextureEncoder::encode(const Image& image) const
+{
+    if (!enabled() || !image.valid() || image.depth() != 1)
+        return {};
+
+    if (image.pixelFormat() != Image::R8G8B8A8_UNORM && image.pixelFormat() != Image::R8G8B8_UNORM)
+        return {};
+
+    const unsigned w = image.width(), h = image.height();
+
+    // block mip chains only line up with VSG's level offsets when
+    // every level halves evenly, so compress power-of-two images only.
+    auto method = compression;
+    if (method != Compression::NONE && !(isPowerOfTwo(w) && isPowerOfTwo(h)))
+        method = Compression::NONE;
+
+    // count levels the way VSG does: until the (block) dimensions reach 1x1.
+    unsigned num_levels = 1;
+    if (mipmaps)
+    {
+        unsigned x = method == Compression::NONE ? w : (w + 3) / 4;
+        unsigned y = method == Compression::NONE ? h : (h + 3) / 4;
+        for (; x > 1 || y > 1; x = half(x), y = half(y))
+            ++num_levels;
+    }
+
+    vsg::Data::Properties props;
+    props.allocatorType = vsg::ALLOCATOR_TYPE_NEW_DELETE;
+    props.origin = vsg::TOP_LEFT;
+    props.maxNumMipmaps = num_levels;
+
+    if (method == Compression::BC1)
+        return compress<vsg::block64>(image, num_levels, false, props);
+
+    if (method == Compression::BC3)
+        return compress<vsg::block128>(image, num_levels, true, props);
+
+    std::size_t num_pixels = 0;
+    for (unsigned i = 0, x = w, y = h; i < num_levels; ++i, x = half(x), y = half(y))
+        num_pixels += x * y;
+
+    auto* pixels = new RGBA[num_pixels];
+    toRGBA(image, pixels);
+
+    RGBA* level = pixels;
+    for (unsigned i = 1, x = w, y = h; i < num_levels; ++i, x = half(x), y = half(y))
+    {
+        downsample(level, x, y, level + x * y);
+        level += x * y;
+    }
+
+    props.format = VK_FORMAT_R8G8B8A8_UNORM;
+    return vsg::ubvec4Array2D::create(w, h, pixels, props);
+}
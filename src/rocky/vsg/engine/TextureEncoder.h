@@ -0,0 +1,56 @@
+/**
+ * rocky c++
+ * Copyright 2023 Pelican Mapping
+ * MIT License
+ */
+#pragma once
+
+#include <rocky/vsg/Common.h>
+#include <rocky/Image.h>
+#include <vsg/core/Data.h>
+
+namespace ROCKY_NAMESPACE
+{
+    class TerrainSettings;
+
+    /**
+     * Prepares terrain color textures for the GPU on the loader threads.
+     *
+     * Builds a box-filtered mipmap chain and optionally block-compresses
+     * every level (BC1 or BC3), producing a vsg::Data that VSG can upload
+     * without further processing. Compression cuts the VRAM and upload
+     * bandwidth of a color tile by 4x (BC3) or 8x (BC1).
+     */
+    class ROCKY_EXPORT TextureEncoder
+    {
+    public:
+        enum class Compression
+        {
+            NONE,   // 8-bit RGBA
+            BC1,    // 4 bits per pixel, 1-bit alpha
+            BC3     // 8 bits per pixel, 8-bit alpha
+        };
+
+        //! Construct an encoder that does nothing
+        TextureEncoder() = default;
+
+        //! Construct an encoder configured by the terrain settings
+        TextureEncoder(const TerrainSettings& settings);
+
+        //! Whether to generate a mipmap chain
+        bool mipmaps = false;
+
+        //! Compression to apply to each level
+        Compression compression = Compression::NONE;
+
+        //! Whether encode() will do any work
+        bool enabled() const {
+            return mipmaps || compression != Compression::NONE;
+        }
+
+        //! Encodes an 8-bit RGB or RGBA image.
+        //! @return GPU-ready data, or nullptr if the image is not in a supported
+        //!   format (in which case upload the image as usual)
+        vsg::ref_ptr<vsg::Data> encode(const Image& image) const;
+    };
+}
@@ -153,6 +153,9 @@ namespace ROCKY_NAMESPACE
             if (!image)
                 return {};
 
+            // the data must be ordered bottom-up (which vsg calls TOP_LEFT)
+            image->convertOrigin(Image::BOTTOM_LEFT);
+
             auto data = moveImageData(image);
             data->properties.origin = vsg::TOP_LEFT;
             data->properties.maxNumMipmaps = 1;
@@ -160,6 +163,65 @@ namespace ROCKY_NAMESPACE
             return data;
         }
 
+        //! VSG array that references the pixels of a rocky Image instead of
+        //! owning a copy. It keeps the Image alive until VSG releases it.
+        template<class ARRAY>
+        class ImageArray : public ARRAY
+        {
+        public:
+            ImageArray(shared_ptr<Image> image, const vsg::Data::Properties& props) :
+                ARRAY(image->width(), image->height(), image->data<typename ARRAY::value_type>(), props),
+                _image(image) { }
+
+        private:
+            shared_ptr<Image> _image;
+        };
+
+        template<typename T>
+        vsg::ref_ptr<vsg::Data> share(shared_ptr<Image> image, VkFormat format)
+        {
+            vsg::Data::Properties props;
+            props.format = format;
+            props.allocatorType = vsg::ALLOCATOR_TYPE_NO_DELETE; // the Image owns the memory
+            props.origin = vsg::TOP_LEFT;
+            props.maxNumMipmaps = 1;
+
+            return vsg::ref_ptr<vsg::Data>(new ImageArray<vsg::Array2D<T>>(image, props));
+        }
+
+        // Create a VSG object that shares the image's pixels without copying them.
+        // The image stays valid, but must not be modified afterwards, since VSG may
+        // read it at any time until it is uploaded. Images whose rows are not in the
+        // order VSG expects (or that have more than one layer) are copied once.
+        inline vsg::ref_ptr<vsg::Data> shareImageWithVSG(shared_ptr<Image> image)
+        {
+            if (!image || !image->valid())
+                return {};
+
+            if (image->origin() != Image::BOTTOM_LEFT || image->depth() > 1)
+                return moveImageToVSG(image->clone(Image::BOTTOM_LEFT));
+
+            switch (image->pixelFormat())
+            {
+            case Image::R8_UNORM:
+                return share<unsigned char>(image, VK_FORMAT_R8_UNORM);
+            case Image::R8G8_UNORM:
+                return share<vsg::ubvec2>(image, VK_FORMAT_R8G8_UNORM);
+            case Image::R8G8B8_UNORM:
+                return share<vsg::ubvec3>(image, VK_FORMAT_R8G8B8_UNORM);
+            case Image::R8G8B8A8_UNORM:
+                return share<vsg::ubvec4>(image, VK_FORMAT_R8G8B8A8_UNORM);
+            case Image::R16_UNORM:
+                return share<unsigned short>(image, VK_FORMAT_R16_UNORM);
+            case Image::R32_SFLOAT:
+                return share<float>(image, VK_FORMAT_R32_SFLOAT);
+            case Image::R64_SFLOAT:
+                return share<double>(image, VK_FORMAT_R64_SFLOAT);
+            default:
+                return {};
+            };
+        }
+
         // Convert a vsg::Data structure to an Image if possible
         inline Result<shared_ptr<Image>> makeImageFromVSG(vsg::ref_ptr<vsg::Data> data)
         {
@@ -184,17 +246,44 @@ namespace ROCKY_NAMESPACE
                 return Status(Status::ResourceUnavailable, "Unsupported image format");
             }
 
-            auto image = Image::create(
-                format,
-                data->width(),
-                data->height(),
-                data->depth());
+            // vsg's TOP_LEFT means the first row in memory is the top of the image.
+            auto origin = data->properties.origin == vsg::TOP_LEFT ?
+                Image::TOP_LEFT :
+                Image::BOTTOM_LEFT;
 
-            memcpy(image->data<uint8_t>(), data->dataPointer(), image->sizeInBytes());
+            shared_ptr<Image> image;
 
-            if (data->properties.origin == vsg::TOP_LEFT)
+            if (data->stride() == data->valueSize())
+            {
+                // tightly packed: reference the decoded pixels directly, holding
+                // a reference to the vsg object for as long as the image lives.
+                image = Image::create(
+                    format,
+                    data->width(),
+                    data->height(),
+                    data->depth(),
+                    static_cast<unsigned char*>(data->dataPointer()),
+                    std::make_shared<vsg::ref_ptr<vsg::Data>>(data),
+                    origin);
+            }
+            else
             {
-                image->flipVerticalInPlace();
+                image = Image::create(
+                    format,
+                    data->width(),
+                    data->height(),
+                    data->depth());
+
+                auto src = static_cast<const unsigned char*>(data->dataPointer());
+                auto stride = data->stride();
+                auto pixel_size = image->sizeInBytes() / image->sizeInPixels();
+                auto dst = image->data<unsigned char>();
+
+                for (unsigned i = 0; i < image->sizeInPixels(); ++i, src += stride, dst += pixel_size)
+                    memcpy(dst, src, pixel_size);
+
+                if (origin == Image::TOP_LEFT)
+                    image->flipVerticalInPlace();
             }
 
             return Result(image);
@@ -2,6 +2,7 @@
 
 #pragma import_defines(ROCKY_LIGHTING)
 #pragma import_defines(ROCKY_WIREFRAME_OVERLAY)
+#pragma import_defines(ROCKY_INDIRECT)
 
 layout(push_constant) uniform PushConstants {
     mat4 projection;
@@ -20,8 +21,16 @@ struct RockyVaryings {
 layout(location = 0) in RockyVaryings varyings;
 
 // uniforms
+#if defined(ROCKY_INDIRECT)
+// see rocky::TerrainState::tileTableSize
+#define TILE_TABLE_SIZE 2048
+layout(set = 0, binding = 16) uniform sampler2D color_tex_array[TILE_TABLE_SIZE];
+layout(location = 8) flat in int tile_index;
+#define color_tex color_tex_array[tile_index]
+#else
 layout(set = 0, binding = 11) uniform sampler2D color_tex;
 layout(set = 0, binding = 12) uniform sampler2D normal_tex;
+#endif
 
 #if defined(ROCKY_LIGHTING)
 #include "rocky.lighting.frag.glsl"
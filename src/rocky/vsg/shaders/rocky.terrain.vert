@@ -1,8 +1,12 @@
 #version 450
 #pragma import_defines(ROCKY_LIGHTING)
 #pragma import_defines(ROCKY_ATMOSPHERE)
+#pragma import_defines(ROCKY_MORPHING)
+#pragma import_defines(ROCKY_INDIRECT)
 
-layout(set = 0, binding = 10) uniform sampler2D elevation_tex;
+// see GeometryPool.h
+#define VERTEX_MORPH_U 32
+#define VERTEX_MORPH_V 64
 
 layout(push_constant) uniform PushConstants
 {
@@ -10,6 +14,41 @@ layout(push_constant) uniform PushConstants
     mat4 modelview;
 } pc;
 
+#if defined(ROCKY_INDIRECT)
+
+// see rocky::TerrainState::tileTableSize
+#define TILE_TABLE_SIZE 2048
+
+// see rocky::TerrainTileDescriptors
+struct TileData
+{
+    mat4 elevation_matrix;
+    mat4 color_matrix;
+    mat4 normal_matrix;
+    mat4 model_matrix;
+    vec4 morph; // start range, end range, uv step, unused
+    vec4 elevation_decode; // texel scale, offset, unused, unused
+};
+
+// every tile's uniforms and elevation texture, indexed by tile table slot
+layout(set = 0, binding = 15) buffer TileTable {
+    TileData tiles[TILE_TABLE_SIZE];
+} tile_table;
+
+layout(set = 0, binding = 17) uniform sampler2D elevation_tex_array[TILE_TABLE_SIZE];
+
+// per draw: tile origin relative to the eye, tile table slot (see rocky::TerrainDrawBatch)
+layout(location = 5) in vec4 in_tile;
+
+layout(location = 8) flat out int tile_index;
+
+#define tile tile_table.tiles[int(in_tile.w)]
+#define elevation_tex elevation_tex_array[int(in_tile.w)]
+
+#else
+
+layout(set = 0, binding = 10) uniform sampler2D elevation_tex;
+
 // see rocky::TerrainTileDescriptors
 layout(set = 0, binding = 13) uniform TileData
 {
@@ -17,12 +56,31 @@ layout(set = 0, binding = 13) uniform TileData
     mat4 color_matrix;
     mat4 normal_matrix;
     mat4 model_matrix;
+    vec4 morph; // start range, end range, uv step, unused
+    vec4 elevation_decode; // texel scale, offset, unused, unused
 } tile;
 
+#endif
+
+// see rocky::TerrainState::TerrainUniforms
+layout(set = 0, binding = 14) uniform TerrainData
+{
+    float lod_pixels; // tile pixel size + screen space error
+} terrain;
+
+// vsg viewport data
+layout(set = 1, binding = 1) buffer VSG_Viewports {
+    vec4 viewport[1]; // x, y, width, height
+} vsg_viewports;
+
 // input vertex attributes
 layout(location = 0) in vec3 in_vertex;
 layout(location = 1) in vec3 in_normal;
 layout(location = 2) in vec3 in_uvw;
+#if defined(ROCKY_MORPHING)
+layout(location = 3) in vec3 in_vertex_neighbor;
+layout(location = 4) in vec3 in_normal_neighbor;
+#endif
 
 // inter-stage interface block
 struct RockyVaryings {
@@ -44,6 +102,17 @@ out gl_PerVertex {
     vec4 gl_Position;
 };
 
+// transform a tile-local position to view space
+vec4 terrain_to_view(in vec3 position)
+{
+#if defined(ROCKY_INDIRECT)
+    // the modelview is centered on the eye, and so is the tile origin
+    return pc.modelview * vec4(mat3(tile.model_matrix) * position + in_tile.xyz, 1.0);
+#else
+    return pc.modelview * vec4(position, 1.0);
+#endif
+}
+
 // sample the elevation data at a UV tile coordinate
 float terrain_get_elevation(in vec2 uv)
 {
@@ -57,21 +126,68 @@ float terrain_get_elevation(in vec2 uv)
         + coeff.x * tile.elevation_matrix[3].st // bias
         + coeff.y;
 
-    return texture(elevation_tex, elevc).r;
+    // quantized elevation textures hold normalized codes
+    return texture(elevation_tex, elevc).r * tile.elevation_decode.x + tile.elevation_decode.y;
+}
+
+#if defined(ROCKY_MORPHING)
+// Blend a vertex toward its position on the parent tile's surface as it
+// nears the range at which the parent takes over. This is the same metric
+// TerrainTileNode uses to select LODs (vsg::State::lodDistance times the
+// screen height ratio), so a tile has fully become its parent by the time
+// it swaps, and matches a coarser neighbor along their shared edge.
+vec3 terrain_morph(in vec3 position)
+{
+    int marker = int(in_uvw.z);
+    vec2 dir = vec2(
+        (marker & VERTEX_MORPH_U) != 0 ? 1.0 : 0.0,
+        (marker & VERTEX_MORPH_V) != 0 ? 1.0 : 0.0);
+
+    // no parent, not a morphing vertex, or an orthographic camera:
+    if (tile.morph.y <= 0.0 || dot(dir, dir) == 0.0 || pc.projection[3][3] != 0.0)
+        return position;
+
+    mat4 mv = pc.modelview;
+    float scale = abs(pc.projection[1][1]) * 0.5 * sqrt(
+        dot(mv[0].xy, mv[0].xy) + dot(mv[1].xy, mv[1].xy) + dot(mv[2].xy, mv[2].xy));
+    float depth = abs(terrain_to_view(position).z);
+    float range = (depth / scale) * terrain.lod_pixels / vsg_viewports.viewport[0].w;
+
+    float m = clamp((range - tile.morph.x) / (tile.morph.y - tile.morph.x), 0.0, 1.0);
+    if (m == 0.0)
+        return position;
+
+    // the parent surface is linear between the two parent vertices this one splits
+    vec2 d = dir * tile.morph.z;
+    float parent_elevation = 0.5 * (
+        terrain_get_elevation(in_uvw.st - d) +
+        terrain_get_elevation(in_uvw.st + d));
+
+    vec3 parent_position = in_vertex_neighbor + in_normal_neighbor*parent_elevation;
+    return mix(position, parent_position, m);
 }
+#endif
 
 void main()
 {
     float elevation = terrain_get_elevation(in_uvw.st);
     vec3 position = in_vertex + in_normal*elevation;
-    vec4 position_view = pc.modelview * vec4(position, 1.0);
+#if defined(ROCKY_MORPHING)
+    position = terrain_morph(position);
+#endif
+    vec4 position_view = terrain_to_view(position);
 
 #if defined(ROCKY_ATMOSPHERE)
     atmos_vertex_main(position_view.xyz);
 #endif
 
     mat3 normal_matrix = mat3(transpose(inverse(pc.modelview)));
+#if defined(ROCKY_INDIRECT)
+    varyings.up_view = normal_matrix * (mat3(tile.model_matrix) * in_normal);
+    tile_index = int(in_tile.w);
+#else
     varyings.up_view = normal_matrix * in_normal;
+#endif
     
     varyings.color = vec4(0.5); // placeholder
     varyings.uv = (tile.color_matrix * vec4(in_uvw.st, 0, 1)).st;
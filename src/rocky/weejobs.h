@@ -12,6 +12,7 @@
 #include <cstdlib>
 #include <functional>
 #include <list>
+#include <memory>
 #include <mutex>
 #include <thread>
 #include <type_traits>
@@ -257,6 +258,20 @@ namespace WEEJOBS_NAMESPACE
         bool can_cancel = true; // if true, the job will cancel if its future goes out of scope
     };
 
+    /**
+    * Timing of one job, reported to the job observer (see set_job_observer)
+    * after the job runs or cancels.
+    */
+    struct job_timing
+    {
+        const std::string& pool; // name of the pool that ran the job
+        const context& ctx; // the job's context
+        std::chrono::steady_clock::time_point queued; // when the job was dispatched
+        std::chrono::steady_clock::time_point started; // when a thread picked it up
+        std::chrono::steady_clock::time_point finished; // when it returned
+        bool canceled; // true if the job was canceled instead of running
+    };
+
     /**
      * Future holds the future result of an asynchronous operation.
      *
@@ -474,6 +489,7 @@ namespace WEEJOBS_NAMESPACE
         {
             context ctx;
             std::function<bool()> _delegate;
+            std::chrono::steady_clock::time_point _queued;
 
             bool operator < (const job& rhs) const
             {
@@ -577,7 +593,7 @@ namespace WEEJOBS_NAMESPACE
                 {
                     std::lock_guard<std::mutex> lock(_queue_mutex);
 
-                    _queue.emplace_back(detail::job{ context, delegate });
+                    _queue.emplace_back(detail::job{ context, delegate, std::chrono::steady_clock::now() });
                     _queue_size++;
 
                     _metrics.pending++;
@@ -715,6 +731,7 @@ namespace WEEJOBS_NAMESPACE
             std::vector<jobpool*> _pools;
             metrics _metrics;
             std::function<void(const char*)> _set_thread_name;
+            std::shared_ptr<std::function<void(const job_timing&)>> _job_observer;
         };
     }
 
@@ -854,6 +871,16 @@ namespace WEEJOBS_NAMESPACE
         instance()._set_thread_name = f;
     }
 
+    //! Install a function to call after every job runs (or cancels), from the
+    //! thread that ran it. Pass nullptr to remove it. Keep it quick; it runs
+    //! between jobs.
+    inline void set_job_observer(std::function<void(const job_timing&)> f)
+    {
+        std::atomic_store(&instance()._job_observer, f ?
+            std::make_shared<std::function<void(const job_timing&)>>(std::move(f)) :
+            std::shared_ptr<std::function<void(const job_timing&)>>());
+    }
+
     //! Whether to allow jobpools to steal work from other jobpools when they are idle.
     inline void set_allow_work_stealing(bool value)
     {
@@ -933,13 +960,19 @@ namespace WEEJOBS_NAMESPACE
 
                 bool job_executed = next._delegate();
 
-                auto duration = std::chrono::steady_clock::now() - t0;
+                auto t1 = std::chrono::steady_clock::now();
 
                 if (job_executed == false)
                 {
                     _metrics.canceled++;
                 }
 
+                auto observer = std::atomic_load(&instance()._job_observer);
+                if (observer)
+                {
+                    (*observer)(job_timing{ _metrics.name, next.ctx, next._queued, t0, t1, !job_executed });
+                }
+
                 // release the group semaphore if necessary
                 if (next.ctx.group != nullptr)
                 {
@@ -1,7 +1,10 @@
 #pragma once
-#include "rtree.h"
 #include <cmath>
+#include <cfloat>
 #include <climits>
+#include <cstdint>
+#include <algorithm>
+#include <vector>
 #include <map>
 #include <unordered_map>
 #include <iterator>
@@ -18,6 +21,8 @@ namespace weemesh
 
     using UID = std::uint32_t;
 
+    constexpr UID invalid_uid = ~UID(0);
+
     constexpr double DEFAULT_EPSILON = 0.00015;
 
     template<typename T>
@@ -112,12 +117,82 @@ namespace weemesh
     }
 
 
-    // uniquely map vertices to indices
-    using vert_table_t = std::map<vert_t, int>;
-
     // array of vert_t's
     using vert_array_t = std::vector<vert_t>;
 
+    // packs two signed cell coordinates into a single hash key
+    inline std::uint64_t cell_key(int ix, int iy)
+    {
+        return ((std::uint64_t)(std::uint32_t)ix << 32) | (std::uint64_t)(std::uint32_t)iy;
+    }
+
+    // grid cell holding coordinate v. Clamps before the cast so that huge
+    // coordinates (or tiny cells) can't overflow an int or the cell loops.
+    inline int cell_index(double v, double inv_cell_size)
+    {
+        constexpr double limit = (double)(1 << 30);
+        double c = std::floor(v * inv_cell_size);
+        if (c != c)
+            return 0; // an infinite coordinate in a zero-inverse (unbounded) cell
+        return (int)(c > -limit ? (c < limit ? c : limit) : -limit);
+    }
+
+    // uniquely map vertices to indices. Vertices are welded, i.e. any two
+    // verts closer than epsilon (in XY) resolve to the same index. Lookups
+    // hash the vert into a grid of cells a few epsilons wide and only compare
+    // against the verts in the cells that the epsilon box touches.
+    struct vert_table_t
+    {
+        std::unordered_map<std::uint64_t, std::vector<int>> _cells;
+        double _epsilon = 0.0;
+        double _inv_cell_size = 0.0;
+
+        void set_epsilon(double value)
+        {
+            _epsilon = value;
+            _inv_cell_size = 1.0 / (8.0 * value);
+        }
+
+        inline int cell(double v) const
+        {
+            return cell_index(v, _inv_cell_size);
+        }
+
+        // index of a vert within epsilon of "v", or -1
+        int find(const vert_t& v, const vert_array_t& verts, double epsilon) const
+        {
+            if (_cells.empty())
+                return -1;
+
+            int x0 = cell(v.x - epsilon), x1 = cell(v.x + epsilon);
+            int y0 = cell(v.y - epsilon), y1 = cell(v.y + epsilon);
+            for (int ix = x0; ix <= x1; ++ix)
+            {
+                for (int iy = y0; iy <= y1; ++iy)
+                {
+                    auto i = _cells.find(cell_key(ix, iy));
+                    if (i != _cells.end())
+                    {
+                        for (int index : i->second)
+                            if (same_vert(verts[index], v, epsilon))
+                                return index;
+                    }
+                }
+            }
+            return -1;
+        }
+
+        void insert(const vert_t& v, int index)
+        {
+            _cells[cell_key(cell(v.x), cell(v.y))].push_back(index);
+        }
+
+        void clear()
+        {
+            _cells.clear();
+        }
+    };
+
     // line segment connecting two verts
     struct segment_t : std::pair<vert_t, vert_t>
     {
@@ -156,6 +231,15 @@ namespace weemesh
         vert_t::value_type a_min[2]; // bbox min
         vert_t::value_type a_max[2]; // bbox max
         bool is_2d_degenerate;
+        bool alive = true; // false once removed from the mesh
+
+        // true if the triangle's bbox overlaps the box [min, max]
+        inline bool overlaps(const vert_t::value_type* min, const vert_t::value_type* max) const
+        {
+            return
+                a_min[0] <= max[0] && a_max[0] >= min[0] &&
+                a_min[1] <= max[1] && a_max[1] >= min[1];
+        }
 
         // true if the triangle contains point P (in xy) within
         // a certain tolerance.
@@ -236,7 +320,259 @@ namespace weemesh
         }
     };
 
-    using spatial_index_t = RTree<UID, vert_t::value_type, 2>;
+    // Contiguous triangle storage. Removing a triangle leaves a hole that
+    // the next insertion recycles via a free list, so UIDs are simply slot
+    // indices and adding/removing triangles does not allocate once warmed up.
+    // Iteration skips removed slots.
+    struct triangle_table_t
+    {
+        std::vector<triangle_t> _data;
+        std::vector<UID> _free;
+        std::size_t _size = 0;
+
+        template<class TABLE, class T>
+        class iterator_t
+        {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = triangle_t;
+            using difference_type = std::ptrdiff_t;
+            using pointer = T*;
+            using reference = T&;
+
+            iterator_t(TABLE& table, std::size_t i) : _table(table), _i(i) { skip(); }
+            reference operator*() const { return _table._data[_i]; }
+            pointer operator->() const { return &_table._data[_i]; }
+            iterator_t& operator++() { ++_i; skip(); return *this; }
+            bool operator==(const iterator_t& rhs) const { return _i == rhs._i; }
+            bool operator!=(const iterator_t& rhs) const { return _i != rhs._i; }
+
+        private:
+            TABLE& _table;
+            std::size_t _i;
+            void skip() { while (_i < _table._data.size() && !_table._data[_i].alive) ++_i; }
+        };
+
+        using iterator = iterator_t<triangle_table_t, triangle_t>;
+        using const_iterator = iterator_t<const triangle_table_t, const triangle_t>;
+
+        iterator begin() { return iterator(*this, 0); }
+        iterator end() { return iterator(*this, _data.size()); }
+        const_iterator begin() const { return const_iterator(*this, 0); }
+        const_iterator end() const { return const_iterator(*this, _data.size()); }
+
+        // number of live triangles
+        std::size_t size() const { return _size; }
+        bool empty() const { return _size == 0; }
+
+        // true if "uid" refers to a live triangle
+        bool contains(UID uid) const {
+            return uid < _data.size() && _data[uid].alive;
+        }
+
+        triangle_t& operator[](UID uid) { return _data[uid]; }
+        const triangle_t& operator[](UID uid) const { return _data[uid]; }
+
+        // stores a triangle and returns its new UID.
+        // Note: this may invalidate references to other triangles.
+        UID emplace(triangle_t& tri)
+        {
+            if (!_free.empty())
+            {
+                tri.uid = _free.back();
+                _free.pop_back();
+                tri.alive = true;
+                _data[tri.uid] = tri;
+            }
+            else
+            {
+                tri.uid = (UID)_data.size();
+                tri.alive = true;
+                _data.push_back(tri);
+            }
+            ++_size;
+            return tri.uid;
+        }
+
+        void erase(UID uid)
+        {
+            if (contains(uid))
+            {
+                _data[uid].alive = false;
+                _free.push_back(uid);
+                --_size;
+            }
+        }
+
+        void reserve(std::size_t n)
+        {
+            _data.reserve(n);
+        }
+
+        void clear()
+        {
+            _data.clear();
+            _free.clear();
+            _size = 0;
+        }
+    };
+
+    // Hierarchical spatial hash of triangle bounding boxes. Each triangle goes
+    // into the grid level whose cell size is just larger than the triangle, so
+    // it occupies at most 4 cells and small triangles never crowd a coarse cell.
+    // Removal is lazy: entries for dead (or recycled) triangles are purged
+    // from a cell the next time a search visits it.
+    struct spatial_index_t
+    {
+        struct level_t
+        {
+            double cell_size;
+            double inv_cell_size;
+            std::unordered_map<std::uint64_t, std::vector<UID>> cells;
+        };
+
+        std::map<int, level_t> _levels;
+        double _base_cell_size = 0.0;
+
+        // base cell size; should approximate the typical triangle size.
+        // only call this while the index is empty
+        void set_cell_size(double value)
+        {
+            _base_cell_size = value;
+            _levels.clear();
+        }
+
+        bool has_cell_size() const
+        {
+            return _base_cell_size > 0.0;
+        }
+
+        level_t& get_level(double size)
+        {
+            // Clamp in floating point; the log of a huge (or infinite) size
+            // would overflow the cast. Triangles too big for the coarsest
+            // level all share the single cell of an unbounded level.
+            double exponent = size > 0.0 ? std::ceil(std::log2(size / _base_cell_size)) : -64.0;
+            int L = exponent > 64.0 ? INT_MAX : (int)(exponent > -64.0 ? exponent : -64.0);
+            auto i = _levels.find(L);
+            if (i == _levels.end())
+            {
+                double cell_size = L == INT_MAX ? HUGE_VAL : std::ldexp(_base_cell_size, L);
+                i = _levels.emplace(L, level_t{ cell_size, 1.0 / cell_size, {} }).first;
+            }
+            return i->second;
+        }
+
+        void insert(const triangle_t& tri)
+        {
+            auto& level = get_level(std::max(tri.a_max[0] - tri.a_min[0], tri.a_max[1] - tri.a_min[1]));
+
+            int x0 = cell_index(tri.a_min[0], level.inv_cell_size), x1 = cell_index(tri.a_max[0], level.inv_cell_size);
+            int y0 = cell_index(tri.a_min[1], level.inv_cell_size), y1 = cell_index(tri.a_max[1], level.inv_cell_size);
+
+            for (int ix = x0; ix <= x1; ++ix)
+                for (int iy = y0; iy <= y1; ++iy)
+                    level.cells[cell_key(ix, iy)].push_back(tri.uid);
+        }
+
+        // collects the UIDs of all live triangles whose bbox overlaps [a_min, a_max].
+        // Output is unique and sorted.
+        void search(const vert_t::value_type* a_min, const vert_t::value_type* a_max,
+            const triangle_table_t& table, std::vector<UID>& output)
+        {
+            output.clear();
+
+            for (auto& level_iter : _levels)
+            {
+                auto& level = level_iter.second;
+
+                if (level.cells.empty())
+                    continue;
+
+                // triangles are registered in every cell they overlap
+                int x0 = cell_index(a_min[0], level.inv_cell_size), x1 = cell_index(a_max[0], level.inv_cell_size);
+                int y0 = cell_index(a_min[1], level.inv_cell_size), y1 = cell_index(a_max[1], level.inv_cell_size);
+
+                std::size_t span = (std::size_t)(x1 - x0 + 1) * (std::size_t)(y1 - y0 + 1);
+
+                if (span > level.cells.size())
+                {
+                    // cheaper to visit every occupied cell
+                    for (auto c = level.cells.begin(); c != level.cells.end(); )
+                    {
+                        int ix = (int)(std::int32_t)(std::uint32_t)(c->first >> 32);
+                        int iy = (int)(std::int32_t)(std::uint32_t)(c->first & 0xFFFFFFFF);
+                        if (visit(level, ix, iy, c->second, a_min, a_max, table, output))
+                            ++c;
+                        else
+                            c = level.cells.erase(c);
+                    }
+                }
+                else
+                {
+                    for (int ix = x0; ix <= x1; ++ix)
+                    {
+                        for (int iy = y0; iy <= y1; ++iy)
+                        {
+                            auto c = level.cells.find(cell_key(ix, iy));
+                            if (c != level.cells.end())
+                            {
+                                if (!visit(level, ix, iy, c->second, a_min, a_max, table, output))
+                                    level.cells.erase(c);
+                            }
+                        }
+                    }
+                }
+            }
+
+            // a triangle spanning multiple cells will appear more than once:
+            std::sort(output.begin(), output.end());
+            output.erase(std::unique(output.begin(), output.end()), output.end());
+        }
+
+        // purges stale entries from one cell and collects the hits.
+        // returns false if the cell is now empty.
+        inline bool visit(const level_t& level, int ix, int iy, std::vector<UID>& uids,
+            const vert_t::value_type* a_min, const vert_t::value_type* a_max,
+            const triangle_table_t& table, std::vector<UID>& output)
+        {
+            vert_t::value_type c_min[2] = { ix * level.cell_size, iy * level.cell_size };
+            vert_t::value_type c_max[2] = { (ix + 1) * level.cell_size, (iy + 1) * level.cell_size };
+
+            // the unbounded level's one cell covers everything
+            if (level.inv_cell_size == 0.0)
+            {
+                c_min[0] = c_min[1] = -DBL_MAX;
+                c_max[0] = c_max[1] = DBL_MAX;
+            }
+
+            std::size_t keep = 0;
+            for (std::size_t k = 0; k < uids.size(); ++k)
+            {
+                UID uid = uids[k];
+                if (!table.contains(uid))
+                    continue;
+
+                auto& tri = table[uid];
+
+                // a recycled UID may be stale in this cell:
+                if (!tri.overlaps(c_min, c_max))
+                    continue;
+
+                uids[keep++] = uid;
+
+                if (tri.overlaps(a_min, a_max))
+                    output.push_back(uid);
+            }
+            uids.resize(keep);
+            return keep > 0;
+        }
+
+        void clear()
+        {
+            _levels.clear();
+        }
+    };
 
     // a mesh edge connecting to verts
     struct edge_t
@@ -263,12 +599,13 @@ namespace weemesh
     // connected mesh of triangles, verts, and associated markers
     struct mesh_t
     {
-        int uidgen = 0;
-        std::unordered_map<UID, triangle_t> triangles;
+        triangle_table_t triangles;
         vert_array_t verts;
         std::vector<int> markers;
         vert_t::value_type epsilon = DEFAULT_EPSILON;
 
+        // maximum number of vertices the mesh will create
+        std::size_t max_verts = 0xFFFF;
 
         spatial_index_t _spatial_index;
         vert_table_t _vert_lut;
@@ -277,6 +614,10 @@ namespace weemesh
         int _constraint_marker = 16;
         int _has_elevation_marker = 4;
 
+        // scratch space reused across inserts
+        std::vector<UID> _search_results;
+        std::vector<UID> _work_list;
+
         mesh_t()
         {
             //nop
@@ -297,27 +638,46 @@ namespace weemesh
             _has_elevation_marker = value;
         }
 
+        // cell size for the spatial index; ideally about the size of a
+        // typical triangle. If not set, the first triangle added decides.
+        void set_spatial_index_cell_size(double value)
+        {
+            _spatial_index.set_cell_size(value);
+        }
+
+        // pre-allocate storage
+        void reserve(std::size_t num_verts, std::size_t num_triangles)
+        {
+            verts.reserve(num_verts);
+            markers.reserve(num_verts);
+            triangles.reserve(num_triangles);
+        }
+
         // delete triangle from the mesh
-        void remove_triangle(triangle_t& tri)
+        void remove_triangle(UID uid)
         {
-            UID uid = tri.uid;
-            _spatial_index.Remove(tri.a_min, tri.a_max, uid);
+            // the spatial index purges the UID lazily
             triangles.erase(uid);
 
             ++_num_edits;
         }
 
+        // delete triangle from the mesh
+        void remove_triangle(const triangle_t& tri)
+        {
+            remove_triangle(tri.uid);
+        }
+
         const double one_third = 1.0 / 3.0;
 
         // add new triangle to the mesh from 3 indices
+        // Note: this may invalidate references to existing triangles.
         UID add_triangle(int i0, int i1, int i2)
         {
             if (i0 == i1 || i1 == i2 || i2 == i0)
-                return -1;
+                return invalid_uid;
 
-            UID uid(uidgen++);
             triangle_t tri;
-            tri.uid = uid;
             tri.i0 = i0;
             tri.i1 = i1;
             tri.i2 = i2;
@@ -340,8 +700,14 @@ namespace weemesh
                 same_vert((tri.p2 - tri.p1).normalize2d(), (tri.p0 - tri.p1).normalize2d(), epsilon) ||
                 same_vert((tri.p0 - tri.p2).normalize2d(), (tri.p1 - tri.p2).normalize2d(), epsilon);
 
-            triangles.emplace(uid, tri);
-            _spatial_index.Insert(tri.a_min, tri.a_max, uid);
+            if (!_spatial_index.has_cell_size())
+            {
+                auto size = std::max(tri.a_max[0] - tri.a_min[0], tri.a_max[1] - tri.a_min[1]);
+                _spatial_index.set_cell_size(size > epsilon ? size : 1.0);
+            }
+
+            UID uid = triangles.emplace(tri);
+            _spatial_index.insert(tri);
 
             ++_num_edits;
 
@@ -360,10 +726,12 @@ namespace weemesh
             return verts[i];
         }
 
-        // find the marker for a vertex
-        int& get_marker(const vert_t& vert)
+        // find the marker for a vertex, or nullptr if the vertex
+        // isn't in the mesh
+        int* get_marker(const vert_t& vert)
         {
-            return markers[_vert_lut[vert]];
+            int index = _vert_lut.find(vert, verts, epsilon);
+            return index >= 0 ? &markers[index] : nullptr;
         }
 
         // find the marker for a vertex index
@@ -376,19 +744,20 @@ namespace weemesh
         // If the vertex already exists, update its marker if necessary.
         int get_or_create_vertex(const vert_t& input, int marker)
         {
-            int index;
-            vert_table_t::iterator i = _vert_lut.find(input);
-            if (i != _vert_lut.end())
+            int index = _vert_lut.find(input, verts, epsilon);
+            if (index >= 0)
             {
-                index = i->second;
-                markers[i->second] |= marker;
+                markers[index] |= marker;
             }
-            else if (verts.size() + 1 < 0xFFFF)
+            else if (verts.size() + 1 < max_verts)
             {
+                if (verts.empty())
+                    _vert_lut.set_epsilon(epsilon);
+
                 verts.push_back(input);
                 markers.push_back(marker);
-                _vert_lut[input] = (int)verts.size() - 1;
                 index = (int)verts.size() - 1;
+                _vert_lut.insert(input, index);
             }
             else
             {
@@ -405,8 +774,9 @@ namespace weemesh
             output.clear();
             vert_t::value_type a_min[2] = { xmin, ymin };
             vert_t::value_type a_max[2] = { xmax, ymax };
-            _spatial_index.Search(a_min, a_max, [&](const UID& uid) {
-                output.emplace_back(&triangles[uid]); return true;  });
+            _spatial_index.search(a_min, a_max, triangles, _search_results);
+            for (auto uid : _search_results)
+                output.emplace_back(&triangles[uid]);
             return (unsigned)output.size();
         }
 
@@ -424,18 +794,17 @@ namespace weemesh
             a_min[0] = a_max[0] = vert.x;
             a_min[1] = a_max[1] = vert.y;
 
-            std::vector<UID> uids;
+            _spatial_index.search(a_min, a_max, triangles, _search_results);
 
-            _spatial_index.Search(
-                a_min, a_max,
-                [&uids](const UID& u) {
-                    uids.push_back(u);
-                    return true;
-                });
+            // copy, since splitting may trigger a search
+            std::vector<UID> uids(_search_results);
 
             for (auto uid : uids)
             {
-                triangle_t& tri = triangles[uid];
+                if (!triangles.contains(uid))
+                    continue;
+
+                const triangle_t& tri = triangles[uid];
 
                 if (tri.is_2d_degenerate)
                     continue;
@@ -459,14 +828,6 @@ namespace weemesh
             a_min[1] = std::min(seg.first.y, seg.second.y);
             a_max[0] = std::max(seg.first.x, seg.second.x);
             a_max[1] = std::max(seg.first.y, seg.second.y);
-            std::vector<UID> uids;
-
-            _spatial_index.Search(
-                a_min, a_max,
-                [&uids](const UID& u) {
-                    uids.push_back(u);
-                    return true;
-                });
 
             // The working set of triangles which we will add to if we have
             // to split triangles. Any triangle only needs to be split once,
@@ -475,11 +836,19 @@ namespace weemesh
             // splits will just happen on the new triangles later. (That's why
             // every split operation is followed by a "continue" to short-circuit
             // to loop)
-            std::list<UID> uid_list;
-            std::copy(uids.begin(), uids.end(), std::back_inserter(uid_list));
-            for (auto uid : uid_list)
+            auto& uid_list = _work_list;
+            _spatial_index.search(a_min, a_max, triangles, uid_list);
+
+            for (std::size_t w = 0; w < uid_list.size(); ++w)
             {
-                triangle_t& tri = triangles[uid];
+                UID uid = uid_list[w];
+
+                // may have been removed by an earlier split
+                if (!triangles.contains(uid))
+                    continue;
+
+                // work on a copy since adding triangles can reallocate storage
+                const triangle_t tri = triangles[uid];
 
                 // skip triangles that are "degenerate" in 2D. We will keep them
                 // because they may NOT be degenerate in 3D (e.g. steep slopes).
@@ -529,7 +898,7 @@ namespace weemesh
                     int new_tris = 0;
 
                     new_uid = add_triangle(new_i, tri.i2, tri.i0);
-                    if (new_uid >= 0) {
+                    if (new_uid != invalid_uid) {
                         markers[tri.i2] |= _constraint_marker;
                         markers[tri.i0] |= _constraint_marker;
                         uid_list.push_back(new_uid);
@@ -537,7 +906,7 @@ namespace weemesh
                     }
 
                     new_uid = add_triangle(new_i, tri.i1, tri.i2);
-                    if (new_uid >= 0) {
+                    if (new_uid != invalid_uid) {
                         markers[tri.i1] |= _constraint_marker;
                         markers[tri.i2] |= _constraint_marker;
                         uid_list.push_back(new_uid);
@@ -574,7 +943,7 @@ namespace weemesh
                     int new_tris = 0;
 
                     new_uid = add_triangle(new_i, tri.i0, tri.i1);
-                    if (new_uid >= 0) {
+                    if (new_uid != invalid_uid) {
                         markers[tri.i0] |= _constraint_marker;
                         markers[tri.i1] |= _constraint_marker;
                         uid_list.push_back(new_uid);
@@ -582,7 +951,7 @@ namespace weemesh
                     }
 
                     new_uid = add_triangle(new_i, tri.i2, tri.i0);
-                    if (new_uid >= 0) {
+                    if (new_uid != invalid_uid) {
                         markers[tri.i2] |= _constraint_marker;
                         markers[tri.i0] |= _constraint_marker;
                         uid_list.push_back(new_uid);
@@ -619,7 +988,7 @@ namespace weemesh
                     int new_tris = 0;
 
                     new_uid = add_triangle(new_i, tri.i1, tri.i2);
-                    if (new_uid >= 0) {
+                    if (new_uid != invalid_uid) {
                         markers[tri.i1] |= _constraint_marker;
                         markers[tri.i2] |= _constraint_marker;
                         uid_list.push_back(new_uid);
@@ -627,7 +996,7 @@ namespace weemesh
                     }
 
                     new_uid = add_triangle(new_i, tri.i0, tri.i1);
-                    if (new_uid >= 0) {
+                    if (new_uid != invalid_uid) {
                         markers[tri.i0] |= _constraint_marker;
                         markers[tri.i1] |= _constraint_marker;
                         uid_list.push_back(new_uid);
@@ -651,11 +1020,62 @@ namespace weemesh
             }
         }
 
+        // insert a batch of segments into the mesh. Segments are processed
+        // in Morton (Z-curve) order of their midpoints so that consecutive
+        // inserts touch the same region of the mesh.
+        template<class SEGMENT_ITER>
+        void insert(SEGMENT_ITER begin, SEGMENT_ITER end, int marker)
+        {
+            std::vector<std::pair<std::uint32_t, const segment_t*>> order;
+            order.reserve(std::distance(begin, end));
+
+            vert_t::value_type xmin = DBL_MAX, ymin = DBL_MAX, xmax = -DBL_MAX, ymax = -DBL_MAX;
+            for (auto i = begin; i != end; ++i)
+            {
+                const segment_t& seg = *i;
+                xmin = std::min(xmin, std::min(seg.first.x, seg.second.x));
+                ymin = std::min(ymin, std::min(seg.first.y, seg.second.y));
+                xmax = std::max(xmax, std::max(seg.first.x, seg.second.x));
+                ymax = std::max(ymax, std::max(seg.first.y, seg.second.y));
+            }
+
+            auto spread = [](std::uint32_t v) {
+                v &= 0xFFFF;
+                v = (v | (v << 8)) & 0x00FF00FF;
+                v = (v | (v << 4)) & 0x0F0F0F0F;
+                v = (v | (v << 2)) & 0x33333333;
+                v = (v | (v << 1)) & 0x55555555;
+                return v;
+            };
+
+            double sx = xmax > xmin ? 65535.0 / (xmax - xmin) : 0.0;
+            double sy = ymax > ymin ? 65535.0 / (ymax - ymin) : 0.0;
+
+            for (auto i = begin; i != end; ++i)
+            {
+                const segment_t& seg = *i;
+                auto mx = (std::uint32_t)((0.5 * (seg.first.x + seg.second.x) - xmin) * sx);
+                auto my = (std::uint32_t)((0.5 * (seg.first.y + seg.second.y) - ymin) * sy);
+                order.emplace_back(spread(mx) | (spread(my) << 1), &seg);
+            }
+
+            std::sort(order.begin(), order.end(),
+                [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+
+            for (auto& entry : order)
+            {
+                insert(*entry.second, marker);
+            }
+        }
+
         // inserts point "p" into the interior of triangle "tri",
         // adds three new triangles, and removes the original triangle.
         // return true if a split actual happened
-        bool inside_split(triangle_t& tri, const vert_t& p, std::list<UID>* uid_list, int new_marker)
+        bool inside_split(const triangle_t& tri_in, const vert_t& p, std::vector<UID>* uid_list, int new_marker)
         {
+            // work on a copy since adding triangles can reallocate storage
+            const triangle_t tri = tri_in;
+
             int new_i = get_or_create_vertex(p, new_marker);
             if (new_i < 0)
                 return false;
@@ -678,7 +1098,7 @@ namespace weemesh
 
             if (!equivalent(bary[2], 0.0, epsilon)) {
                 new_uid = add_triangle(tri.i0, tri.i1, new_i);
-                if (new_uid >= 0 && uid_list) {
+                if (new_uid != invalid_uid && uid_list) {
                     markers[tri.i0] |= _constraint_marker;
                     markers[tri.i1] |= _constraint_marker;
                     uid_list->push_back(new_uid);
@@ -688,7 +1108,7 @@ namespace weemesh
 
             if (!equivalent(bary[0], 0.0, epsilon)) {
                 new_uid = add_triangle(tri.i1, tri.i2, new_i);
-                if (new_uid >= 0 && uid_list) {
+                if (new_uid != invalid_uid && uid_list) {
                     markers[tri.i1] |= _constraint_marker;
                     markers[tri.i2] |= _constraint_marker;
                     uid_list->push_back(new_uid);
@@ -698,7 +1118,7 @@ namespace weemesh
 
             if (!equivalent(bary[1], 0.0, epsilon)) {
                 new_uid = add_triangle(tri.i2, tri.i0, new_i);
-                if (new_uid >= 0 && uid_list) {
+                if (new_uid != invalid_uid && uid_list) {
                     markers[tri.i2] |= _constraint_marker;
                     markers[tri.i0] |= _constraint_marker;
                     uid_list->push_back(new_uid);
@@ -761,9 +1181,8 @@ namespace weemesh
 
         edgeset_t(const mesh_t& mesh, int marker_mask)
         {
-            for (auto& tri_iter : mesh.triangles)
+            for (auto& tri : mesh.triangles)
             {
-                const triangle_t& tri = tri_iter.second;
                 add_triangle(tri, mesh, marker_mask);
             }
         }
@@ -832,9 +1251,8 @@ namespace weemesh
 
         graph_t(const mesh_t& mesh)
         {
-            for (auto& tri_iter : mesh.triangles)
+            for (auto& tri : mesh.triangles)
             {
-                const triangle_t& tri = tri_iter.second;
                 add_triangle(tri);
             }
             assign_graph_ids();
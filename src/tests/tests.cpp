@@ -3,16 +3,25 @@
 
 #include <rocky/Instance.h>
 #include <rocky/Color.h>
+#include <rocky/ElevationLayer.h>
+#include <rocky/ImageLayer.h>
 #include <rocky/Log.h>
 #include <rocky/Map.h>
 #include <rocky/Math.h>
 #include <rocky/Image.h>
 #include <rocky/Heightfield.h>
 #include <rocky/TileKey.h>
+#include <rocky/TerrainTileModel.h>
+#include <rocky/Tracing.h>
 #include <rocky/URI.h>
 #include <rocky/Utils.h>
 #include <rocky/contrib/EarthFileImporter.h>
 #include <rocky/vsg/MapNode.h>
+#include <rocky/vsg/TiledFeatureView.h>
+#include <rocky/vsg/engine/Runtime.h>
+#include <rocky/vsg/engine/TerrainReplay.h>
+#include <rocky/vsg/engine/TextureEncoder.h>
+#include <rocky/weemesh.h>
 
 #include <random>
 
@@ -22,6 +31,14 @@
 
 #ifdef ROCKY_HAS_TMS
 #include <rocky/TMSImageLayer.h>
+#include <rocky/QuantizedMeshElevationLayer.h>
+#endif
+
+#ifdef ROCKY_HAS_HTTPLIB
+#ifdef ROCKY_HAS_OPENSSL
+#define CPPHTTPLIB_OPENSSL_SUPPORT
+#endif
+#include <httplib.h>
 #endif
 
 #define ROCKY_EXPOSE_JSON_FUNCTIONS
@@ -38,6 +55,84 @@ namespace
             return StatusOK;
         }
     };
+
+    // solid color tiles
+    class TestImageLayer : public Inherit<ImageLayer, TestImageLayer>
+    {
+    public:
+        Status openImplementation(const IOOptions& io) override {
+            auto status = super::openImplementation(io);
+            if (status.ok()) {
+                setProfile(Profile::GLOBAL_GEODETIC);
+                setDataExtents({ DataExtent(profile().extent()) });
+            }
+            return status;
+        }
+        Result<GeoImage> createImageImplementation(const TileKey& key, const IOOptions& io) const override {
+            auto image = Image::create(Image::R8G8B8A8_UNORM, 16, 16);
+            image->fill(Color::Gray);
+            return GeoImage(image, key.extent());
+        }
+    };
+
+    // flat tiles at a fixed height; calls onLoad before returning each one
+    class TestElevationLayer : public Inherit<ElevationLayer, TestElevationLayer>
+    {
+    public:
+        float height = 100.0f;
+        std::function<void()> onLoad;
+
+        Status openImplementation(const IOOptions& io) override {
+            auto status = super::openImplementation(io);
+            if (status.ok()) {
+                setProfile(Profile::GLOBAL_GEODETIC);
+                setDataExtents({ DataExtent(profile().extent()) });
+            }
+            return status;
+        }
+        Result<GeoHeightfield> createHeightfieldImplementation(const TileKey& key, const IOOptions& io) const override {
+            if (onLoad)
+                onLoad();
+            auto hf = Heightfield::create(tileSize(), tileSize());
+            hf->fill(height);
+            return GeoHeightfield(hf, key.extent());
+        }
+    };
+
+    // features held in memory
+    class TestFeatureSource : public Inherit<FeatureSource, TestFeatureSource>
+    {
+    public:
+        std::vector<Feature> features;
+
+        class iterator : public FeatureSource::iterator
+        {
+        public:
+            iterator(const std::vector<Feature>& features) : _features(features) { }
+            bool hasMore() const override { return _next < _features.size(); }
+            const Feature& next() override { return _features[_next++]; }
+        private:
+            const std::vector<Feature>& _features;
+            std::size_t _next = 0;
+        };
+
+        int featureCount() const override {
+            return (int)features.size();
+        }
+        std::shared_ptr<FeatureSource::iterator> iterate(IOOptions& io) override {
+            return std::make_shared<iterator>(features);
+        }
+    };
+
+    // exposes the tiled view's paging steps without a record traversal
+    class TestTiledFeatureView : public TiledFeatureView
+    {
+    public:
+        using TiledFeatureView::TiledFeatureView;
+        using TiledFeatureView::update;
+        using TiledFeatureView::visit;
+        using TiledFeatureView::readTile;
+    };
 }
 
 TEST_CASE("json")
@@ -133,6 +228,139 @@ TEST_CASE("Threading")
     CHECK(f2.value() == 123);
 }
 
+TEST_CASE("SingleFlight")
+{
+    // Many workers ask for the same slow resource at once, like loader
+    // threads all needing the same parent tile.
+    const int num_threads = 16;
+
+    auto contend = [&](util::SingleFlight<std::string, int>* flights)
+        {
+            std::atomic_int fetches = { 0 };
+            std::atomic_int ready = { 0 };
+            std::vector<int> results(num_threads, 0);
+            std::vector<std::thread> threads;
+
+            for (int t = 0; t < num_threads; ++t)
+            {
+                threads.emplace_back([&, t]()
+                    {
+                        auto fetch = [&]()
+                            {
+                                ++fetches;
+                                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                                return 42;
+                            };
+
+                        ++ready;
+                        while (ready < num_threads)
+                            std::this_thread::yield();
+
+                        results[t] = flights ? flights->run("parent", fetch) : fetch();
+                    });
+            }
+
+            for (auto& thread : threads)
+                thread.join();
+
+            for (auto r : results)
+                CHECK(r == 42);
+
+            return (int)fetches;
+        };
+
+    util::SingleFlight<std::string, int> flights;
+    int uncoalesced = contend(nullptr);
+    int coalesced = contend(&flights);
+
+    CHECK(uncoalesced == num_threads);
+    CHECK(coalesced < uncoalesced);
+    CHECK((int)flights.joined() == num_threads - coalesced);
+    Log()->info("SingleFlight: {} threads made {} fetches (vs. {})", num_threads, coalesced, uncoalesced);
+
+    // errors are shared too
+    std::atomic_int fetches = { 0 };
+    auto failing = [&]() -> int
+        {
+            ++fetches;
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            throw std::runtime_error("fetch failed");
+        };
+
+    const int num_failing = 4;
+    std::atomic_int errors = { 0 };
+    std::atomic_int ready = { 0 };
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_failing; ++t)
+    {
+        threads.emplace_back([&]()
+            {
+                ++ready;
+                while (ready < num_failing)
+                    std::this_thread::yield();
+
+                try { flights.run("bad", failing); }
+                catch (const std::runtime_error&) { ++errors; }
+            });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    CHECK(errors == num_failing);
+    CHECK(fetches < num_failing);
+
+    // nothing is cached once the flight lands
+    CHECK(flights.run("parent", []() { return 7; }) == 7);
+}
+
+TEST_CASE("JobStats")
+{
+    util::LatencyHistogram histogram;
+    for (int i = 0; i < 90; ++i)
+        histogram.add(std::chrono::microseconds(100));
+    for (int i = 0; i < 10; ++i)
+        histogram.add(std::chrono::milliseconds(10));
+
+    // percentiles report the upper bound of their power-of-two bucket
+    CHECK(histogram.count() == 100);
+    CHECK(histogram.percentile(0.5f) == std::chrono::microseconds(128));
+    CHECK(histogram.percentile(0.95f) == std::chrono::microseconds(16384));
+
+    util::JobStats::reset();
+    util::JobStats::setEnabled(true);
+
+    auto pool = jobs::get_pool("rocky.tests.jobstats");
+    pool->set_concurrency(2);
+
+    // the observer runs just after the job resolves its future, but before
+    // the job releases its group, so joining the group waits for it too.
+    auto group = jobs::jobgroup::create();
+
+    std::vector<jobs::future<int>> results;
+    for (int i = 0; i < 8; ++i)
+    {
+        results.emplace_back(jobs::dispatch([](Cancelable&)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                return 1;
+            },
+            jobs::context{ "test job 5/3/" + std::to_string(i), pool, {}, group }));
+    }
+
+    group->join();
+    util::JobStats::setEnabled(false);
+
+    for (auto& result : results)
+        CHECK(result.value() == 1);
+
+    // jobs group by name without their tile keys
+    auto byName = util::JobStats::byName();
+    CHECK(byName["test job"].run.count() == 8);
+    CHECK(byName["test job"].canceled == 0);
+    CHECK(byName["test job"].run.percentile(0.5f) >= std::chrono::milliseconds(2));
+    CHECK(util::JobStats::byPool()["rocky.tests.jobstats"].wait.count() == 8);
+}
+
 TEST_CASE("Math")
 {
     CHECK(is_identity(glm::fmat4(1)));
@@ -151,6 +379,83 @@ TEST_CASE("Math")
     CHECK(r == glm::fvec3(0.75f, 0.75f, 0));
 }
 
+TEST_CASE("weemesh")
+{
+    // a jagged star-shaped ring:
+    std::vector<weemesh::vert_t> ring;
+    const int num_points = 500;
+    for (int i = 0; i < num_points; ++i)
+    {
+        double a = 2.0 * 3.14159265358979 * (double)i / (double)num_points;
+        double r = (i & 1) ? 8.0 : 9.0;
+        ring.emplace_back(r * cos(a), r * sin(a), 0.0);
+    }
+
+    double ring_area = 0.0;
+    for (int i = 0; i < num_points; ++i)
+        ring_area += 0.5 * ring[i].cross2d(ring[(i + 1) % num_points]);
+
+    // a regular grid covering the ring:
+    weemesh::mesh_t m;
+    const int cols = 41;
+    m.reserve(cols * cols, (cols - 1) * (cols - 1) * 2);
+    for (int row = 0; row < cols; ++row)
+        for (int col = 0; col < cols; ++col)
+            m.get_or_create_vertex(weemesh::vert_t(-10.0 + 0.5 * col, -10.0 + 0.5 * row, 0.0), 0);
+
+    for (int row = 0; row < cols - 1; ++row)
+    {
+        for (int col = 0; col < cols - 1; ++col)
+        {
+            int k = row * cols + col;
+            m.add_triangle(k, k + 1, k + cols);
+            m.add_triangle(k + 1, k + cols + 1, k + cols);
+        }
+    }
+
+    std::vector<weemesh::segment_t> segments;
+    for (int i = 0; i < num_points; ++i)
+        segments.emplace_back(ring[i], ring[(i + 1) % num_points]);
+
+    m.insert(segments.begin(), segments.end(), 0);
+
+    // remove the triangles outside the ring and compare areas:
+    auto inside = [&](const weemesh::vert_t& p)
+        {
+            bool result = false;
+            for (int i = 0, j = num_points - 1; i < num_points; j = i++)
+            {
+                if (((ring[i].y > p.y) != (ring[j].y > p.y)) &&
+                    (p.x < (ring[j].x - ring[i].x) * (p.y - ring[i].y) / (ring[j].y - ring[i].y) + ring[i].x))
+                    result = !result;
+            }
+            return result;
+        };
+
+    std::vector<weemesh::UID> outside;
+    for (auto& tri : m.triangles)
+        if (!inside((tri.p0 + tri.p1 + tri.p2) * (1.0 / 3.0)))
+            outside.push_back(tri.uid);
+
+    for (auto uid : outside)
+        m.remove_triangle(uid);
+
+    double mesh_area = 0.0;
+    for (auto& tri : m.triangles)
+        mesh_area += 0.5 * fabs((tri.p1 - tri.p0).cross2d(tri.p2 - tri.p0));
+
+    CHECK(m.triangles.size() > 0);
+    CHECK(fabs(mesh_area - ring_area) < 1e-6 * ring_area);
+
+    // lookups that miss, and coordinates far beyond an int's worth of cells:
+    CHECK(m.get_marker(weemesh::vert_t(100.0, 100.0, 0.0)) == nullptr);
+    int far = m.get_or_create_vertex(weemesh::vert_t(1e300, -1e300, 0.0), 2);
+    CHECK(far >= 0);
+    auto far_marker = m.get_marker(weemesh::vert_t(1e300, -1e300, 0.0));
+    REQUIRE(far_marker != nullptr);
+    CHECK(*far_marker == 2);
+}
+
 #ifdef ROCKY_HAS_ZLIB
 TEST_CASE("Compression")
 {
@@ -221,6 +526,213 @@ TEST_CASE("Image")
     CHECK(equiv(value.g, 0.5f, 0.01f));
     CHECK(equiv(value.b, 0.0f, 0.01f));
     CHECK(equiv(value.a, 1.0f, 0.01f));
+
+    // wrap external memory (stored top-down) without copying it:
+    auto external = std::make_shared<std::vector<unsigned char>>(std::vector<unsigned char>{ 10, 20, 30, 40, 50, 60 });
+    auto wrapped = Image::create(Image::R8_UNORM, 2, 3, 1, external->data(), external, Image::TOP_LEFT);
+    CHECK(wrapped->valid());
+    CHECK(wrapped->ownsData() == false);
+    CHECK(wrapped->data<unsigned char>(0, 0) == 50); // t=0 is the bottom row
+    CHECK(wrapped->data<unsigned char>(1, 2) == 20);
+
+    // flipping only relabels the rows:
+    wrapped->flipVerticalInPlace();
+    CHECK(wrapped->origin() == Image::BOTTOM_LEFT);
+    CHECK(wrapped->data<unsigned char>(0, 0) == 10);
+    CHECK(wrapped->data<unsigned char>() == external->data());
+
+    // converting the origin reorders a private copy and keeps the content:
+    wrapped->convertOrigin(Image::TOP_LEFT);
+    CHECK(wrapped->ownsData() == true);
+    CHECK(wrapped->data<unsigned char>(0, 0) == 10);
+    CHECK(wrapped->data<unsigned char>()[0] == 50);
+    CHECK((*external)[0] == 10);
+
+    auto reordered = wrapped->clone(Image::BOTTOM_LEFT);
+    CHECK(reordered->data<unsigned char>()[0] == 10);
+    CHECK(reordered->data<unsigned char>(1, 2) == 60);
+
+    // the RGBA8 and R32F convolution fast paths match a per-pixel 3x3 convolution
+    // (with clamped edges) to within a step of the pixel format
+    const float cross[9] = { 0.0f, -0.5f, 0.0f, -0.5f, 3.0f, -0.5f, 0.0f, -0.5f, 0.0f };
+    for (auto format : { Image::R8G8B8A8_UNORM, Image::R32_SFLOAT })
+    {
+        auto source = Image::create(format, 37, 23);
+        for (unsigned t = 0; t < source->height(); ++t)
+            for (unsigned s = 0; s < source->width(); ++s)
+                source->write(Image::Pixel((float)((s * 7 + t * 13) % 17) / 16.0f, (float)s / 36.0f, (float)t / 22.0f, 1.0f), s, t);
+        source->flipVerticalInPlace(); // exercise the top-down row order too
+
+        for (auto kernel_type : { 0, 1 })
+        {
+            std::shared_ptr<Image> output;
+            float kernel[9];
+            if (kernel_type == 0) {
+                float a = -2.5f / 9.0f;
+                for (auto& k : kernel) k = a;
+                kernel[4] = 1.0f - 8.0f * a;
+                output = source->sharpen(2.5f);
+            }
+            else {
+                std::copy(cross, cross + 9, kernel);
+                output = source->convolve(cross);
+            }
+            REQUIRE(output);
+
+            float max_error = 0.0f;
+            Image::Pixel sample, expected, actual;
+            int w = source->width(), h = source->height();
+            for (int t = 0; t < h; ++t)
+            {
+                for (int s = 0; s < w; ++s)
+                {
+                    expected = Image::Pixel(0.0f);
+                    for (int i = 0; i < 9; ++i)
+                    {
+                        source->read(sample, clamp(s + i % 3 - 1, 0, w - 1), clamp(t + i / 3 - 1, 0, h - 1));
+                        expected += sample * kernel[i];
+                    }
+                    expected = clamp(expected, 0.0f, 1.0f);
+                    output->read(actual, s, t);
+                    for (unsigned c = 0; c < source->numComponents(); ++c)
+                        max_error = std::max(max_error, std::abs(actual[c] - expected[c]));
+                }
+            }
+            CHECK(max_error <= 1.0f / 255.0f + 1e-5f);
+        }
+    }
+
+    // typed views agree with the per-pixel accessors, in either row order
+    auto rgb = Image::create(Image::R8G8B8_UNORM, 5, 4);
+    rgb->flipVerticalInPlace();
+    rgb->write(Image::Pixel(0.2f, 0.4f, 0.6f, 1.0f), 3, 1);
+    ImageView<Image::R8G8B8_UNORM> view(*rgb);
+    CHECK(view.at(3, 1) == rgb->data<unsigned char>() + 2 * 15 + 3 * 3); // t=1 is the third row in memory
+    CHECK(view.row(1)[9] == (unsigned char)(0.2f * 255.0f));
+    Image::Pixel viewed, direct;
+    view.read(viewed, 3, 1);
+    rgb->read(direct, 3, 1);
+    CHECK(viewed == direct);
+
+    // fill and same-format sub-image copies go through the views
+    auto tile = Image::create(Image::R32_SFLOAT, 4, 4);
+    tile->fill(Image::Pixel(7.0f));
+    auto canvas = Image::create(Image::R32_SFLOAT, 8, 8);
+    canvas->flipVerticalInPlace();
+    canvas->fill(Image::Pixel(-1.0f));
+    CHECK(tile->copyAsSubImage(canvas.get(), 2, 3));
+    CHECK(canvas->data<float>(2, 3) == 7.0f);
+    CHECK(canvas->data<float>(5, 6) == 7.0f);
+    CHECK(canvas->data<float>(1, 3) == -1.0f);
+    CHECK(canvas->data<float>(2, 7) == -1.0f);
+    CHECK(tile->copyAsSubImage(canvas.get(), 5, 5) == false);
+}
+
+TEST_CASE("TextureEncoder")
+{
+    // columns 0-1 opaque red, columns 2-3 translucent blue, repeated
+    auto image = Image::create(Image::R8G8B8A8_UNORM, 16, 16);
+    ImageView<Image::R8G8B8A8_UNORM> pixels(*image);
+    for (unsigned t = 0; t < 16; ++t)
+    {
+        for (unsigned s = 0; s < 16; ++s)
+        {
+            const unsigned char red[4] = { 255, 0, 0, 255 }, blue[4] = { 0, 0, 255, 64 };
+            std::copy(s % 4 < 2 ? red : blue, (s % 4 < 2 ? red : blue) + 4, pixels.at(s, t));
+        }
+    }
+
+    // decodes pixel i of a BC1 color block (or the color half of a BC3 block)
+    auto decodeColor = [](const std::uint8_t* block, unsigned i, bool four_color, int* rgba)
+        {
+            auto expand = [](std::uint16_t c, int* rgb) {
+                rgb[0] = ((c >> 11) & 31) * 255 / 31, rgb[1] = ((c >> 5) & 63) * 255 / 63, rgb[2] = (c & 31) * 255 / 31;
+            };
+            std::uint16_t c0 = block[0] | (block[1] << 8), c1 = block[2] | (block[3] << 8);
+            std::uint32_t indices = block[4] | (block[5] << 8) | (block[6] << 16) | ((std::uint32_t)block[7] << 24);
+            unsigned index = (indices >> (2 * i)) & 3;
+            int e0[3], e1[3];
+            expand(c0, e0), expand(c1, e1);
+            four_color = four_color || c0 > c1;
+            rgba[3] = 255;
+            for (int c = 0; c < 3; ++c)
+            {
+                if (index == 0) rgba[c] = e0[c];
+                else if (index == 1) rgba[c] = e1[c];
+                else if (four_color) rgba[c] = index == 2 ? (2 * e0[c] + e1[c]) / 3 : (e0[c] + 2 * e1[c]) / 3;
+                else if (index == 2) rgba[c] = (e0[c] + e1[c]) / 2;
+                else rgba[c] = 0, rgba[3] = 0;
+            }
+        };
+
+    auto within = [](const int* rgba, const unsigned char* expected) {
+        return std::abs(rgba[0] - expected[0]) <= 32 && std::abs(rgba[1] - expected[1]) <= 32 && std::abs(rgba[2] - expected[2]) <= 32;
+    };
+    const unsigned char red[3] = { 255, 0, 0 }, blue[3] = { 0, 0, 255 };
+
+    TextureEncoder encoder;
+    CHECK(encoder.enabled() == false);
+    CHECK(!encoder.encode(*image));
+
+    SECTION("BC1")
+    {
+        encoder.compression = TextureEncoder::Compression::BC1;
+        encoder.mipmaps = true;
+        auto data = encoder.encode(*image);
+        REQUIRE(data);
+        CHECK(data->properties.format == VK_FORMAT_BC1_RGBA_UNORM_BLOCK);
+        CHECK(data->width() == 4);
+        CHECK(data->height() == 4);
+        CHECK(data->properties.maxNumMipmaps == 3); // 4x4, 2x2 and 1x1 blocks
+        CHECK(data->valueSize() == 8);
+        CHECK(data->computeValueCountIncludingMipmaps() == 16 + 4 + 1);
+
+        // translucent pixels punch through to transparent black
+        auto block = static_cast<const std::uint8_t*>(data->dataPointer());
+        int rgba[4];
+        decodeColor(block, 0, false, rgba);
+        CHECK(within(rgba, red));
+        CHECK(rgba[3] == 255);
+        decodeColor(block, 3, false, rgba);
+        CHECK(rgba[3] == 0);
+    }
+
+    SECTION("BC3")
+    {
+        encoder.compression = TextureEncoder::Compression::BC3;
+        auto data = encoder.encode(*image);
+        REQUIRE(data);
+        CHECK(data->properties.format == VK_FORMAT_BC3_UNORM_BLOCK);
+        CHECK(data->properties.maxNumMipmaps == 1);
+        CHECK(data->valueSize() == 16);
+        CHECK(data->computeValueCountIncludingMipmaps() == 16);
+
+        // alpha endpoints are the block's max and min alpha, 3-bit indices follow
+        auto block = static_cast<const std::uint8_t*>(data->dataPointer());
+        CHECK(block[0] == 255);
+        CHECK(block[1] == 64);
+        std::uint64_t alphaIndices = 0;
+        for (int b = 0; b < 6; ++b)
+            alphaIndices |= (std::uint64_t)block[2 + b] << (8 * b);
+        CHECK((alphaIndices & 7) == 0);         // pixel 0: 255
+        CHECK(((alphaIndices >> 9) & 7) == 1);  // pixel 3: 64
+
+        int rgba[4];
+        decodeColor(block + 8, 0, true, rgba);
+        CHECK(within(rgba, red));
+        decodeColor(block + 8, 3, true, rgba);
+        CHECK(within(rgba, blue));
+    }
+
+    SECTION("Mipmaps only")
+    {
+        encoder.mipmaps = true;
+        auto data = encoder.encode(*image);
+        REQUIRE(data);
+        CHECK(data->properties.format == VK_FORMAT_R8G8B8A8_UNORM);
+        CHECK(data->properties.maxNumMipmaps == 5); // 16, 8, 4, 2 and 1 pixels across
+        CHECK(data->computeValueCountIncludingMipmaps() == 256 + 64 + 16 + 4 + 1);
+    }
 }
 
 TEST_CASE("Heightfield")
@@ -253,6 +765,89 @@ TEST_CASE("Heightfield")
         hf->fill(NO_DATA_VALUE);
         CHECK(hf->heightAtPixel(16.5, 16.5, Heightfield::BILINEAR) == NO_DATA_VALUE);
     }
+
+    // 16-bit quantized storage:
+    auto q = Heightfield::create(65, 65);
+    for (unsigned t = 0; t < 65; ++t)
+        for (unsigned s = 0; s < 65; ++s)
+            q->heightAt(s, t) = -400.0f + 97.3f * (float)s + 13.1f * (float)t;
+    q->heightAt(3, 5) = NO_DATA_VALUE;
+    auto original = Heightfield::create(*q);
+
+    q->quantize();
+    CHECK(q->quantized());
+    CHECK(q->sizeInBytes() == original->sizeInBytes() / 2);
+    CHECK(q->quantizationOffset() == -400.0f);
+    CHECK(Heightfield::cast_from(q.get()) == q.get());
+
+    const Heightfield& codes = *q;
+    float maxError = 0.0f;
+    for (unsigned t = 0; t < 65; ++t)
+        for (unsigned s = 0; s < 65; ++s)
+            if (original->heightAt(s, t) != NO_DATA_VALUE)
+                maxError = std::max(maxError, std::abs(codes.heightAt(s, t) - original->heightAt(s, t)));
+    CHECK(maxError <= 0.5f * q->quantizationScale() + 0.001f);
+    CHECK(codes.heightAt(3, 5) == NO_DATA_VALUE);
+    CHECK(equiv(codes.heightAtPixel(10.5, 20.5), original->heightAtPixel(10.5, 20.5), 0.1f));
+
+    q->dequantize();
+    CHECK(q->pixelFormat() == Image::R32_SFLOAT);
+    CHECK(q->heightAt(3, 5) == NO_DATA_VALUE);
+    CHECK(equiv(q->heightAt(64, 64), original->heightAt(64, 64), 0.1f));
+}
+
+TEST_CASE("Elevation encodings")
+{
+    // RGB encodings decode from the 8-bit components exactly
+    auto rgba = Image::create(Image::R8G8B8A8_UNORM, 7, 2);
+    rgba->flipVerticalInPlace();
+    ImageView<Image::R8G8B8A8_UNORM> pixels(*rgba);
+    const unsigned char samples[7][3] = { {1,134,160}, {1,135,0}, {0,0,0}, {128,0,0}, {127,255,128}, {132,28,64}, {2,0,0} };
+    for (unsigned s = 0; s < 7; ++s)
+        std::copy(samples[s], samples[s] + 3, pixels.at(s, 1));
+
+    auto mapbox = ElevationLayer::decodeRGB(*rgba, ElevationLayer::Encoding::MapboxRGB);
+    REQUIRE(mapbox);
+    CHECK(equiv(mapbox->heightAt(0, 1), 0.0f, 0.01f));     // 100000 * 0.1 - 10000
+    CHECK(equiv(mapbox->heightAt(1, 1), 9.6f, 0.01f));
+    CHECK(mapbox->heightAt(2, 1) == NO_DATA_VALUE);         // -10000 is out of range
+    CHECK(equiv(mapbox->heightAt(6, 1), 3107.2f, 0.01f));
+
+    auto terrarium = ElevationLayer::decodeRGB(*rgba, ElevationLayer::Encoding::TerrariumRGB);
+    REQUIRE(terrarium);
+    CHECK(terrarium->heightAt(3, 1) == 0.0f);
+    CHECK(terrarium->heightAt(4, 1) == -0.5f);
+    CHECK(terrarium->heightAt(5, 1) == 1052.25f);
+
+#ifdef ROCKY_HAS_TMS
+    // a quantized-mesh tile with one quad sloping from 100m (west) to 200m (east)
+    std::string tile(24, '\0');
+    auto put = [&](auto value) { tile.append(reinterpret_cast<const char*>(&value), sizeof(value)); };
+    put(100.0f), put(200.0f);
+    tile.append(56, '\0');
+    put(std::uint32_t(4));
+    auto zigzag = [&](std::initializer_list<int> values) {
+        int prev = 0;
+        for (int value : values) put(std::uint16_t(((value - prev) << 1) ^ ((value - prev) >> 31))), prev = value;
+    };
+    zigzag({ 0, 32767, 32767, 0 });     // u
+    zigzag({ 0, 0, 32767, 32767 });     // v
+    zigzag({ 0, 32767, 32767, 0 });     // height
+    put(std::uint32_t(2));
+    for (std::uint16_t code : { 0, 0, 0, 3, 1, 0 }) // triangles 0,1,2 and 0,2,3
+        put(code);
+
+    auto qm = QuantizedMeshElevationLayer::decode(tile, 17, 9);
+    REQUIRE(qm.status.ok());
+    CHECK(qm.value->width() == 17);
+    CHECK(equiv(qm.value->heightAt(0, 0), 100.0f, 0.01f));
+    CHECK(equiv(qm.value->heightAt(8, 4), 150.0f, 0.01f));
+    CHECK(equiv(qm.value->heightAt(16, 8), 200.0f, 0.01f));
+    CHECK(equiv(qm.value->heightAt(4, 8), 125.0f, 0.01f));
+
+    tile.resize(tile.size() - 2);
+    CHECK(QuantizedMeshElevationLayer::decode(tile, 17, 9).status.failed());
+#endif
 }
 
 TEST_CASE("Map")
@@ -301,6 +896,49 @@ TEST_CASE("Map")
     }
 }
 
+TEST_CASE("Layer open")
+{
+    Instance instance;
+
+    auto layer = TestLayer::create();
+    CHECK(layer->isOpen() == false);
+    auto result = layer->openAsync(instance.io());
+    CHECK(result.join().ok());
+    CHECK(layer->isOpen());
+
+    auto map = Map::create(instance);
+    for (int i = 0; i < 10; ++i)
+        map->layers().add(TestLayer::create());
+    CHECK(map->openAllLayers(instance.io()).ok());
+    for (auto& layer : map->layers().all())
+        CHECK(layer->isOpen());
+}
+
+TEST_CASE("CreateTileManifest")
+{
+    Instance instance;
+
+    auto map = Map::create(instance);
+    auto layer = TestLayer::create();
+    map->layers().add(layer);
+
+    CreateTileManifest manifest;
+    manifest.insert(layer);
+    CHECK(manifest.includes(layer.get()));
+    CHECK(manifest.inSyncWith(map.get()));
+
+    // changing the layer puts the manifest out of sync until it catches up
+    layer->dirty();
+    CHECK(manifest.inSyncWith(map.get()) == false);
+    manifest.updateRevisions(map.get());
+    CHECK(manifest.inSyncWith(map.get()));
+
+    // removed layers don't count
+    layer->dirty();
+    map->layers().remove(layer);
+    CHECK(manifest.inSyncWith(map.get()));
+}
+
 #ifdef ROCKY_HAS_GDAL
 TEST_CASE("GDAL")
 {
@@ -690,6 +1328,32 @@ TEST_CASE("SRS")
         CHECK(keys[1] == TileKey(0, 1, 0, GG));
     }
 
+    SECTION("Profile identity")
+    {
+        // equivalent SRSs and profiles share an id, however they were made
+        SRS merc1("spherical-mercator"), merc2("epsg:3785");
+        REQUIRE((merc1.valid() && merc2.valid()));
+        CHECK(merc1.id() != 0);
+        CHECK(merc1.id() == merc2.id());
+        CHECK(merc1.id() != SRS::WGS84.id());
+        CHECK(SRS().id() == 0);
+
+        Profile GG("global-geodetic");
+        Profile GG2(SRS::WGS84, Box(-180.0, -90.0, 180.0, 90.0), 2, 1);
+        REQUIRE(GG2.valid());
+        CHECK(GG.id() == GG2.id());
+        CHECK(GG.hash() == GG2.hash());
+        CHECK(GG.id() != Profile::SPHERICAL_MERCATOR.id());
+        CHECK(Profile().id() == 0);
+
+        // so keys from either profile are interchangeable
+        TileKey k1(3, 2, 1, GG), k2(3, 2, 1, GG2);
+        CHECK(k1 == k2);
+        CHECK(k1.hash() == k2.hash());
+        CHECK(k1 != TileKey(3, 2, 1, Profile::SPHERICAL_MERCATOR));
+        CHECK(TileKey::INVALID != TileKey::INVALID);
+    }
+
     SECTION("Profile serialization")
     {
         const char* json = R"("
@@ -710,6 +1374,203 @@ TEST_CASE("SRS")
     }
 }
 
+TEST_CASE("TerrainHeightQuery")
+{
+    Instance instance;
+    auto map = Map::create(instance);
+    REQUIRE(map->profile().valid());
+
+    TerrainHeightQuery query;
+    query.reset(map, 19u);
+
+    // resident tiles: every root at 100m, and one child of the first root at 200m.
+    std::vector<TileKey> roots;
+    Profile::getRootKeys(map->profile(), roots);
+    REQUIRE(roots.size() > 0);
+
+    for (auto& root : roots)
+    {
+        auto hf = Heightfield::create(17, 17);
+        hf->fill(100.0f);
+        query.insert(root, hf, glm::dmat4(1));
+    }
+
+    auto child = roots[0].createChildKey(0);
+    auto child_hf = Heightfield::create(17, 17);
+    child_hf->fill(200.0f);
+    query.insert(child, child_hf, glm::dmat4(1));
+    CHECK(query.size() == roots.size() + 1);
+
+    auto c0 = child.extent().centroid();
+    auto c3 = roots[0].createChildKey(3).extent().centroid();
+    std::vector<glm::dvec3> points = {
+        { c0.x, c0.y, 0.0 },
+        { c3.x, c3.y, 0.0 },
+        { 1e9, 1e9, 0.0 } };
+
+    std::vector<float> heights(points.size());
+    auto& srs = map->profile().srs();
+
+    CHECK(query.heightsAt(points.data(), points.size(), srs, heights.data()) == 2);
+    CHECK(heights[0] == 200.0f);
+    CHECK(heights[1] == 100.0f);
+    CHECK(heights[2] == NO_DATA_VALUE);
+
+    // paging out the child falls back on the parent's data:
+    query.remove(child);
+    CHECK(query.clamp(points, srs) == 2);
+    CHECK(points[0].z == 100.0);
+    CHECK(points[2].z == 0.0);
+}
+
+TEST_CASE("CameraPath")
+{
+    CameraPath path;
+    auto status = path.from_json(R"({
+        "field_of_view": 45,
+        "viewport": [1280, 720],
+        "keyframes": [
+            { "time": 0,  "long": 170,  "lat": 10, "heading": 350, "range": 1000 },
+            { "time": 10, "long": -170, "lat": 20, "heading": 10,  "range": 100000 } ] })");
+
+    REQUIRE(status.ok());
+    CHECK(path.keyframes.size() == 2);
+    CHECK(path.viewportHeight == 720);
+    CHECK(path.duration() == 10.0);
+    CHECK(path.keyframes[1].pitch == -90.0);
+
+    // halfway: longitude and heading take the short way around the dateline / north,
+    // and the range interpolates logarithmically
+    auto mid = path.at(5.0);
+    CHECK(std::abs(std::abs(mid.point.x) - 180.0) < 1e-9);
+    CHECK(mid.point.y == Approx(15.0));
+    CHECK(std::abs(std::fmod(mid.heading + 360.0, 360.0)) < 1e-9);
+    CHECK(mid.range == Approx(10000.0));
+
+    // clamps outside the path
+    CHECK(path.at(-1.0).range == 1000.0);
+    CHECK(path.at(20.0).point.y == 20.0);
+
+    CHECK(path.from_json(R"({ "keyframes": [] })").failed());
+}
+
+TEST_CASE("TiledFeatureView")
+{
+    auto line = [](Feature::ID id, double x0, double y0, double x1, double y1)
+        {
+            Feature feature;
+            feature.id = id;
+            feature.srs = SRS::WGS84;
+            feature.geometry = Geometry(Geometry::Type::LineString,
+                std::vector<glm::dvec3>{ { x0, y0, 0.0 }, { x1, y1, 0.0 } });
+            feature.dirtyExtent();
+            return feature;
+        };
+
+    // global-geodetic tiles at LOD 1 are 90 degrees square
+    auto source = TestFeatureSource::create();
+    source->features.emplace_back(line(1, -60.0, 10.0, -40.0, 30.0)); // inside 1/1/0
+    source->features.emplace_back(line(2, -10.0, 38.0, 30.0, 42.0));  // spans both, centroid in 1/2/0
+    source->features.emplace_back(line(3, -20.0, 48.0, 20.0, 52.0));  // centroid on the shared edge
+
+    TileKey west(1, 1, 0, Profile::GLOBAL_GEODETIC);
+    TileKey east(1, 2, 0, Profile::GLOBAL_GEODETIC);
+
+    Cancelable never;
+    auto westFeatures = TestTiledFeatureView::readTile(*source, west, never);
+    auto eastFeatures = TestTiledFeatureView::readTile(*source, east, never);
+
+    // each feature lands in exactly one tile, the one holding its centroid
+    REQUIRE(westFeatures.size() == 1);
+    CHECK(westFeatures[0].id == 1);
+    REQUIRE(eastFeatures.size() == 2);
+    CHECK(eastFeatures[0].id == 2);
+    CHECK(eastFeatures[1].id == 3);
+    CHECK(TestTiledFeatureView::readTile(*source, TileKey(1, 0, 0, Profile::GLOBAL_GEODETIC), never).empty());
+
+    // paging: visited tiles load, and expire once unvisited for too long
+    InstanceVSG instance;
+    instance.runtime().viewer = vsg::Viewer::create();
+    entt::registry registry;
+
+    vsg::ref_ptr<TestTiledFeatureView> view(new TestTiledFeatureView(registry, instance.runtime()));
+    view->source = source;
+    view->srs = SRS::WGS84;
+    view->levelOfDetail = 1;
+    view->expirationFrames = 10;
+
+    view->visit({ { west, 1.0f }, { east, 2.0f } }, 1);
+    view->update();
+    CHECK(view->residentTiles() == 2);
+
+    // only the west tile stays in view
+    view->visit({ { west, 1.0f } }, 8);
+    view->update();
+    CHECK(view->residentTiles() == 2);
+
+    view->visit({ { west, 1.0f } }, 12);
+    view->update();
+    CHECK(view->residentTiles() == 1);
+
+    // and then nothing does
+    view->visit({}, 30);
+    view->update();
+    CHECK(view->residentTiles() == 0);
+
+    view->clear();
+}
+
+TEST_CASE("Layer change during tile load")
+{
+    InstanceVSG instance;
+    instance.runtime().viewer = vsg::Viewer::create();
+
+    auto mapNode = MapNode::create(instance);
+    auto color = TestImageLayer::create();
+    auto elevation = TestElevationLayer::create();
+
+    // the color layer changes while the first elevation tile is loading
+    std::atomic_bool changed = { false };
+    elevation->onLoad = [&]() {
+        if (!changed.exchange(true))
+            color->dirty();
+    };
+
+    mapNode->map->layers().add(color);
+    mapNode->map->layers().add(elevation);
+    mapNode->map->openAllLayers(instance.io());
+    REQUIRE(color->isOpen());
+    REQUIRE(elevation->isOpen());
+
+    // hover far enough away that only the root tiles are in view
+    CameraPath path;
+    CameraPath::Keyframe key;
+    key.point = GeoPoint(SRS::WGS84, 0.0, 0.0);
+    key.range = 1e8;
+    path.keyframes.push_back(key);
+
+    TerrainReplay replay(mapNode);
+    replay.settings.settleTimeout = 10.0;
+    auto report = replay.run(path);
+    REQUIRE(report.status.ok());
+    CHECK(changed);
+
+    // the stale load was thrown away, but the elevation still got reloaded
+    std::vector<TileKey> roots;
+    Profile::getRootKeys(mapNode->map->profile(), roots);
+    REQUIRE(roots.size() > 0);
+
+    std::vector<glm::dvec3> points;
+    for (auto& root : roots) {
+        auto c = root.extent().centroid();
+        points.emplace_back(c.x, c.y, 0.0);
+    }
+    std::vector<float> heights(points.size());
+    mapNode->terrainHeightQuery()->heightsAt(points.data(), points.size(), mapNode->map->profile().srs(), heights.data());
+    for (auto h : heights)
+        CHECK(h == 100.0f);
+}
+
 TEST_CASE("IO")
 {
     SECTION("HTTP")
@@ -750,6 +1611,55 @@ TEST_CASE("IO")
         }
     }
 
+#ifdef ROCKY_HAS_HTTPLIB
+    SECTION("Async HTTP")
+    {
+        // local stand-in for a tile server, with injected latency
+        const auto latency = std::chrono::milliseconds(100);
+
+        httplib::Server server;
+        server.Get(R"(/tiles/(\d+))", [&](const httplib::Request& req, httplib::Response& res)
+            {
+                std::this_thread::sleep_for(latency);
+                res.set_content("tile " + req.matches[1].str(), "text/plain");
+            });
+
+        int port = server.bind_to_any_port("127.0.0.1");
+        REQUIRE(port > 0);
+        std::thread listener([&]() { server.listen_after_bind(); });
+        while (!server.is_running())
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        const int count = 16;
+        URI::setMaxConcurrentReads(count);
+
+        // all the reads go out from this one thread
+        auto t0 = std::chrono::steady_clock::now();
+
+        std::vector<jobs::future<IOResult<Content>>> reads;
+        for (int i = 0; i < count; ++i)
+        {
+            URI uri("http://127.0.0.1:" + std::to_string(port) + "/tiles/" + std::to_string(i));
+            reads.emplace_back(uri.readAsync(IOOptions()));
+        }
+
+        for (int i = 0; i < count; ++i)
+        {
+            auto& r = reads[i].join();
+            CHECK(r.status.ok());
+            CHECK(r.value.data == "tile " + std::to_string(i));
+        }
+
+        auto elapsed = std::chrono::steady_clock::now() - t0;
+
+        // one after the other, the reads would take count * latency
+        CHECK(elapsed < latency * count / 2);
+
+        server.stop();
+        listener.join();
+    }
+#endif
+
     SECTION("URI")
     {
         URI file("C:/folder/filename.ext");